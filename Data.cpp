@@ -1,4 +1,7 @@
 #include "Data.h"
+#include "diagnostics/profiler.h"
+
+#include <stdexcept>
 
 ts::VerifiedData::VerifiedData(Data &&data) : m_data(std::move(data)) {}
 
@@ -12,34 +15,44 @@ const ts::Data &ts::VerifiedData::data() const &noexcept
     return m_data;
 }
 
-tl::expected<ts::VerifiedData, std::string> ts::VerifiedData::initializeWithDefaults(std::vector<Subject>&& subjects, std::vector<Article>&& articles)
+tl::expected<ts::VerifiedData, std::string> ts::VerifiedData::initializeWithDefaults(std::vector<Subject>&& subjects, std::vector<Article>&& articles, std::shared_ptr<StringPool> strings)
 {
     if (subjects.empty()) {
-        throw std::exception("There must be at least one subject");
+        throw std::runtime_error("There must be at least one subject");
     }
 
-    std::map<Article::Id, Subject::Id> firstAppearance;
-    std::map<Article::Id, std::set<Subject::Id>> appearance;
+    FirstAppearanceMap firstAppearance;
+    AppearanceMap appearance;
 
     if (auto error = checkDuplicates(subjects, articles); !error) {
         return tl::unexpected(std::move(error).error());
     }
 
+    for (auto& subject : subjects) {
+        subject.name = strings->intern(subject.name.view());
+    }
+    for (auto& article : articles) {
+        article.name = strings->intern(article.name.view());
+    }
+
     for (const auto& article : articles) {
         firstAppearance.insert_or_assign(article.id, subjects.front().id);
-        appearance.insert_or_assign(article.id, std::set<Subject::Id>{ subjects.front().id });
+        appearance.insert_or_assign(article.id, SubjectIdSet{ subjects.front().id });
     }
 
     return ts::VerifiedData(ts::Data{
         .subjects = std::move(subjects),
         .articles = std::move(articles),
         .firstAppearance = std::move(firstAppearance),
-        .appearance = std::move(appearance)
+        .appearance = std::move(appearance),
+        .strings = std::move(strings)
     });
 }
 
 tl::expected<ts::VerifiedData, std::string> ts::VerifiedData::verify(Data &&data)
 {
+    TS_PROFILE_SCOPE("VerifiedData::verify");
+
     auto verifyRes = checkDuplicates(data.subjects, data.articles);
 
     if (!verifyRes) {
@@ -78,6 +91,10 @@ tl::expected<ts::VerifiedData, std::string> ts::VerifiedData::verify(Data &&data
         }
     }
 
+    if (!ScoringPolicy::isValidWeight(data.scoring.p_1) || !ScoringPolicy::isValidWeight(data.scoring.p_2)) {
+        return tl::unexpected("scoring weights must be from " + std::to_string(ScoringPolicy::minWeight) + " to " + std::to_string(ScoringPolicy::maxWeight));
+    }
+
     return ts::VerifiedData(std::move(data));
 }
 
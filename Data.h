@@ -2,10 +2,15 @@
 #define DATA_H
 
 #include <map>
+#include <memory>
+#include <memory_resource>
 #include <set>
 #include <string>
 #include <QUuid>
 #include "KeyId.h"
+#include "stringpool.h"
+#include "subjectidset.h"
+#include "scoringpolicy.h"
 
 #include "libs/expected/include/tl/expected.hpp"
 
@@ -13,27 +18,36 @@ namespace ts {
     struct Subject {
         using Id = KeyId<Subject>;
         Id id;
-        std::string name;
+        InternedString name;
     };
 
     struct Article {
         using Id = KeyId<Article>;
         Id id;
-        std::string name;
+        InternedString name;
     };
 
+    // Node containers take an allocator, so a document can keep all of its nodes in its own memory resource.
+    // Rows of the appearance map are SubjectIdSet, which takes the allocator of its map as well
+    using FirstAppearanceMap = std::pmr::map<Article::Id, Subject::Id>;
+    using AppearanceMap = std::pmr::map<Article::Id, SubjectIdSet>;
+
     struct Data {
         std::vector<Subject> subjects;
         std::vector<Article> articles;
-        std::map<Article::Id, Subject::Id> firstAppearance;
-        std::map<Article::Id, std::set<Subject::Id>> appearance;
+        FirstAppearanceMap firstAppearance;
+        AppearanceMap appearance;
+        ScoringPolicy scoring;
+        // owns the names of subjects and articles, shared by copies of the data
+        std::shared_ptr<StringPool> strings = std::make_shared<StringPool>();
     };
 
     struct VerifiedData {
         Data&& data() && noexcept;
         const Data& data() const & noexcept;
 
-        static tl::expected<VerifiedData, std::string> initializeWithDefaults(std::vector<Subject>&& subjects, std::vector<Article>&& articles);
+        // names are interned into strings, so subjects and articles may come from any pool
+        static tl::expected<VerifiedData, std::string> initializeWithDefaults(std::vector<Subject>&& subjects, std::vector<Article>&& articles, std::shared_ptr<StringPool> strings = std::make_shared<StringPool>());
         static tl::expected<VerifiedData, std::string> verify(Data&& data);
 
         static VerifiedData unverifiedFromRawData(Data&& data);
@@ -1,6 +1,7 @@
 #ifndef KEYID_H
 #define KEYID_H
 
+#include <functional>
 #include <utility>
 
 namespace ts {
@@ -1,100 +1,262 @@
 #include "algorithm.h"
+#include "metrics.h"
 #include <ranges>
 
 using namespace ts;
 using namespace ts::algorithm;
 
-ComputedData ts::algorithm::computeOuterLinks(const std::vector<Subject>& subjects, const std::map<Article::Id, Subject::Id> &firstAppearance, const std::map<Article::Id, std::set<Subject::Id>> &appearance, Article::Id articleId)
-{
-    const auto& articleAppearance = appearance.at(articleId);
+namespace {
+    template<int P_1, int P_2>
+    struct FixedWeights {
+        static constexpr int p_1 = P_1;
+        static constexpr int p_2 = P_2;
+    };
 
-    const auto firstAppearanceSubjectId = firstAppearance.at(articleId);
+    struct RuntimeWeights {
+        int p_1;
+        int p_2;
+    };
 
-    auto isDotSetted = [&](Subject::Id id) -> bool {
-        return articleAppearance.contains(id) || id == firstAppearanceSubjectId;
+    struct NoMetrics {
+        void visit(const DotVisit&) noexcept {}
+        void finish(const RowSummary&) noexcept {}
     };
 
-    auto i_max = 0u;
+    class MetricsVisitor {
+    public:
+        MetricsVisitor(const std::vector<Metric>& metrics, std::span<float> values) : m_metrics(metrics), m_values(values)
+        {
+            if (metrics.size() > m_inlineStates.size()) {
+                m_heapStates.resize(metrics.size());
+                m_states = m_heapStates;
+            } else {
+                m_states = std::span(m_inlineStates).first(metrics.size());
+            }
+        }
 
-    for (auto i = 0u; i < subjects.size(); i++) {
-        if (isDotSetted(subjects[i].id)) {
-            i_max = i + 1;
+        void visit(const DotVisit& dot)
+        {
+            for (auto i = 0u; i < m_metrics.size(); i++) {
+                if (m_metrics[i].visit) {
+                    m_metrics[i].visit(m_states[i], dot);
+                }
+            }
         }
-    }
 
-    const auto t_m = std::distance(subjects.begin(), std::ranges::find(subjects, firstAppearanceSubjectId, [](const auto& v) {return v.id;})) + 1;
+        void finish(const RowSummary& row)
+        {
+            for (auto i = 0u; i < m_metrics.size(); i++) {
+                m_values[i] = m_metrics[i].finish ? m_metrics[i].finish(m_states[i], row) : 0.f;
+            }
+        }
 
-    const auto t_p = std::min(std::distance(subjects.begin(), std::ranges::find_first_of(subjects, articleAppearance, {}, [](const auto& v) {return v.id;})) + 1, t_m);
+    private:
+        const std::vector<Metric>& m_metrics;
+        std::span<float> m_values;
+        // the usual handful of metrics keeps its state on the stack
+        std::array<MetricState, 8> m_inlineStates {};
+        std::vector<MetricState> m_heapStates;
+        std::span<MetricState> m_states;
+    };
+
+    template<typename Sum, typename Visitor>
+    ComputedData finishRow(const Sum& sum, int size, int t_p, int t_m, int i_max, int dots, Normalization normalization, Visitor& visitor)
+    {
+        const auto c = sum.divided(normalizationDivisor(normalization, size, t_p, i_max));
+
+        const auto l = float(i_max - t_p + 1) / float(size);
+
+        const auto res = ComputedData { .l = l, .c = c, .h = l * c };
 
-    std::vector<int> a_l(subjects.size());
+        visitor.finish(RowSummary { .subjectsCount = size, .t_p = t_p, .t_m = t_m, .i_max = i_max, .dots = dots, .scores = res });
 
+        return res;
+    }
+
+    // Single pass over the columns: every position in (t_p, k] that is not a dot is empty,
+    // so a_l_t of a dot is a_l minus the empties counted so far
+    template<typename Sum, typename Weights, typename Visitor>
+    ComputedData computeDenseRow(const std::vector<Subject>& subjects, const SubjectIdSet& articleAppearance, Subject::Id firstAppearanceSubjectId, Normalization normalization, Weights weights, Visitor& visitor)
     {
-        const auto p_2 = 2;
-        const auto p_1 = 1;
+        const auto size = int(subjects.size());
+
+        auto isDotSetted = [&](Subject::Id id) -> bool {
+            return id == firstAppearanceSubjectId || articleAppearance.contains(id);
+        };
+
+        const auto t_m = int(std::distance(subjects.begin(), std::ranges::find(subjects, firstAppearanceSubjectId, &Subject::id))) + 1;
 
-        for (auto i = 0u; i < subjects.size(); i++) {
-            if (isDotSetted(subjects[i].id) == 0) {
+        const auto t_p = std::min(int(std::distance(subjects.begin(), std::ranges::find_if(subjects, [&](const Subject& subject) { return articleAppearance.contains(subject.id); }))) + 1, t_m);
+
+        auto i_max = 0;
+        auto empties = 0;
+        auto dots = 0;
+        Sum sum;
+
+        for (auto k = 1; k <= size; k++) {
+            if (!isDotSetted(subjects[k - 1].id)) {
+                if (k > t_p) {
+                    empties++;
+                }
                 continue;
             }
 
-            if (t_p == t_m && t_m <= i + 1) {
-                a_l[i] = p_2 * (i + 1 - t_p + 1);
-            }
-            if (t_p < t_m && t_m <= i + 1) {
-                a_l[i] = p_1 * (t_m - t_p) + p_2 * (i + 1 - t_m + 1);
-            }
-            if (t_p <= i + 1 && i + 1 < t_m) {
-                a_l[i] = p_1 * (i + 1 - t_p + 1);
+            const auto a_l = weightedDistance(k, t_p, t_m, weights.p_1, weights.p_2);
+            const auto a_l_t = a_l - empties;
+
+            if (a_l_t != 0 && a_l != 0) {
+                sum.add(a_l_t, a_l);
             }
+
+            visitor.visit(DotVisit { .k = k, .a_l = a_l, .a_l_t = a_l_t, .gap = dots ? k - i_max - 1 : 0 });
+
+            i_max = k;
+            dots++;
         }
-    }
 
-    std::vector<int> a_l_t(subjects.size());
+        return finishRow(sum, size, t_p, t_m, i_max, dots, normalization, visitor);
+    }
 
+    // The same pass over the dots only. t_p is the first dot, so the positions in (t_p, k]
+    // that are not dots are k - t_p minus the dots before the k-th one
+    template<typename Sum, typename Weights, typename Visitor>
+    ComputedData computeSparseRow(int size, const SubjectPositions& positions, const SubjectIdSet& articleAppearance, Subject::Id firstAppearanceSubjectId, Normalization normalization, Weights weights, Visitor& visitor)
     {
-        const auto r = [&](unsigned i, unsigned j) {
-            auto res = 0u;
+        const auto firstAppearancePosition = positions.of(firstAppearanceSubjectId);
+        const auto t_m = firstAppearancePosition ? firstAppearancePosition : size + 1;
 
-            for (auto k = i; k < j; k++) {
-                if (isDotSetted(subjects[k].id) == 0) {
-                    res++;
-                }
-            }
+        // the usual short row keeps its columns on the stack
+        std::array<int, 64> inlineColumns;
+        std::vector<int> heapColumns;
+        auto columns = std::span(inlineColumns).first(0);
 
-            return res;
-        };
+        if (articleAppearance.size() + 1 > inlineColumns.size()) {
+            heapColumns.resize(articleAppearance.size() + 1);
+            columns = heapColumns;
+        } else {
+            columns = std::span(inlineColumns).first(articleAppearance.size() + 1);
+        }
 
-        for (auto i = 0u; i < subjects.size(); i++) {
-            if (isDotSetted(subjects[i].id) == 0) {
-                continue;
-            }
+        auto count = std::size_t(0);
+        auto t_p = t_m;
 
-            if (t_p == t_m && t_m <= i + 1) {
-                a_l_t[i] = a_l[i] - r(t_p, i + 1);
+        for (const auto subjectId : articleAppearance) {
+            if (const auto position = positions.of(subjectId)) {
+                columns[count++] = position;
+                t_p = std::min(t_p, position);
             }
-            if (t_p < t_m && t_m <= i + 1) {
-                a_l_t[i] = a_l[i] - r(t_p, t_m) - r(t_m, i + 1);
-            }
-            if (t_p <= i + 1 && i + 1 < t_m) {
-                a_l_t[i] = a_l[i] - r(t_p, i + 1);
+        }
+
+        if (firstAppearancePosition && !articleAppearance.contains(firstAppearanceSubjectId)) {
+            columns[count++] = firstAppearancePosition;
+        }
+
+        columns = columns.first(count);
+        std::sort(columns.begin(), columns.end());
+
+        auto i_max = 0;
+        auto dots = 0;
+        Sum sum;
+
+        for (const auto k : columns) {
+            const auto a_l = weightedDistance(k, t_p, t_m, weights.p_1, weights.p_2);
+            const auto a_l_t = a_l - (k - t_p - dots);
+
+            if (a_l_t != 0 && a_l != 0) {
+                sum.add(a_l_t, a_l);
             }
+
+            visitor.visit(DotVisit { .k = k, .a_l = a_l, .a_l_t = a_l_t, .gap = dots ? k - i_max - 1 : 0 });
+
+            i_max = k;
+            dots++;
         }
-    }
 
-    const auto l = float(i_max - t_p + 1) / subjects.size();
+        return finishRow(sum, size, t_p, t_m, i_max, dots, normalization, visitor);
+    }
 
-    auto c = 0.f;
+    // positions is null when the row is to be walked column by column whatever its form
+    template<typename Sum, typename Visitor>
+    ComputedData computeRow(const std::vector<Subject>& subjects, const SubjectPositions* positions, const SubjectIdSet& articleAppearance, Subject::Id firstAppearanceSubjectId, const ScoringPolicy& policy, Visitor& visitor)
     {
-        for (auto i = 0u; i < subjects.size(); i++) {
-            if (a_l_t[i] != 0 && a_l[i] != 0) {
-                c += float(a_l_t[i]) / float(a_l[i]);
+        const auto score = [&](auto weights) {
+            if (positions && !articleAppearance.isDense()) {
+                return computeSparseRow<Sum>(int(subjects.size()), *positions, articleAppearance, firstAppearanceSubjectId, policy.normalization, weights, visitor);
             }
+
+            return computeDenseRow<Sum>(subjects, articleAppearance, firstAppearanceSubjectId, policy.normalization, weights, visitor);
+        };
+
+        if (policy.p_1 == 1 && policy.p_2 == 2) {
+            return score(FixedWeights<1, 2>{});
+        }
+        if (policy.p_1 == 1 && policy.p_2 == 1) {
+            return score(FixedWeights<1, 1>{});
         }
 
-        c /= subjects.size();
+        return score(RuntimeWeights { .p_1 = policy.p_1, .p_2 = policy.p_2 });
+    }
+
+    template<typename Visitor>
+    ComputedData computeRow(const std::vector<Subject>& subjects, const SubjectPositions* positions, const FirstAppearanceMap &firstAppearance, const AppearanceMap &appearance, Article::Id articleId, const ScoringPolicy& policy, Visitor& visitor)
+    {
+        const auto& articleAppearance = appearance.at(articleId);
+
+        const auto firstAppearanceSubjectId = firstAppearance.at(articleId);
+
+        if (policy.arithmetic == Arithmetic::Exact) {
+            return computeRow<ExactSum>(subjects, positions, articleAppearance, firstAppearanceSubjectId, policy, visitor);
+        }
+
+        return computeRow<FloatSum>(subjects, positions, articleAppearance, firstAppearanceSubjectId, policy, visitor);
+    }
+}
+
+SubjectPositions::SubjectPositions(const std::vector<Subject>& subjects)
+{
+    const auto directLimit = 4 * subjects.size() + 64;
+
+    for (auto i = 0u; i < subjects.size(); i++) {
+        const auto id = std::size_t(unsigned(subjects[i].id));
+
+        if (id < directLimit) {
+            if (id >= m_byId.size()) {
+                m_byId.resize(id + 1);
+            }
+            m_byId[id] = int(i) + 1;
+        } else {
+            m_far.emplace_back(id, int(i) + 1);
+        }
     }
 
-    const auto h = l * c;
+    std::ranges::sort(m_far);
+}
+
+int SubjectPositions::farPosition(std::size_t id) const noexcept
+{
+    const auto iter = std::ranges::lower_bound(m_far, id, {}, &std::pair<std::size_t, int>::first);
+
+    return iter != m_far.end() && iter->first == id ? iter->second : 0;
+}
+
+// the column walk, kept as the reference the dot walk is checked against
+ComputedData ts::algorithm::computeOuterLinks(const std::vector<Subject>& subjects, const FirstAppearanceMap &firstAppearance, const AppearanceMap &appearance, Article::Id articleId, const ScoringPolicy& policy)
+{
+    NoMetrics visitor;
+
+    return computeRow(subjects, nullptr, firstAppearance, appearance, articleId, policy, visitor);
+}
+
+ComputedData ts::algorithm::computeOuterLinks(const std::vector<Subject>& subjects, const SubjectPositions& positions, const FirstAppearanceMap &firstAppearance, const AppearanceMap &appearance, Article::Id articleId, const ScoringPolicy& policy)
+{
+    NoMetrics visitor;
+
+    return computeRow(subjects, &positions, firstAppearance, appearance, articleId, policy, visitor);
+}
+
+ComputedData ts::algorithm::computeMetrics(const std::vector<Subject>& subjects, const SubjectPositions& positions, const FirstAppearanceMap& firstAppearance, const AppearanceMap& appearance, Article::Id articleId, const ScoringPolicy& policy, const std::vector<Metric>& metrics, std::span<float> values)
+{
+    MetricsVisitor visitor(metrics, values);
 
-    return ComputedData { .l = l, .c = c, .h = h };
+    return computeRow(subjects, &positions, firstAppearance, appearance, articleId, policy, visitor);
 }
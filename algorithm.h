@@ -3,6 +3,10 @@
 
 #include "Data.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
 namespace ts::algorithm {
     struct ComputedData {
         float l = 0;
@@ -10,7 +14,111 @@ namespace ts::algorithm {
         float h = 0;
     };
 
-    ComputedData computeOuterLinks(const std::vector<Subject>& subjects, const std::map<Article::Id, Subject::Id>& firstAppearance, const std::map<Article::Id, std::set<Subject::Id>>& appearance, Article::Id articleId);
+    // 1-based column of every subject. Built once per order of the subjects, it lets
+    // a sparse row be scored from its dots alone
+    class SubjectPositions {
+    public:
+        SubjectPositions() = default;
+        explicit SubjectPositions(const std::vector<Subject>& subjects);
+
+        // 0 for a subject that is not in the list
+        int of(Subject::Id id) const noexcept
+        {
+            const auto index = std::size_t(unsigned(id));
+
+            return index < m_byId.size() ? m_byId[index] : farPosition(index);
+        }
+
+    private:
+        int farPosition(std::size_t id) const noexcept;
+
+        // ids up to a few times the subjects count are looked up directly
+        std::vector<int> m_byId;
+        // the rest, sorted by id
+        std::vector<std::pair<std::size_t, int>> m_far;
+    };
+
+    ComputedData computeOuterLinks(const std::vector<Subject>& subjects, const FirstAppearanceMap& firstAppearance, const AppearanceMap& appearance, Article::Id articleId, const ScoringPolicy& policy);
+    // Dense rows are walked column by column, sparse ones dot by dot
+    ComputedData computeOuterLinks(const std::vector<Subject>& subjects, const SubjectPositions& positions, const FirstAppearanceMap& firstAppearance, const AppearanceMap& appearance, Article::Id articleId, const ScoringPolicy& policy);
+
+    // a_l of a dot at position k, positions are 1-based as t_p and t_m
+    constexpr int weightedDistance(int k, int t_p, int t_m, int p_1, int p_2) noexcept
+    {
+        if (t_p == t_m && t_m <= k) {
+            return p_2 * (k - t_p + 1);
+        }
+        if (t_p < t_m && t_m <= k) {
+            return p_1 * (t_m - t_p) + p_2 * (k - t_m + 1);
+        }
+        if (t_p <= k && k < t_m) {
+            return p_1 * (k - t_p + 1);
+        }
+
+        return 0;
+    }
+
+    // what c is divided by
+    constexpr int normalizationDivisor(Normalization normalization, int subjectsCount, int t_p, int i_max) noexcept
+    {
+        return normalization == Normalization::Span ? std::max(1, i_max - t_p + 1) : subjectsCount;
+    }
+
+    constexpr float normalizationOf(Normalization normalization, int subjectsCount, int t_p, int i_max) noexcept
+    {
+        return float(normalizationDivisor(normalization, subjectsCount, t_p, i_max));
+    }
+
+    // one in the fixed point of exact arithmetic
+    inline constexpr std::int64_t fixedOne = std::int64_t(1) << 32;
+
+    // numerator / denominator rounded to the nearest fixed point value, both are positive
+    constexpr std::int64_t fixedQuotient(std::int64_t numerator, std::int64_t denominator) noexcept
+    {
+        return numerator / denominator * fixedOne + (numerator % denominator * fixedOne + denominator / 2) / denominator;
+    }
+
+    inline std::int64_t fixedOf(float value) noexcept
+    {
+        return std::llround(double(value) * double(fixedOne));
+    }
+
+    inline float floatOf(std::int64_t fixed, std::int64_t divisor = 1) noexcept
+    {
+        return float(double(fixed) / double(fixedOne) / double(divisor));
+    }
+
+    // Sums of the a_l_t / a_l terms of c, one per ScoringPolicy::arithmetic
+    struct FloatSum {
+        float value = 0;
+
+        void add(int a_l_t, int a_l) noexcept
+        {
+            value += float(a_l_t) / float(a_l);
+        }
+
+        float divided(int divisor) const noexcept
+        {
+            return value / float(divisor);
+        }
+    };
+
+    // Every term is rounded once and added as an integer, so the sum doesn't depend on
+    // the order of the terms. A rounding is off by at most 2^-33, c by at most dots * 2^-33
+    // before the single conversion to float
+    struct ExactSum {
+        std::int64_t value = 0;
+
+        void add(int a_l_t, int a_l) noexcept
+        {
+            value += fixedQuotient(a_l_t, a_l);
+        }
+
+        float divided(int divisor) const noexcept
+        {
+            return floatOf((value + divisor / 2) / divisor);
+        }
+    };
 }
 
 #endif // ALGORITHM_H
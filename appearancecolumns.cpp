@@ -0,0 +1,220 @@
+#include "appearancecolumns.h"
+
+using namespace ts;
+
+float AppearanceColumns::SubjectLoad::meanH() const noexcept
+{
+    return firstAppearances ? float(firstAppearanceHSum / double(firstAppearances)) : 0.f;
+}
+
+void AppearanceColumns::reset(const std::vector<Subject>& subjects)
+{
+    m_columnsOfSubjects.clear();
+    m_slots.clear();
+    m_freeSlots.clear();
+    m_articles.clear();
+    m_rows.clear();
+    m_l.clear();
+    m_c.clear();
+    m_h.clear();
+    m_columnsOfRows.clear();
+    m_firstAppearanceColumns.clear();
+
+    m_appearance.assign(subjects.size(), {});
+    m_firstAppearance.assign(subjects.size(), {});
+    m_load.assign(subjects.size(), {});
+
+    for (auto i = 0u; i < subjects.size(); i++) {
+        m_columnsOfSubjects.insert_or_assign(unsigned(subjects[i].id), i);
+    }
+}
+
+void AppearanceColumns::setRow(Article::Id articleId, const SubjectIdSet& appearance, Subject::Id firstAppearance, const algorithm::ComputedData& scores)
+{
+    const auto slot = slotOf(articleId);
+
+    clearSlot(slot);
+
+    auto& columns = m_columnsOfRows[slot];
+
+    for (const auto& subjectId : appearance) {
+        if (auto column = m_columnsOfSubjects.find(unsigned(subjectId)); column != m_columnsOfSubjects.end()) {
+            setBit(m_appearance[column->second], slot, true);
+            m_load[column->second].dots++;
+            columns.push_back(std::uint32_t(column->second));
+        }
+    }
+
+    if (auto column = m_columnsOfSubjects.find(unsigned(firstAppearance)); column != m_columnsOfSubjects.end()) {
+        setBit(m_firstAppearance[column->second], slot, true);
+        m_load[column->second].firstAppearances++;
+        m_load[column->second].firstAppearanceHSum += scores.h;
+        m_firstAppearanceColumns[slot] = std::uint32_t(column->second);
+    }
+
+    setBit(m_rows, slot, true);
+
+    m_l[slot] = scores.l;
+    m_c[slot] = scores.c;
+    m_h[slot] = scores.h;
+}
+
+void AppearanceColumns::eraseRow(Article::Id articleId)
+{
+    auto iter = m_slots.find(unsigned(articleId));
+
+    if (iter == m_slots.end()) {
+        return;
+    }
+
+    clearSlot(iter->second);
+    setBit(m_rows, iter->second, false);
+
+    m_freeSlots.push_back(iter->second);
+    m_slots.erase(iter);
+}
+
+std::size_t AppearanceColumns::wordsCount() const noexcept
+{
+    return m_rows.size();
+}
+
+std::size_t AppearanceColumns::slotsCount() const noexcept
+{
+    return m_articles.size();
+}
+
+const AppearanceColumns::Bitset& AppearanceColumns::rows() const noexcept
+{
+    return m_rows;
+}
+
+const AppearanceColumns::Bitset* AppearanceColumns::appearance(Subject::Id subjectId) const noexcept
+{
+    auto column = m_columnsOfSubjects.find(unsigned(subjectId));
+
+    return column == m_columnsOfSubjects.end() ? nullptr : &m_appearance[column->second];
+}
+
+const AppearanceColumns::Bitset* AppearanceColumns::firstAppearance(Subject::Id subjectId) const noexcept
+{
+    auto column = m_columnsOfSubjects.find(unsigned(subjectId));
+
+    return column == m_columnsOfSubjects.end() ? nullptr : &m_firstAppearance[column->second];
+}
+
+std::span<const float> AppearanceColumns::scores(Score score) const noexcept
+{
+    switch (score) {
+    case Score::L:
+        return m_l;
+    case Score::C:
+        return m_c;
+    case Score::H:
+        return m_h;
+    }
+
+    return {};
+}
+
+const AppearanceColumns::SubjectLoad* AppearanceColumns::load(Subject::Id subjectId) const noexcept
+{
+    auto column = m_columnsOfSubjects.find(unsigned(subjectId));
+
+    return column == m_columnsOfSubjects.end() ? nullptr : &m_load[column->second];
+}
+
+Article::Id AppearanceColumns::articleAt(std::size_t slot) const
+{
+    return m_articles.at(slot);
+}
+
+std::size_t AppearanceColumns::memoryUsage() const noexcept
+{
+    auto res = (m_rows.capacity() + (m_appearance.size() + m_firstAppearance.size()) * m_rows.size()) * sizeof(Word);
+
+    res += m_articles.capacity() * sizeof(Article::Id) + m_freeSlots.capacity() * sizeof(std::size_t);
+    res += (m_l.capacity() + m_c.capacity() + m_h.capacity()) * sizeof(float);
+    res += m_columnsOfRows.capacity() * sizeof(std::vector<std::uint32_t>) + m_firstAppearanceColumns.capacity() * sizeof(std::uint32_t);
+
+    for (const auto& columns : m_columnsOfRows) {
+        res += columns.capacity() * sizeof(std::uint32_t);
+    }
+
+    res += m_slots.size() * (sizeof(std::pair<const unsigned, std::size_t>) + 2 * sizeof(void*));
+
+    return res;
+}
+
+std::size_t AppearanceColumns::slotOf(Article::Id articleId)
+{
+    if (auto iter = m_slots.find(unsigned(articleId)); iter != m_slots.end()) {
+        return iter->second;
+    }
+
+    std::size_t slot = m_articles.size();
+
+    if (!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        m_articles[slot] = articleId;
+    } else {
+        m_articles.push_back(articleId);
+        m_l.push_back(0);
+        m_c.push_back(0);
+        m_h.push_back(0);
+        m_columnsOfRows.emplace_back();
+        m_firstAppearanceColumns.push_back(noColumn);
+
+        if (slot / wordBits >= m_rows.size()) {
+            m_rows.push_back(0);
+
+            for (auto& column : m_appearance) {
+                column.push_back(0);
+            }
+            for (auto& column : m_firstAppearance) {
+                column.push_back(0);
+            }
+        }
+    }
+
+    m_slots.insert_or_assign(unsigned(articleId), slot);
+
+    return slot;
+}
+
+void AppearanceColumns::clearSlot(std::size_t slot) noexcept
+{
+    const auto word = slot / wordBits;
+    const auto mask = Word(1) << (slot % wordBits);
+
+    // only the columns the row was set in, so a row costs its size whatever the subject count
+    for (const auto column : m_columnsOfRows[slot]) {
+        m_appearance[column][word] &= ~mask;
+        m_load[column].dots--;
+    }
+
+    m_columnsOfRows[slot].clear();
+
+    // m_h still holds the h the row was counted with
+    if (const auto column = m_firstAppearanceColumns[slot]; column != noColumn) {
+        auto& load = m_load[column];
+
+        m_firstAppearance[column][word] &= ~mask;
+        load.firstAppearances--;
+        load.firstAppearanceHSum = load.firstAppearances ? load.firstAppearanceHSum - m_h[slot] : 0;
+
+        m_firstAppearanceColumns[slot] = noColumn;
+    }
+}
+
+void AppearanceColumns::setBit(Bitset& bitset, std::size_t slot, bool value) noexcept
+{
+    const auto mask = Word(1) << (slot % wordBits);
+
+    if (value) {
+        bitset[slot / wordBits] |= mask;
+    } else {
+        bitset[slot / wordBits] &= ~mask;
+    }
+}
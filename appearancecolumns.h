@@ -0,0 +1,83 @@
+#ifndef APPEARANCECOLUMNS_H
+#define APPEARANCECOLUMNS_H
+
+#include "algorithm.h"
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace ts {
+    // Column view of Data::appearance and Data::firstAppearance: one bitset per subject
+    // over article slots, plus the scores of every slot. Questions about appearance
+    // patterns are answered by combining whole columns 64 articles at a time
+    class AppearanceColumns {
+    public:
+        using Word = std::uint64_t;
+        using Bitset = std::vector<Word>;
+
+        enum class Score { L, C, H };
+
+        // teaching load of a subject, kept up to date by setRow and eraseRow
+        struct SubjectLoad {
+            std::size_t dots = 0;
+            std::size_t firstAppearances = 0;
+            // over the articles first appearing at the subject
+            double firstAppearanceHSum = 0;
+
+            float meanH() const noexcept;
+        };
+
+        static constexpr std::size_t wordBits = 64;
+
+        // drops every row, columns follow the order of subjects
+        void reset(const std::vector<Subject>& subjects);
+
+        void setRow(Article::Id articleId, const SubjectIdSet& appearance, Subject::Id firstAppearance, const algorithm::ComputedData& scores);
+        void eraseRow(Article::Id articleId);
+
+        std::size_t wordsCount() const noexcept;
+        std::size_t slotsCount() const noexcept;
+
+        // bits of the slots that hold an article
+        const Bitset& rows() const noexcept;
+        // nullptr for an unknown subject
+        const Bitset* appearance(Subject::Id subjectId) const noexcept;
+        const Bitset* firstAppearance(Subject::Id subjectId) const noexcept;
+
+        std::span<const float> scores(Score score) const noexcept;
+        // nullptr for an unknown subject
+        const SubjectLoad* load(Subject::Id subjectId) const noexcept;
+        Article::Id articleAt(std::size_t slot) const;
+
+        std::size_t memoryUsage() const noexcept;
+
+    private:
+        std::size_t slotOf(Article::Id articleId);
+        void clearSlot(std::size_t slot) noexcept;
+
+        static void setBit(Bitset& bitset, std::size_t slot, bool value) noexcept;
+
+        static constexpr std::uint32_t noColumn = std::numeric_limits<std::uint32_t>::max();
+
+        std::unordered_map<unsigned, std::size_t> m_columnsOfSubjects;
+        std::unordered_map<unsigned, std::size_t> m_slots;
+        std::vector<std::size_t> m_freeSlots;
+        std::vector<Article::Id> m_articles;
+
+        Bitset m_rows;
+        std::vector<Bitset> m_appearance;
+        std::vector<Bitset> m_firstAppearance;
+        std::vector<SubjectLoad> m_load;
+        std::vector<float> m_l;
+        std::vector<float> m_c;
+        std::vector<float> m_h;
+        // columns each slot is set in, so clearing a row doesn't visit every column
+        std::vector<std::vector<std::uint32_t>> m_columnsOfRows;
+        std::vector<std::uint32_t> m_firstAppearanceColumns;
+    };
+}
+
+#endif // APPEARANCECOLUMNS_H
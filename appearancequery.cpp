@@ -0,0 +1,486 @@
+#include "appearancequery.h"
+#include "diagnostics/profiler.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+
+using namespace ts;
+
+namespace {
+    struct Token {
+        enum class Kind { End, Word, String, Number, Position, Symbol };
+
+        Kind kind = Kind::End;
+        std::string text;
+        float number = 0;
+        std::size_t position = 0;
+    };
+
+    bool isWordChar(char ch) noexcept
+    {
+        const auto code = static_cast<unsigned char>(ch);
+
+        // bytes of multibyte UTF-8 sequences are letters as well
+        return code >= 0x80 || code == '_' || (code >= '0' && code <= '9') || (code >= 'a' && code <= 'z') || (code >= 'A' && code <= 'Z');
+    }
+
+    class Parser {
+    public:
+        Parser(std::string_view text, const std::vector<Subject>& subjects) : m_text(text), m_subjects(subjects) {}
+
+        tl::expected<std::vector<AppearanceQuery::Node>, std::string> parse()
+        {
+            if (auto tokenized = tokenize(); !tokenized) {
+                return tl::unexpected(tokenized.error());
+            }
+
+            if (auto root = parseOr(); !root) {
+                return tl::unexpected(root.error());
+            }
+
+            if (peek().kind != Token::Kind::End) {
+                return tl::unexpected(unexpectedToken().error());
+            }
+
+            return std::move(m_nodes);
+        }
+
+    private:
+        using Result = tl::expected<std::size_t, std::string>;
+
+        tl::expected<void, std::string> tokenize()
+        {
+            auto i = 0u;
+
+            while (i < m_text.size()) {
+                const auto ch = m_text[i];
+
+                if (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r') {
+                    i++;
+                    continue;
+                }
+
+                Token token { .position = i };
+
+                if (ch == '"') {
+                    const auto end = m_text.find('"', i + 1);
+
+                    if (end == std::string_view::npos) {
+                        return tl::unexpected("Unterminated string at " + std::to_string(i + 1));
+                    }
+
+                    token.kind = Token::Kind::String;
+                    token.text = m_text.substr(i + 1, end - i - 1);
+                    i = end + 1;
+                } else if (ch == '#' || ch == '.' || (ch >= '0' && ch <= '9')) {
+                    const auto begin = ch == '#' ? i + 1 : i;
+                    auto end = begin;
+
+                    while (end < m_text.size() && ((m_text[end] >= '0' && m_text[end] <= '9') || m_text[end] == '.')) {
+                        end++;
+                    }
+
+                    const auto [ptr, ec] = std::from_chars(m_text.data() + begin, m_text.data() + end, token.number);
+
+                    if (ec != std::errc() || ptr != m_text.data() + end) {
+                        return tl::unexpected("Invalid number at " + std::to_string(i + 1));
+                    }
+
+                    token.kind = ch == '#' ? Token::Kind::Position : Token::Kind::Number;
+                    token.text = m_text.substr(begin, end - begin);
+                    i = end;
+                } else if (isWordChar(ch)) {
+                    auto end = i;
+
+                    while (end < m_text.size() && isWordChar(m_text[end])) {
+                        end++;
+                    }
+
+                    token.kind = Token::Kind::Word;
+                    token.text = m_text.substr(i, end - i);
+                    i = end;
+                } else {
+                    const auto pair = m_text.substr(i, 2);
+                    const auto length = pair == "<=" || pair == ">=" || pair == "&&" || pair == "||" ? 2u : 1u;
+
+                    if (std::string_view("()!&|<>=").find(ch) == std::string_view::npos) {
+                        return tl::unexpected("Unexpected character at " + std::to_string(i + 1));
+                    }
+
+                    token.kind = Token::Kind::Symbol;
+                    token.text = m_text.substr(i, length);
+                    i += length;
+                }
+
+                m_tokens.push_back(std::move(token));
+            }
+
+            m_tokens.push_back(Token { .position = m_text.size() });
+
+            return {};
+        }
+
+        Result parseOr()
+        {
+            auto left = parseAnd();
+
+            while (left && (accept("|") || accept("||") || accept("or"))) {
+                auto right = parseAnd();
+
+                if (!right) {
+                    return right;
+                }
+
+                left = add({ .op = AppearanceQuery::Op::Or, .left = *left, .right = *right });
+            }
+
+            return left;
+        }
+
+        Result parseAnd()
+        {
+            auto left = parseUnary();
+
+            while (left && (accept("&") || accept("&&") || accept("and"))) {
+                auto right = parseUnary();
+
+                if (!right) {
+                    return right;
+                }
+
+                left = add({ .op = AppearanceQuery::Op::And, .left = *left, .right = *right });
+            }
+
+            return left;
+        }
+
+        Result parseUnary()
+        {
+            if (accept("!") || accept("not")) {
+                auto operand = parseUnary();
+
+                if (!operand) {
+                    return operand;
+                }
+
+                return add({ .op = AppearanceQuery::Op::Not, .left = *operand });
+            }
+
+            return parsePrimary();
+        }
+
+        Result parsePrimary()
+        {
+            if (accept("(")) {
+                auto res = parseOr();
+
+                if (res && !accept(")")) {
+                    return expected("')'");
+                }
+
+                return res;
+            }
+
+            const auto& token = peek();
+
+            if (token.kind != Token::Kind::Word) {
+                return unexpectedToken();
+            }
+
+            if (token.text == "l" || token.text == "c" || token.text == "h") {
+                return parseComparison();
+            }
+
+            if (token.text == "dot" || token.text == "first" || token.text == "after" || token.text == "before") {
+                return parseTerm();
+            }
+
+            return tl::unexpected("Unknown term \"" + token.text + "\" at " + std::to_string(token.position + 1));
+        }
+
+        Result parseComparison()
+        {
+            const auto name = next().text;
+
+            AppearanceQuery::Node node { .op = AppearanceQuery::Op::Score };
+            node.score = name == "l" ? AppearanceColumns::Score::L : name == "c" ? AppearanceColumns::Score::C : AppearanceColumns::Score::H;
+
+            if (accept("<")) {
+                node.compare = AppearanceQuery::Compare::Less;
+            } else if (accept("<=")) {
+                node.compare = AppearanceQuery::Compare::LessOrEqual;
+            } else if (accept(">")) {
+                node.compare = AppearanceQuery::Compare::Greater;
+            } else if (accept(">=")) {
+                node.compare = AppearanceQuery::Compare::GreaterOrEqual;
+            } else if (accept("=")) {
+                node.compare = AppearanceQuery::Compare::Equal;
+            } else {
+                return expected("a comparison");
+            }
+
+            if (peek().kind != Token::Kind::Number) {
+                return expected("a number");
+            }
+
+            node.value = next().number;
+
+            return add(std::move(node));
+        }
+
+        Result parseTerm()
+        {
+            const auto name = next().text;
+
+            if (!accept("(")) {
+                return expected("'('");
+            }
+
+            const auto subject = parseSubject();
+
+            if (!subject) {
+                return tl::unexpected(subject.error());
+            }
+
+            if (!accept(")")) {
+                return expected("')'");
+            }
+
+            AppearanceQuery::Node node { .op = name == "first" ? AppearanceQuery::Op::FirstAppearance : AppearanceQuery::Op::Appearance };
+
+            if (name == "after") {
+                for (auto i = *subject + 1; i < m_subjects.size(); i++) {
+                    node.subjects.push_back(m_subjects[i].id);
+                }
+            } else if (name == "before") {
+                for (auto i = 0u; i < *subject; i++) {
+                    node.subjects.push_back(m_subjects[i].id);
+                }
+            } else {
+                node.subjects.push_back(m_subjects[*subject].id);
+            }
+
+            return add(std::move(node));
+        }
+
+        // index of the subject in the document order
+        Result parseSubject()
+        {
+            const auto& token = peek();
+
+            if (token.kind == Token::Kind::Position) {
+                const auto position = std::size_t(token.number);
+
+                if (position < 1 || position > m_subjects.size() || float(position) != token.number) {
+                    return tl::unexpected("No subject #" + token.text);
+                }
+
+                next();
+
+                return position - 1;
+            }
+
+            if (token.kind != Token::Kind::Word && token.kind != Token::Kind::String) {
+                return expected("a subject");
+            }
+
+            const auto subject = std::ranges::find_if(m_subjects, [&](const Subject& subject) {
+                return subject.name.view() == token.text;
+            });
+
+            if (subject == m_subjects.end()) {
+                return tl::unexpected("Unknown subject \"" + token.text + "\"");
+            }
+
+            next();
+
+            return std::size_t(subject - m_subjects.begin());
+        }
+
+        Result add(AppearanceQuery::Node&& node)
+        {
+            m_nodes.push_back(std::move(node));
+
+            return m_nodes.size() - 1;
+        }
+
+        const Token& peek() const
+        {
+            return m_tokens[m_current];
+        }
+
+        const Token& next()
+        {
+            return m_tokens[m_current++];
+        }
+
+        bool accept(std::string_view text)
+        {
+            const auto& token = peek();
+
+            if ((token.kind == Token::Kind::Symbol || token.kind == Token::Kind::Word) && token.text == text) {
+                m_current++;
+                return true;
+            }
+
+            return false;
+        }
+
+        Result expected(std::string_view what) const
+        {
+            return tl::unexpected("Expected " + std::string(what) + " at " + std::to_string(peek().position + 1));
+        }
+
+        Result unexpectedToken() const
+        {
+            if (peek().kind == Token::Kind::End) {
+                return tl::unexpected<std::string>("Unexpected end of query");
+            }
+
+            return tl::unexpected("Unexpected \"" + std::string(m_text.substr(peek().position, std::max<std::size_t>(1, peek().text.size()))) + "\" at " + std::to_string(peek().position + 1));
+        }
+
+        std::string_view m_text;
+        const std::vector<Subject>& m_subjects;
+
+        std::vector<Token> m_tokens;
+        std::size_t m_current = 0;
+
+        std::vector<AppearanceQuery::Node> m_nodes;
+    };
+
+    // one bit per score, the comparison is picked once and not for every article
+    template<typename Predicate>
+    void packScores(std::span<const float> scores, AppearanceColumns::Bitset& res, Predicate predicate) noexcept
+    {
+        for (auto slot = 0u; slot < scores.size(); slot++) {
+            res[slot / AppearanceColumns::wordBits] |= AppearanceColumns::Word(predicate(scores[slot])) << (slot % AppearanceColumns::wordBits);
+        }
+    }
+}
+
+tl::expected<AppearanceQuery, std::string> AppearanceQuery::parse(std::string_view text, const std::vector<Subject>& subjects)
+{
+    auto nodes = Parser(text, subjects).parse();
+
+    if (!nodes) {
+        return tl::unexpected(nodes.error());
+    }
+
+    return AppearanceQuery(std::move(*nodes));
+}
+
+std::vector<Article::Id> AppearanceQuery::evaluate(const AppearanceColumns& columns) const
+{
+    TS_PROFILE_SCOPE("AppearanceQuery::evaluate");
+
+    auto bits = evaluate(m_nodes.size() - 1, columns);
+
+    std::vector<Article::Id> res;
+
+    for (auto i = 0u; i < bits.size(); i++) {
+        // freed slots and the tail of the last word are not rows
+        auto word = bits[i] & columns.rows()[i];
+
+        while (word) {
+            res.push_back(columns.articleAt(i * AppearanceColumns::wordBits + std::countr_zero(word)));
+            word &= word - 1;
+        }
+    }
+
+    // slots follow the order articles were added in, so this is usually sorted already
+    if (!std::is_sorted(res.begin(), res.end())) {
+        std::sort(res.begin(), res.end());
+    }
+
+    return res;
+}
+
+AppearanceQuery::AppearanceQuery(std::vector<Node>&& nodes) : m_nodes(std::move(nodes))
+{
+
+}
+
+AppearanceColumns::Bitset AppearanceQuery::evaluate(std::size_t index, const AppearanceColumns& columns) const
+{
+    const auto& node = m_nodes[index];
+    const auto wordsCount = columns.wordsCount();
+
+    AppearanceColumns::Bitset res;
+
+    switch (node.op) {
+    case Op::Appearance:
+    case Op::FirstAppearance:
+        res.assign(wordsCount, 0);
+
+        for (const auto& subjectId : node.subjects) {
+            const auto* column = node.op == Op::Appearance ? columns.appearance(subjectId) : columns.firstAppearance(subjectId);
+
+            if (!column) {
+                continue;
+            }
+
+            for (auto i = 0u; i < wordsCount; i++) {
+                res[i] |= (*column)[i];
+            }
+        }
+        break;
+    case Op::Score: {
+        const auto scores = columns.scores(node.score);
+
+        res.assign(wordsCount, 0);
+
+        const auto value = node.value;
+
+        switch (node.compare) {
+        case Compare::Less:
+            packScores(scores, res, [value](float score) { return score < value; });
+            break;
+        case Compare::LessOrEqual:
+            packScores(scores, res, [value](float score) { return score <= value; });
+            break;
+        case Compare::Greater:
+            packScores(scores, res, [value](float score) { return score > value; });
+            break;
+        case Compare::GreaterOrEqual:
+            packScores(scores, res, [value](float score) { return score >= value; });
+            break;
+        case Compare::Equal:
+            packScores(scores, res, [value](float score) { return score == value; });
+            break;
+        }
+        break;
+    }
+    case Op::Not:
+        res = evaluate(node.left, columns);
+
+        for (auto& word : res) {
+            word = ~word;
+        }
+        break;
+    case Op::And: {
+        res = evaluate(node.left, columns);
+
+        // a & !b is folded into one pass
+        const auto negated = m_nodes[node.right].op == Op::Not;
+        const auto right = evaluate(negated ? m_nodes[node.right].left : node.right, columns);
+
+        for (auto i = 0u; i < wordsCount; i++) {
+            res[i] &= negated ? ~right[i] : right[i];
+        }
+        break;
+    }
+    case Op::Or: {
+        res = evaluate(node.left, columns);
+        const auto right = evaluate(node.right, columns);
+
+        for (auto i = 0u; i < wordsCount; i++) {
+            res[i] |= right[i];
+        }
+        break;
+    }
+    }
+
+    return res;
+}
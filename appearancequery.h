@@ -0,0 +1,49 @@
+#ifndef APPEARANCEQUERY_H
+#define APPEARANCEQUERY_H
+
+#include "appearancecolumns.h"
+#include "libs/expected/include/tl/expected.hpp"
+
+#include <string_view>
+
+namespace ts {
+    // Filter over appearance patterns, for example
+    //   first("Algebra") & !after("Geometry")
+    //   dot(#2) & dot(#4) & !dot(#5) | h > 0.5
+    // Terms are dot(S), first(S), after(S) and before(S), the last two match a dot at any
+    // subject after or before S, and l, c or h compared to a number with <, <=, >, >= or =.
+    // They are joined with ! (not), & (and), | (or) and parentheses. A subject is its name,
+    // quoted unless it's a single word, or its position #1, #2...
+    class AppearanceQuery {
+    public:
+        static tl::expected<AppearanceQuery, std::string> parse(std::string_view text, const std::vector<Subject>& subjects);
+
+        // ids of the matching articles in ascending order
+        std::vector<Article::Id> evaluate(const AppearanceColumns& columns) const;
+
+        enum class Op { Appearance, FirstAppearance, Score, Not, And, Or };
+        enum class Compare { Less, LessOrEqual, Greater, GreaterOrEqual, Equal };
+
+        struct Node {
+            Op op = Op::Appearance;
+            // a dot or a first appearance at any of them
+            std::vector<Subject::Id> subjects;
+            AppearanceColumns::Score score = AppearanceColumns::Score::H;
+            Compare compare = Compare::Greater;
+            float value = 0;
+            // operands of Not, And and Or
+            std::size_t left = 0;
+            std::size_t right = 0;
+        };
+
+    private:
+        explicit AppearanceQuery(std::vector<Node>&& nodes);
+
+        AppearanceColumns::Bitset evaluate(std::size_t node, const AppearanceColumns& columns) const;
+
+        // operands go before the operators using them, the root is the last one
+        std::vector<Node> m_nodes;
+    };
+}
+
+#endif // APPEARANCEQUERY_H
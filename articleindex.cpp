@@ -0,0 +1,127 @@
+#include "articleindex.h"
+
+#include <algorithm>
+
+using namespace ts;
+
+void ArticleIndex::add(Article::Id id, std::string_view name)
+{
+    const auto key = unsigned(id);
+    const auto folded = QString::fromUtf8(name.data(), qsizetype(name.size())).toCaseFolded();
+
+    for (const auto trigram : trigramsOf(folded)) {
+        auto& postings = m_postings[trigram];
+
+        // new articles get the largest id, so this is almost always an append
+        if (postings.empty() || postings.back() < key) {
+            postings.push_back(key);
+        } else if (auto iter = std::ranges::lower_bound(postings, key); iter == postings.end() || *iter != key) {
+            postings.insert(iter, key);
+        }
+    }
+
+    m_names.insert_or_assign(key, folded);
+}
+
+void ArticleIndex::remove(Article::Id id)
+{
+    const auto name = m_names.find(unsigned(id));
+
+    if (name == m_names.end()) {
+        return;
+    }
+
+    for (const auto trigram : trigramsOf(name->second)) {
+        auto postings = m_postings.find(trigram);
+
+        if (postings == m_postings.end()) {
+            continue;
+        }
+
+        if (auto iter = std::ranges::lower_bound(postings->second, name->first); iter != postings->second.end() && *iter == name->first) {
+            postings->second.erase(iter);
+        }
+
+        if (postings->second.empty()) {
+            m_postings.erase(postings);
+        }
+    }
+
+    m_names.erase(name);
+}
+
+void ArticleIndex::rename(Article::Id id, std::string_view name)
+{
+    remove(id);
+    add(id, name);
+}
+
+std::vector<Article::Id> ArticleIndex::search(const QString& query) const
+{
+    const auto folded = query.toCaseFolded();
+
+    std::vector<Article::Id> res;
+
+    const auto check = [&](unsigned id, const QString& name) {
+        if (name.contains(folded)) {
+            res.push_back(Article::Id(id));
+        }
+    };
+
+    // too short to have a trigram, names are scanned
+    if (folded.size() < 3) {
+        for (const auto& [id, name] : m_names) {
+            check(id, name);
+        }
+
+        return res;
+    }
+
+    std::vector<const std::vector<unsigned>*> postings;
+
+    for (const auto trigram : trigramsOf(folded)) {
+        const auto iter = m_postings.find(trigram);
+
+        if (iter == m_postings.end()) {
+            return res;
+        }
+
+        postings.push_back(&iter->second);
+    }
+
+    std::ranges::sort(postings, {}, [](const auto* list) { return list->size(); });
+
+    auto candidates = *postings.front();
+    std::vector<unsigned> intersection;
+
+    for (auto i = 1u; i < postings.size() && !candidates.empty(); i++) {
+        intersection.clear();
+        std::ranges::set_intersection(candidates, *postings[i], std::back_inserter(intersection));
+        std::swap(candidates, intersection);
+    }
+
+    for (const auto id : candidates) {
+        check(id, m_names.at(id));
+    }
+
+    return res;
+}
+
+std::size_t ArticleIndex::size() const noexcept
+{
+    return m_names.size();
+}
+
+std::vector<ArticleIndex::Trigram> ArticleIndex::trigramsOf(const QString& folded)
+{
+    std::vector<Trigram> res;
+
+    for (auto i = qsizetype(0); i + 2 < folded.size(); i++) {
+        res.push_back(Trigram(folded[i].unicode()) << 32 | Trigram(folded[i + 1].unicode()) << 16 | Trigram(folded[i + 2].unicode()));
+    }
+
+    std::ranges::sort(res);
+    res.erase(std::unique(res.begin(), res.end()), res.end());
+
+    return res;
+}
@@ -0,0 +1,40 @@
+#ifndef ARTICLEINDEX_H
+#define ARTICLEINDEX_H
+
+#include "Data.h"
+
+#include <QString>
+
+#include <cstdint>
+#include <map>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ts {
+    // Case-insensitive substring search over article names. Names are split into trigrams
+    // of case-folded UTF-16 code units, a query is answered by intersecting the posting
+    // lists of its trigrams and checking only the candidates left
+    class ArticleIndex {
+    public:
+        void add(Article::Id id, std::string_view name);
+        void remove(Article::Id id);
+        void rename(Article::Id id, std::string_view name);
+
+        // ids of the matching articles in ascending order, an empty query matches every article
+        std::vector<Article::Id> search(const QString& query) const;
+
+        std::size_t size() const noexcept;
+
+    private:
+        using Trigram = std::uint64_t;
+
+        static std::vector<Trigram> trigramsOf(const QString& folded);
+
+        // posting lists are sorted by article id
+        std::unordered_map<Trigram, std::vector<unsigned>> m_postings;
+        std::map<unsigned, QString> m_names;
+    };
+}
+
+#endif // ARTICLEINDEX_H
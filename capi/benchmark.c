@@ -0,0 +1,141 @@
+/*
+ * Throughput of the C interface on a generated document:
+ * teachingscores_c_benchmark [articles] [subjects] [dots per article] [edits]
+ */
+
+#include "teachingscores.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint32_t next_random(uint64_t* state)
+{
+    *state = *state * 6364136223846793005ull + 1442695040888963407ull;
+
+    return (uint32_t)(*state >> 33);
+}
+
+static size_t argument(int argc, char** argv, int index, size_t fallback)
+{
+    return argc > index ? (size_t)strtoull(argv[index], NULL, 10) : fallback;
+}
+
+static int check(ts_document* document, ts_status status, const char* what)
+{
+    if (status != TS_OK) {
+        fprintf(stderr, "%s failed (%d): %s\n", what, (int)status, ts_document_last_error(document));
+        return 0;
+    }
+
+    return 1;
+}
+
+static void report(const char* what, size_t count, double seconds)
+{
+    printf("%-16s %10zu in %8.3f ms, %12.0f / s\n", what, count, seconds * 1e3, seconds > 0 ? (double)count / seconds : 0.0);
+}
+
+int main(int argc, char** argv)
+{
+    const size_t articles_count = argument(argc, argv, 1, 1000000);
+    const size_t subjects_count = argument(argc, argv, 2, 64);
+    const size_t dots_per_article = argument(argc, argv, 3, 8);
+    const size_t edits_count = argument(argc, argv, 4, 100000);
+
+    if (subjects_count == 0 || articles_count == 0) {
+        fprintf(stderr, "there must be at least one subject and one article\n");
+        return 1;
+    }
+
+    uint32_t* subject_ids = malloc(subjects_count * sizeof(uint32_t));
+    uint32_t* article_ids = malloc(articles_count * sizeof(uint32_t));
+    uint32_t* first_appearance = malloc(articles_count * sizeof(uint32_t));
+    uint32_t* offsets = malloc((articles_count + 1) * sizeof(uint32_t));
+    uint32_t* dots = malloc(articles_count * (dots_per_article + 1) * sizeof(uint32_t));
+    ts_article_scores* scores = malloc(articles_count * sizeof(ts_article_scores));
+    ts_edit* edits = malloc((edits_count ? edits_count : 1) * sizeof(ts_edit));
+
+    if (!subject_ids || !article_ids || !first_appearance || !offsets || !dots || !scores || !edits) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    uint64_t state = 42;
+
+    for (size_t i = 0; i < subjects_count; i++) {
+        subject_ids[i] = (uint32_t)i;
+    }
+
+    offsets[0] = 0;
+    for (size_t i = 0; i < articles_count; i++) {
+        article_ids[i] = (uint32_t)i;
+        first_appearance[i] = next_random(&state) % subjects_count;
+
+        size_t count = 0;
+        dots[offsets[i] + count++] = first_appearance[i];
+        for (size_t j = 0; j < dots_per_article; j++) {
+            dots[offsets[i] + count++] = next_random(&state) % subjects_count;
+        }
+
+        offsets[i + 1] = offsets[i] + (uint32_t)count;
+    }
+
+    for (size_t i = 0; i < edits_count; i++) {
+        edits[i].kind = next_random(&state) % 2 ? TS_EDIT_SET_APPEARANCE : TS_EDIT_SET_FIRST_APPEARANCE;
+        edits[i].subject_id = next_random(&state) % subjects_count;
+        edits[i].article_id = next_random(&state) % articles_count;
+    }
+
+    ts_document* document = ts_document_create();
+    const ts_scoring_policy policy = { 1, 2, TS_NORMALIZATION_SUBJECTS, TS_ARITHMETIC_FLOAT };
+    const ts_scoring_policy exact_policy = { 1, 2, TS_NORMALIZATION_SUBJECTS, TS_ARITHMETIC_EXACT };
+    int ok = document != NULL;
+
+    double start = now();
+    ok = ok && check(document, ts_document_load(document, subject_ids, NULL, subjects_count, article_ids, NULL, articles_count,
+                                                first_appearance, offsets, dots, &policy), "load");
+    if (ok) {
+        report("load", articles_count, now() - start);
+    }
+
+    start = now();
+    ok = ok && check(document, ts_document_score_all(document, scores, articles_count), "score_all");
+    if (ok) {
+        report("score_all", articles_count, now() - start);
+    }
+
+    size_t applied = 0;
+    start = now();
+    ok = ok && check(document, ts_document_apply_edits(document, edits, edits_count, &applied), "apply_edits");
+    if (ok) {
+        report("apply_edits", applied, now() - start);
+    }
+
+    start = now();
+    ok = ok && check(document, ts_document_set_scoring_policy(document, &exact_policy), "set_scoring_policy");
+    if (ok) {
+        report("exact rescore", articles_count, now() - start);
+        printf("C_nu %f\n", ts_document_c_nu(document));
+    }
+
+    ts_document_destroy(document);
+
+    free(edits);
+    free(scores);
+    free(dots);
+    free(offsets);
+    free(first_appearance);
+    free(article_ids);
+    free(subject_ids);
+
+    return ok ? 0 : 1;
+}
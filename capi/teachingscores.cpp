@@ -0,0 +1,289 @@
+#include "teachingscores.h"
+#include "computeddatamodel.h"
+#include "parallel.h"
+
+#include <cmath>
+#include <optional>
+
+struct ts_document {
+    std::optional<ts::ComputedDataModel> model;
+    std::string lastError;
+};
+
+namespace {
+    ts_status fail(ts_document* document, ts_status status, std::string message)
+    {
+        document->lastError = std::move(message);
+
+        return status;
+    }
+
+    // no exception crosses the C boundary
+    template<typename F>
+    ts_status guarded(ts_document* document, F&& func)
+    {
+        if (!document) {
+            return TS_INVALID_ARGUMENT;
+        }
+
+        document->lastError.clear();
+
+        try {
+            return func();
+        } catch (const std::exception& e) {
+            return fail(document, TS_INTERNAL_ERROR, e.what());
+        } catch (...) {
+            return fail(document, TS_INTERNAL_ERROR, "unknown error");
+        }
+    }
+
+    std::optional<ts::ScoringPolicy> policyOf(const ts_scoring_policy* policy)
+    {
+        if (!policy) {
+            return ts::ScoringPolicy();
+        }
+
+        if (!ts::ScoringPolicy::isValidWeight(policy->p_1) || !ts::ScoringPolicy::isValidWeight(policy->p_2) || (policy->normalization != TS_NORMALIZATION_SUBJECTS && policy->normalization != TS_NORMALIZATION_SPAN)) {
+            return std::nullopt;
+        }
+        if (policy->arithmetic != TS_ARITHMETIC_FLOAT && policy->arithmetic != TS_ARITHMETIC_EXACT) {
+            return std::nullopt;
+        }
+
+        return ts::ScoringPolicy { .p_1 = policy->p_1, .p_2 = policy->p_2, .normalization = ts::Normalization(policy->normalization), .arithmetic = ts::Arithmetic(policy->arithmetic) };
+    }
+
+    ts::InternedString nameOf(ts::StringPool& strings, const char* const* names, std::size_t index)
+    {
+        return names && names[index] ? strings.intern(std::string_view(names[index])) : ts::InternedString();
+    }
+}
+
+uint32_t ts_abi_version(void)
+{
+    return TS_ABI_VERSION;
+}
+
+ts_document* ts_document_create(void)
+{
+    return new (std::nothrow) ts_document();
+}
+
+void ts_document_destroy(ts_document* document)
+{
+    delete document;
+}
+
+const char* ts_document_last_error(const ts_document* document)
+{
+    return document ? document->lastError.c_str() : "no document";
+}
+
+ts_status ts_document_load(ts_document* document,
+                           const uint32_t* subject_ids, const char* const* subject_names, size_t subjects_count,
+                           const uint32_t* article_ids, const char* const* article_names, size_t articles_count,
+                           const uint32_t* first_appearance,
+                           const uint32_t* appearance_offsets, const uint32_t* appearance_subjects,
+                           const ts_scoring_policy* policy)
+{
+    return guarded(document, [&]() {
+        if (!subject_ids || subjects_count == 0) {
+            return fail(document, TS_INVALID_ARGUMENT, "there must be at least one subject");
+        }
+        if (articles_count > 0 && (!article_ids || !first_appearance || !appearance_offsets)) {
+            return fail(document, TS_INVALID_ARGUMENT, "article arrays are missing");
+        }
+        if (articles_count > 0 && !appearance_subjects && appearance_offsets[articles_count] > appearance_offsets[0]) {
+            return fail(document, TS_INVALID_ARGUMENT, "appearance_subjects is missing");
+        }
+
+        const auto scoring = policyOf(policy);
+
+        if (!scoring) {
+            return fail(document, TS_INVALID_ARGUMENT, "weights must be positive, normalization and arithmetic one of their enums");
+        }
+
+        // the maps are built over the memory the document keeps, so compute adopts their nodes
+        auto memory = std::make_unique<ts::DocumentMemory>();
+        auto* resource = memory->resource();
+
+        ts::Data data {
+            .firstAppearance = ts::FirstAppearanceMap(resource),
+            .appearance = ts::AppearanceMap(resource),
+            .scoring = scoring.value()
+        };
+
+        data.subjects.reserve(subjects_count);
+        for (auto i = std::size_t(0); i < subjects_count; i++) {
+            data.subjects.push_back(ts::Subject { .id = ts::Subject::Id(subject_ids[i]), .name = nameOf(*data.strings, subject_names, i) });
+        }
+
+        data.articles.reserve(articles_count);
+        for (auto i = std::size_t(0); i < articles_count; i++) {
+            const auto articleId = ts::Article::Id(article_ids[i]);
+
+            data.articles.push_back(ts::Article { .id = articleId, .name = nameOf(*data.strings, article_names, i) });
+
+            if (first_appearance[i] >= subjects_count) {
+                return fail(document, TS_INVALID_DOCUMENT, "first appearance of article " + std::to_string(i) + " is not a subject index");
+            }
+            if (appearance_offsets[i] > appearance_offsets[i + 1]) {
+                return fail(document, TS_INVALID_DOCUMENT, "appearance offsets decrease at article " + std::to_string(i));
+            }
+
+            data.firstAppearance.emplace(articleId, data.subjects[first_appearance[i]].id);
+
+            ts::SubjectIdSet dots(resource);
+
+            for (auto j = appearance_offsets[i]; j < appearance_offsets[i + 1]; j++) {
+                if (appearance_subjects[j] >= subjects_count) {
+                    return fail(document, TS_INVALID_DOCUMENT, "appearance of article " + std::to_string(i) + " has no subject index " + std::to_string(appearance_subjects[j]));
+                }
+
+                dots.insert(data.subjects[appearance_subjects[j]].id);
+            }
+
+            data.appearance.emplace(articleId, std::move(dots));
+        }
+
+        auto verified = ts::VerifiedData::verify(std::move(data));
+
+        if (!verified) {
+            return fail(document, TS_INVALID_DOCUMENT, verified.error());
+        }
+
+        document->model.reset();
+        document->model.emplace(ts::ComputedDataModel::compute(std::move(verified).value(), std::move(memory)));
+
+        return TS_OK;
+    });
+}
+
+size_t ts_document_articles_count(const ts_document* document)
+{
+    return document && document->model ? document->model->getArticles().size() : 0;
+}
+
+size_t ts_document_subjects_count(const ts_document* document)
+{
+    return document && document->model ? document->model->getSubjects().size() : 0;
+}
+
+float ts_document_c_nu(const ts_document* document)
+{
+    if (!document || !document->model) {
+        return NAN;
+    }
+
+    return document->model->getC_nu().value_or(NAN);
+}
+
+ts_status ts_document_score_all(const ts_document* document, ts_article_scores* scores, size_t capacity)
+{
+    // last error is the only thing a const call changes
+    auto* mutableDocument = const_cast<ts_document*>(document);
+
+    return guarded(mutableDocument, [&]() {
+        if (!document->model) {
+            return fail(mutableDocument, TS_INVALID_DOCUMENT, "the document is not loaded");
+        }
+
+        const auto& model = document->model.value();
+        const auto& articles = model.getArticles();
+
+        if (capacity < articles.size() || (!scores && !articles.empty())) {
+            return fail(mutableDocument, TS_BUFFER_TOO_SMALL, "the buffer holds " + std::to_string(capacity) + " of " + std::to_string(articles.size()) + " articles");
+        }
+
+        ts::parallel::forEachIndex(articles.size(), [&](std::size_t i) {
+            const auto& data = model.getComputedDataForArticle(articles[i].id);
+
+            scores[i] = ts_article_scores { .article_id = unsigned(articles[i].id), .l = data.l, .c = data.c, .h = data.h };
+        });
+
+        return TS_OK;
+    });
+}
+
+ts_status ts_document_set_scoring_policy(ts_document* document, const ts_scoring_policy* policy)
+{
+    return guarded(document, [&]() {
+        if (!document->model) {
+            return fail(document, TS_INVALID_DOCUMENT, "the document is not loaded");
+        }
+
+        const auto scoring = policyOf(policy);
+
+        if (!scoring || !policy) {
+            return fail(document, TS_INVALID_ARGUMENT, "weights must be positive, normalization and arithmetic one of their enums");
+        }
+
+        document->model->setScoringPolicy(scoring.value());
+
+        return TS_OK;
+    });
+}
+
+ts_status ts_document_apply_edits(ts_document* document, const ts_edit* edits, size_t count, size_t* applied)
+{
+    if (applied) {
+        *applied = 0;
+    }
+
+    return guarded(document, [&]() {
+        if (!document->model) {
+            return fail(document, TS_INVALID_DOCUMENT, "the document is not loaded");
+        }
+        if (!edits && count > 0) {
+            return fail(document, TS_INVALID_ARGUMENT, "edits are missing");
+        }
+
+        auto& model = document->model.value();
+
+        for (auto i = std::size_t(0); i < count; i++) {
+            const auto& edit = edits[i];
+            const auto subjectId = ts::Subject::Id(edit.subject_id);
+            const auto articleId = ts::Article::Id(edit.article_id);
+
+            const auto needsSubject = edit.kind == TS_EDIT_SET_APPEARANCE || edit.kind == TS_EDIT_CLEAR_APPEARANCE || edit.kind == TS_EDIT_SET_FIRST_APPEARANCE;
+
+            // the model trusts the ids it is given
+            if (needsSubject && !model.hasSubject(subjectId)) {
+                return fail(document, TS_EDIT_FAILED, "edit " + std::to_string(i) + ": no subject " + std::to_string(edit.subject_id));
+            }
+            if (!model.hasArticle(articleId)) {
+                return fail(document, TS_EDIT_FAILED, "edit " + std::to_string(i) + ": no article " + std::to_string(edit.article_id));
+            }
+
+            try {
+                switch (edit.kind) {
+                case TS_EDIT_SET_APPEARANCE:
+                    model.setAppearance(subjectId, articleId, true);
+                    break;
+                case TS_EDIT_CLEAR_APPEARANCE:
+                    model.setAppearance(subjectId, articleId, false);
+                    break;
+                case TS_EDIT_SET_FIRST_APPEARANCE:
+                    model.setFirstAppearance(subjectId, articleId);
+                    break;
+                case TS_EDIT_TOGGLE_SUBJECT_APPEARANCE:
+                    model.toggleSubjectAppearance(articleId);
+                    break;
+                case TS_EDIT_REMOVE_ARTICLE:
+                    model.removeArticle(articleId);
+                    break;
+                default:
+                    return fail(document, TS_EDIT_FAILED, "edit " + std::to_string(i) + ": unknown kind " + std::to_string(edit.kind));
+                }
+            } catch (const ts::ThereMustBeAtLeastOneSubject&) {
+                return fail(document, TS_EDIT_FAILED, "edit " + std::to_string(i) + ": the last dot of an article can't be cleared");
+            }
+
+            if (applied) {
+                *applied = i + 1;
+            }
+        }
+
+        return TS_OK;
+    });
+}
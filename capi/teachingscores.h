@@ -0,0 +1,129 @@
+#ifndef TEACHINGSCORES_H
+#define TEACHINGSCORES_H
+
+/*
+ * C interface of the scoring core. Documents are opaque handles, every call on one
+ * document must come from one thread at a time. Arrays passed in are only read during
+ * the call, arrays passed out are owned by the caller.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(TS_C_API_BUILD)
+#    define TS_API __declspec(dllexport)
+#  else
+#    define TS_API __declspec(dllimport)
+#  endif
+#else
+#  define TS_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* bumped on every incompatible change of the declarations below */
+#define TS_ABI_VERSION 2
+
+typedef struct ts_document ts_document;
+
+typedef enum ts_status {
+    TS_OK = 0,
+    TS_INVALID_ARGUMENT = 1,
+    TS_INVALID_DOCUMENT = 2,
+    TS_EDIT_FAILED = 3,
+    TS_BUFFER_TOO_SMALL = 4,
+    TS_INTERNAL_ERROR = 5
+} ts_status;
+
+typedef enum ts_normalization {
+    TS_NORMALIZATION_SUBJECTS = 0,
+    TS_NORMALIZATION_SPAN = 1
+} ts_normalization;
+
+/* exact arithmetic gives bitwise the same scores whatever the thread count */
+typedef enum ts_arithmetic {
+    TS_ARITHMETIC_FLOAT = 0,
+    TS_ARITHMETIC_EXACT = 1
+} ts_arithmetic;
+
+typedef struct ts_scoring_policy {
+    /* weights from 1 to 100 */
+    int32_t p_1;
+    int32_t p_2;
+    int32_t normalization; /* ts_normalization */
+    int32_t arithmetic; /* ts_arithmetic */
+} ts_scoring_policy;
+
+typedef struct ts_article_scores {
+    uint32_t article_id;
+    float l;
+    float c;
+    float h;
+} ts_article_scores;
+
+typedef enum ts_edit_kind {
+    TS_EDIT_SET_APPEARANCE = 0,
+    TS_EDIT_CLEAR_APPEARANCE = 1,
+    TS_EDIT_SET_FIRST_APPEARANCE = 2,
+    TS_EDIT_TOGGLE_SUBJECT_APPEARANCE = 3,
+    TS_EDIT_REMOVE_ARTICLE = 4
+} ts_edit_kind;
+
+typedef struct ts_edit {
+    int32_t kind; /* ts_edit_kind */
+    uint32_t subject_id; /* ignored by the kinds that only take an article */
+    uint32_t article_id;
+} ts_edit;
+
+TS_API uint32_t ts_abi_version(void);
+
+TS_API ts_document* ts_document_create(void);
+TS_API void ts_document_destroy(ts_document* document);
+
+/* message of the last failed call on the document, empty after a successful one */
+TS_API const char* ts_document_last_error(const ts_document* document);
+
+/*
+ * Replaces the document with the given one and scores it in parallel.
+ * Subjects are given in column order. Articles refer to subjects by their index:
+ * the first appearance of article i is subject first_appearance[i], and its dots are
+ * appearance_subjects[appearance_offsets[i]] ... appearance_subjects[appearance_offsets[i + 1] - 1].
+ * Names are NUL-terminated UTF-8, either name array may be NULL for unnamed documents.
+ * The rows are read straight into the document's own memory with no intermediate copy.
+ */
+TS_API ts_status ts_document_load(ts_document* document,
+                                  const uint32_t* subject_ids, const char* const* subject_names, size_t subjects_count,
+                                  const uint32_t* article_ids, const char* const* article_names, size_t articles_count,
+                                  const uint32_t* first_appearance,
+                                  const uint32_t* appearance_offsets, const uint32_t* appearance_subjects,
+                                  const ts_scoring_policy* policy);
+
+TS_API size_t ts_document_articles_count(const ts_document* document);
+TS_API size_t ts_document_subjects_count(const ts_document* document);
+
+/* C_nu, NAN for a document without articles */
+TS_API float ts_document_c_nu(const ts_document* document);
+
+/*
+ * Writes the scores of every article in document order. Fails with TS_BUFFER_TOO_SMALL
+ * when capacity is below ts_document_articles_count, nothing is written then.
+ */
+TS_API ts_status ts_document_score_all(const ts_document* document, ts_article_scores* scores, size_t capacity);
+
+/* rescores every article in parallel */
+TS_API ts_status ts_document_set_scoring_policy(ts_document* document, const ts_scoring_policy* policy);
+
+/*
+ * Applies the edits in order and rescores the articles they touch. Stops at the
+ * first edit that can't be applied, the edits before it stay applied. applied may be NULL.
+ */
+TS_API ts_status ts_document_apply_edits(ts_document* document, const ts_edit* edits, size_t count, size_t* applied);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TEACHINGSCORES_H */
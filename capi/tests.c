@@ -0,0 +1,198 @@
+/*
+ * Checks of the C interface: load, score and free a small document, and the status and
+ * last error of every call given invalid arguments. Exits with the count of failed checks.
+ */
+
+#include "teachingscores.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define EXPECT(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+#define EXPECT_STATUS(document, call, status) \
+    do { \
+        const ts_status actual = (call); \
+        if (actual != (status)) { \
+            fprintf(stderr, "%s:%d: %s returned %d instead of %d: %s\n", __FILE__, __LINE__, #call, (int)actual, (int)(status), \
+                    ts_document_last_error(document)); \
+            failures++; \
+        } \
+    } while (0)
+
+/* three subjects, four articles */
+static const uint32_t subject_ids[] = { 10, 20, 30 };
+static const char* const subject_names[] = { "Algebra", "Geometry", NULL };
+static const uint32_t article_ids[] = { 7, 3, 42, 5 };
+static const char* const article_names[] = { "Sets", "Angles", "Vectors", "Limits" };
+static const uint32_t first_appearance[] = { 0, 1, 0, 2 };
+static const uint32_t offsets[] = { 0, 2, 3, 6, 7 };
+static const uint32_t dots[] = { 0, 2, 1, 0, 1, 2, 2 };
+
+static ts_status load(ts_document* document, const ts_scoring_policy* policy)
+{
+    return ts_document_load(document, subject_ids, subject_names, 3, article_ids, article_names, 4, first_appearance, offsets, dots, policy);
+}
+
+static int same_scores(const ts_article_scores* a, const ts_article_scores* b, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (a[i].article_id != b[i].article_id || a[i].l != b[i].l || a[i].c != b[i].c || a[i].h != b[i].h) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static void test_load_and_score(void)
+{
+    ts_document* document = ts_document_create();
+    const ts_scoring_policy policy = { 1, 2, TS_NORMALIZATION_SUBJECTS, TS_ARITHMETIC_FLOAT };
+    ts_article_scores scores[4];
+
+    EXPECT(document != NULL);
+    EXPECT(isnan(ts_document_c_nu(document)));
+    EXPECT_STATUS(document, ts_document_score_all(document, scores, 4), TS_INVALID_DOCUMENT);
+
+    EXPECT_STATUS(document, load(document, &policy), TS_OK);
+    EXPECT(strcmp(ts_document_last_error(document), "") == 0);
+    EXPECT(ts_document_subjects_count(document) == 3);
+    EXPECT(ts_document_articles_count(document) == 4);
+    EXPECT(!isnan(ts_document_c_nu(document)));
+
+    EXPECT_STATUS(document, ts_document_score_all(document, scores, 4), TS_OK);
+
+    for (size_t i = 0; i < 4; i++) {
+        EXPECT(scores[i].article_id == article_ids[i]);
+        EXPECT(isfinite(scores[i].l) && isfinite(scores[i].c) && isfinite(scores[i].h));
+    }
+
+    /* a dot set and cleared again leaves the scores as they were */
+    ts_article_scores edited[4];
+    const ts_edit round_trip[] = {
+        { TS_EDIT_SET_APPEARANCE, 20, 7 },
+        { TS_EDIT_CLEAR_APPEARANCE, 20, 7 }
+    };
+    size_t applied = 0;
+
+    EXPECT_STATUS(document, ts_document_apply_edits(document, round_trip, 2, &applied), TS_OK);
+    EXPECT(applied == 2);
+    EXPECT_STATUS(document, ts_document_score_all(document, edited, 4), TS_OK);
+    EXPECT(same_scores(scores, edited, 4));
+
+    /* the articles after a removed one move up */
+    const ts_edit removal = { TS_EDIT_REMOVE_ARTICLE, 0, 3 };
+
+    EXPECT_STATUS(document, ts_document_apply_edits(document, &removal, 1, NULL), TS_OK);
+    EXPECT(ts_document_articles_count(document) == 3);
+    EXPECT_STATUS(document, ts_document_score_all(document, edited, 3), TS_OK);
+    EXPECT(edited[1].article_id == 42 && edited[2].article_id == 5);
+
+    const ts_scoring_policy exact_policy = { 3, 100, TS_NORMALIZATION_SPAN, TS_ARITHMETIC_EXACT };
+
+    EXPECT_STATUS(document, ts_document_set_scoring_policy(document, &exact_policy), TS_OK);
+    EXPECT(!isnan(ts_document_c_nu(document)));
+
+    ts_document_destroy(document);
+}
+
+static void test_invalid_arguments(void)
+{
+    ts_document* document = ts_document_create();
+    const ts_scoring_policy policy = { 1, 2, TS_NORMALIZATION_SUBJECTS, TS_ARITHMETIC_FLOAT };
+    ts_article_scores scores[4];
+
+    /* no document */
+    EXPECT_STATUS(NULL, load(NULL, &policy), TS_INVALID_ARGUMENT);
+    EXPECT_STATUS(NULL, ts_document_score_all(NULL, scores, 4), TS_INVALID_ARGUMENT);
+    EXPECT_STATUS(NULL, ts_document_set_scoring_policy(NULL, &policy), TS_INVALID_ARGUMENT);
+    EXPECT_STATUS(NULL, ts_document_apply_edits(NULL, NULL, 0, NULL), TS_INVALID_ARGUMENT);
+    EXPECT(ts_document_articles_count(NULL) == 0);
+    EXPECT(ts_document_subjects_count(NULL) == 0);
+    EXPECT(isnan(ts_document_c_nu(NULL)));
+    EXPECT(strlen(ts_document_last_error(NULL)) > 0);
+    ts_document_destroy(NULL);
+
+    /* documents that don't load keep the one loaded before */
+    const ts_scoring_policy zero_weight = { 0, 2, TS_NORMALIZATION_SUBJECTS, TS_ARITHMETIC_FLOAT };
+    const ts_scoring_policy heavy_weight = { 1, 101, TS_NORMALIZATION_SUBJECTS, TS_ARITHMETIC_FLOAT };
+    const ts_scoring_policy unknown_normalization = { 1, 2, 7, TS_ARITHMETIC_FLOAT };
+    const ts_scoring_policy unknown_arithmetic = { 1, 2, TS_NORMALIZATION_SUBJECTS, -1 };
+    const uint32_t bad_first_appearance[] = { 0, 1, 3, 2 };
+    const uint32_t bad_offsets[] = { 0, 2, 1, 6, 7 };
+    const uint32_t bad_dots[] = { 0, 2, 1, 0, 9, 2, 2 };
+    const uint32_t duplicate_article_ids[] = { 7, 3, 7, 5 };
+
+    EXPECT_STATUS(document, load(document, &policy), TS_OK);
+
+    EXPECT_STATUS(document, ts_document_load(document, NULL, NULL, 3, article_ids, NULL, 4, first_appearance, offsets, dots, &policy), TS_INVALID_ARGUMENT);
+    EXPECT(strlen(ts_document_last_error(document)) > 0);
+    EXPECT_STATUS(document, ts_document_load(document, subject_ids, NULL, 0, article_ids, NULL, 4, first_appearance, offsets, dots, &policy), TS_INVALID_ARGUMENT);
+    EXPECT_STATUS(document, ts_document_load(document, subject_ids, NULL, 3, NULL, NULL, 4, first_appearance, offsets, dots, &policy), TS_INVALID_ARGUMENT);
+    EXPECT_STATUS(document, ts_document_load(document, subject_ids, NULL, 3, article_ids, NULL, 4, first_appearance, offsets, NULL, &policy), TS_INVALID_ARGUMENT);
+    EXPECT_STATUS(document, load(document, &zero_weight), TS_INVALID_ARGUMENT);
+    EXPECT_STATUS(document, load(document, &heavy_weight), TS_INVALID_ARGUMENT);
+    EXPECT_STATUS(document, load(document, &unknown_normalization), TS_INVALID_ARGUMENT);
+    EXPECT_STATUS(document, load(document, &unknown_arithmetic), TS_INVALID_ARGUMENT);
+    EXPECT_STATUS(document, ts_document_load(document, subject_ids, NULL, 3, article_ids, NULL, 4, bad_first_appearance, offsets, dots, &policy), TS_INVALID_DOCUMENT);
+    EXPECT_STATUS(document, ts_document_load(document, subject_ids, NULL, 3, article_ids, NULL, 4, first_appearance, bad_offsets, dots, &policy), TS_INVALID_DOCUMENT);
+    EXPECT_STATUS(document, ts_document_load(document, subject_ids, NULL, 3, article_ids, NULL, 4, first_appearance, offsets, bad_dots, &policy), TS_INVALID_DOCUMENT);
+    EXPECT_STATUS(document, ts_document_load(document, subject_ids, NULL, 3, duplicate_article_ids, NULL, 4, first_appearance, offsets, dots, &policy), TS_INVALID_DOCUMENT);
+
+    EXPECT(ts_document_articles_count(document) == 4);
+
+    /* scores */
+    EXPECT_STATUS(document, ts_document_score_all(document, scores, 3), TS_BUFFER_TOO_SMALL);
+    EXPECT_STATUS(document, ts_document_score_all(document, NULL, 4), TS_BUFFER_TOO_SMALL);
+
+    /* scoring policy */
+    EXPECT_STATUS(document, ts_document_set_scoring_policy(document, NULL), TS_INVALID_ARGUMENT);
+    EXPECT_STATUS(document, ts_document_set_scoring_policy(document, &heavy_weight), TS_INVALID_ARGUMENT);
+
+    /* edits stop at the first one that can't be applied */
+    const ts_edit unknown_subject[] = { { TS_EDIT_SET_APPEARANCE, 20, 7 }, { TS_EDIT_SET_APPEARANCE, 99, 7 } };
+    const ts_edit unknown_article[] = { { TS_EDIT_TOGGLE_SUBJECT_APPEARANCE, 0, 99 } };
+    const ts_edit unknown_kind[] = { { 42, 10, 7 } };
+    const ts_edit last_dot[] = { { TS_EDIT_CLEAR_APPEARANCE, 20, 3 } };
+    size_t applied = 99;
+
+    EXPECT_STATUS(document, ts_document_apply_edits(document, NULL, 1, &applied), TS_INVALID_ARGUMENT);
+    EXPECT(applied == 0);
+    EXPECT_STATUS(document, ts_document_apply_edits(document, unknown_subject, 2, &applied), TS_EDIT_FAILED);
+    EXPECT(applied == 1);
+    EXPECT_STATUS(document, ts_document_apply_edits(document, unknown_article, 1, &applied), TS_EDIT_FAILED);
+    EXPECT(applied == 0);
+    EXPECT_STATUS(document, ts_document_apply_edits(document, unknown_kind, 1, &applied), TS_EDIT_FAILED);
+    EXPECT_STATUS(document, ts_document_apply_edits(document, last_dot, 1, &applied), TS_EDIT_FAILED);
+    EXPECT(strlen(ts_document_last_error(document)) > 0);
+
+    /* a successful call clears the last error */
+    EXPECT_STATUS(document, ts_document_apply_edits(document, NULL, 0, &applied), TS_OK);
+    EXPECT(strcmp(ts_document_last_error(document), "") == 0);
+
+    ts_document_destroy(document);
+}
+
+int main(void)
+{
+    EXPECT(ts_abi_version() == TS_ABI_VERSION);
+
+    test_load_and_score();
+    test_invalid_arguments();
+
+    if (failures == 0) {
+        printf("OK\n");
+    }
+
+    return failures;
+}
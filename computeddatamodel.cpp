@@ -0,0 +1,861 @@
+#include "computeddatamodel.h"
+#include "parallel.h"
+#include "diagnostics/profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <ranges>
+#include <stdexcept>
+#include <unordered_set>
+
+using namespace ts;
+
+namespace {
+    // Moves the node containers of data into the given resource
+    Data withResource(Data&& data, std::pmr::memory_resource* resource)
+    {
+        return Data {
+            .subjects = std::move(data.subjects),
+            .articles = std::move(data.articles),
+            .firstAppearance = FirstAppearanceMap(std::move(data.firstAppearance), resource),
+            .appearance = AppearanceMap(std::move(data.appearance), resource),
+            .scoring = data.scoring,
+            .strings = std::move(data.strings)
+        };
+    }
+}
+
+ComputedDataModel ComputedDataModel::compute(VerifiedData &&verified_data)
+{
+    return compute(std::move(verified_data), std::make_unique<DocumentMemory>());
+}
+
+ComputedDataModel ComputedDataModel::compute(VerifiedData&& verified_data, std::unique_ptr<DocumentMemory> memory)
+{
+    return compute(std::move(verified_data), std::move(memory), IdMode::Original);
+}
+
+ComputedDataModel ComputedDataModel::compute(VerifiedData&& verified_data, std::unique_ptr<DocumentMemory> memory, IdMode ids)
+{
+    TS_PROFILE_SCOPE("ComputedDataModel::compute");
+
+    auto data = withResource(std::move(verified_data).data(), memory->resource());
+
+    auto remap = ids == IdMode::Compact ? std::optional(IdRemap::compact(data)) : std::nullopt;
+
+    auto metricDefinitions = algorithm::MetricRegistry::instance().metrics();
+
+    std::vector<float> metricValues;
+    auto computedArticles = computeArticles(data, metricDefinitions, metricValues);
+
+    ComputedDataMap computedData(memory->resource());
+    algorithm::MetricTable metrics(metricDefinitions.size(), memory->resource());
+    for (auto i = 0u; i < data.articles.size(); i++) {
+        computedData.insert_or_assign(data.articles[i].id, std::move(computedArticles[i]));
+        metrics.set(data.articles[i].id, std::span(metricValues).subspan(i * metricDefinitions.size(), metricDefinitions.size()));
+    }
+
+    auto lastArticleId = data.articles.empty() ? Article::Id{0} : data.articles.front().id;
+    for (const auto& article: data.articles) {
+        lastArticleId = std::max(article.id, lastArticleId);
+    }
+
+    auto lastSubjectId = data.subjects.front().id;
+    for (const auto& subject: data.subjects) {
+        lastSubjectId = std::max(subject.id, lastSubjectId);
+    }
+
+    return ComputedDataModel(std::move(memory), std::move(data), std::move(computedData), std::move(metricDefinitions), std::move(metrics), lastArticleId, lastSubjectId, std::move(remap));
+}
+
+ComputedDataModel& ComputedDataModel::operator=(ComputedDataModel&& other) noexcept
+{
+    ComputedDataModel(std::move(other)).swap(*this);
+
+    return *this;
+}
+
+void ComputedDataModel::swap(ComputedDataModel& other) noexcept
+{
+    using std::swap;
+
+    swap(m_document, other.m_document);
+    swap(m_metricDefinitions, other.m_metricDefinitions);
+    swap(m_positions, other.m_positions);
+    swap(m_columns, other.m_columns);
+    swap(m_C_nu, other.m_C_nu);
+    swap(m_fixedCSum, other.m_fixedCSum);
+    swap(m_lastArticleId, other.m_lastArticleId);
+    swap(m_lastSubjectId, other.m_lastSubjectId);
+    swap(m_remap, other.m_remap);
+    swap(m_journal, other.m_journal);
+}
+
+ComputedDataModel::Document::~Document()
+{
+    // the nodes go away with the memory instead of one by one
+    memory->abandon(data.firstAppearance);
+    memory->abandon(data.appearance);
+    memory->abandon(computedData);
+    metrics.abandon(*memory);
+}
+
+void ComputedDataModel::setAppearance(Subject::Id subjectId, Article::Id articleId, bool appearance)
+{
+    TS_PROFILE_SCOPE("ComputedDataModel::setAppearance");
+
+    if (!hasArticle(articleId) || !hasSubject(subjectId)) {
+        throw std::runtime_error("There are no such article or subject");
+    }
+
+    auto& articleAppearance = m_document->data.appearance.at(articleId);
+
+    if (appearance) {
+        articleAppearance.insert(subjectId);
+    } else {
+        if (articleAppearance.size() == 1 && articleAppearance.count(subjectId) == 1) {
+            throw ThereMustBeAtLeastOneSubject{};
+        }
+        articleAppearance.erase(subjectId);
+    }
+
+    const auto oldC = m_document->computedData.at(articleId).c;
+    const auto newComputedData = computeData(articleId);
+
+    m_document->computedData.insert_or_assign(articleId, newComputedData);
+
+    updateC_nu(oldC, newComputedData.c);
+
+    if (m_journal) {
+        m_journal->setAppearance(originalId(subjectId), originalId(articleId), appearance);
+    }
+}
+
+void ComputedDataModel::setFirstAppearance(Subject::Id subjectId, Article::Id articleId)
+{
+    TS_PROFILE_SCOPE("ComputedDataModel::setFirstAppearance");
+
+    if (!hasArticle(articleId) || !hasSubject(subjectId)) {
+        throw std::runtime_error("There are no such article or subject");
+    }
+
+    m_document->data.firstAppearance.insert_or_assign(articleId, subjectId);
+
+    const auto oldC = m_document->computedData.at(articleId).c;
+
+    const auto newComputedData = computeData(articleId);
+
+    m_document->computedData.insert_or_assign(articleId, newComputedData);
+
+    updateC_nu(oldC, newComputedData.c);
+
+    if (m_journal) {
+        m_journal->setFirstAppearance(originalId(subjectId), originalId(articleId));
+    }
+}
+
+Subject::Id ComputedDataModel::addSubject(std::string&& name)
+{
+    auto subjectId = Subject::Id(++m_lastSubjectId);
+
+    if (m_remap) {
+        m_remap->subjects.add(subjectId);
+    }
+
+    m_document->data.subjects.emplace_back(Subject { .id = subjectId, .name = m_document->data.strings->intern(name) });
+
+    recomputeAll();
+
+    if (m_journal) {
+        m_journal->addSubject(m_document->data.subjects.back().name.view());
+    }
+
+    return subjectId;
+}
+
+Article::Id ComputedDataModel::addArticle(std::string&& name)
+{
+    const auto names = std::array { std::string_view(name) };
+
+    return addArticles(names).front();
+}
+
+std::vector<Article::Id> ComputedDataModel::addArticles(std::span<const std::string_view> names)
+{
+    TS_PROFILE_SCOPE("ComputedDataModel::addArticles");
+
+    const auto firstSubject = m_document->data.subjects.front().id;
+
+    std::vector<Article::Id> articleIds;
+    articleIds.reserve(names.size());
+    m_document->data.articles.reserve(m_document->data.articles.size() + names.size());
+
+    for (const auto name : names) {
+        const auto articleId = Article::Id(++m_lastArticleId);
+
+        if (m_remap) {
+            m_remap->articles.add(articleId);
+        }
+
+        m_document->data.articles.emplace_back(Article { .id = articleId, .name = m_document->data.strings->intern(name) });
+
+        m_document->data.appearance.insert_or_assign(articleId, SubjectIdSet { firstSubject });
+        m_document->data.firstAppearance.insert_or_assign(articleId, firstSubject);
+
+        articleIds.push_back(articleId);
+
+        if (m_journal) {
+            m_journal->addArticle(m_document->data.articles.back().name.view());
+        }
+    }
+
+    // the document is only read while the new rows are scored
+    std::vector<algorithm::ComputedData> scores(articleIds.size());
+    std::vector<float> metricValues(articleIds.size() * m_metricDefinitions.size());
+    const auto metricsCount = m_metricDefinitions.size();
+
+    ts::parallel::forEachIndex(articleIds.size(), [&](std::size_t i) {
+        const auto values = std::span(metricValues).subspan(i * metricsCount, metricsCount);
+
+        scores[i] = algorithm::computeMetrics(m_document->data.subjects, m_positions, m_document->data.firstAppearance, m_document->data.appearance, articleIds[i], m_document->data.scoring, m_metricDefinitions, values);
+    });
+
+    std::vector<float> addedC;
+    addedC.reserve(scores.size());
+
+    for (auto i = 0u; i < articleIds.size(); i++) {
+        m_document->metrics.set(articleIds[i], std::span(metricValues).subspan(i * metricsCount, metricsCount));
+        m_columns.setRow(articleIds[i], m_document->data.appearance.at(articleIds[i]), firstSubject, scores[i]);
+        m_document->computedData.insert_or_assign(articleIds[i], scores[i]);
+
+        addedC.push_back(scores[i].c);
+    }
+
+    updateC_nu(addedC, {});
+
+    return articleIds;
+}
+
+void ComputedDataModel::renameArticle(int index, std::string &&name)
+{
+    m_document->data.articles.at(index).name = m_document->data.strings->intern(name);
+
+    if (m_journal) {
+        m_journal->renameArticle(index, name);
+    }
+
+    reclaimStrings();
+}
+
+void ComputedDataModel::renameSubject(int index, std::string &&name)
+{
+    m_document->data.subjects.at(index).name = m_document->data.strings->intern(name);
+
+    if (m_journal) {
+        m_journal->renameSubject(index, name);
+    }
+
+    reclaimStrings();
+}
+
+const std::vector<Subject> &ComputedDataModel::getSubjects() const noexcept
+{
+    return m_document->data.subjects;
+}
+
+const std::vector<Article> &ComputedDataModel::getArticles() const noexcept
+{
+    return m_document->data.articles;
+}
+
+void ComputedDataModel::setSubjects(std::vector<Subject>&& subjects)
+{
+    TS_PROFILE_SCOPE("ComputedDataModel::setSubjects");
+
+    if (subjects.empty()) {
+        throw std::runtime_error("There must be at least one subject");
+    }
+
+    std::set<Subject::Id> subjectIds;
+
+    for (const auto& [id, _] : subjects) {
+        if (subjectIds.contains(id)) {
+            throw std::runtime_error("There are duplicated subject ids");
+        }
+        subjectIds.insert(id);
+    }
+
+    for (const auto& [id, _] : subjects) {
+        if (m_remap && unsigned(id) > m_lastSubjectId) {
+            m_remap->subjects.add(id);
+        }
+
+        m_lastSubjectId = std::max(m_lastSubjectId, unsigned(id));
+    }
+
+    m_document->data.subjects = std::move(subjects);
+
+    for (auto& subject : m_document->data.subjects) {
+        subject.name = m_document->data.strings->intern(subject.name.view());
+    }
+
+    for (auto& [articleId, m] : m_document->data.appearance) {
+        erase_if(m, [&](Subject::Id id) { return !subjectIds.contains(id); });
+
+        if (m.empty()) {
+            m.insert(m_document->data.subjects.front().id);
+        }
+    }
+
+    for (auto& [articleId, subjectId] : m_document->data.firstAppearance) {
+        if (!subjectIds.contains(subjectId)) {
+            subjectId = m_document->data.subjects.front().id;
+        }
+    }
+
+    recomputeAll();
+
+    if (m_journal) {
+        auto subjects = m_document->data.subjects;
+
+        for (auto& subject : subjects) {
+            subject.id = originalId(subject.id);
+        }
+
+        m_journal->setSubjects(subjects);
+    }
+
+    reclaimStrings();
+}
+
+const ScoringPolicy& ComputedDataModel::getScoringPolicy() const noexcept
+{
+    return m_document->data.scoring;
+}
+
+void ComputedDataModel::setScoringPolicy(const ScoringPolicy& policy)
+{
+    TS_PROFILE_SCOPE("ComputedDataModel::setScoringPolicy");
+
+    if (!ScoringPolicy::isValidWeight(policy.p_1) || !ScoringPolicy::isValidWeight(policy.p_2)) {
+        throw std::runtime_error("Scoring weights must be from " + std::to_string(ScoringPolicy::minWeight) + " to " + std::to_string(ScoringPolicy::maxWeight));
+    }
+
+    m_document->data.scoring = policy;
+
+    recomputeAll();
+
+    if (m_journal) {
+        m_journal->setScoringPolicy(policy);
+    }
+}
+
+void ComputedDataModel::removeArticle(Article::Id articleId)
+{
+    removeArticles({ articleId });
+}
+
+void ComputedDataModel::removeArticles(const std::vector<Article::Id>& articleIds)
+{
+    TS_PROFILE_SCOPE("ComputedDataModel::removeArticles");
+
+    std::unordered_set<unsigned> removed;
+    std::vector<float> removedC;
+
+    for (const auto articleId : articleIds) {
+        const auto iter = m_document->computedData.find(articleId);
+
+        if (iter == m_document->computedData.end() || !removed.insert(unsigned(articleId)).second) {
+            continue;
+        }
+
+        removedC.push_back(iter->second.c);
+
+        m_document->computedData.erase(iter);
+        m_document->data.appearance.erase(articleId);
+        m_document->data.firstAppearance.erase(articleId);
+        m_document->metrics.erase(articleId);
+        m_columns.eraseRow(articleId);
+
+        if (m_journal) {
+            m_journal->removeArticle(originalId(articleId));
+        }
+    }
+
+    if (removed.empty()) {
+        return;
+    }
+
+    std::erase_if(m_document->data.articles, [&](const Article& article) { return removed.contains(unsigned(article.id)); });
+
+    updateC_nu({}, removedC);
+
+    reclaimStrings();
+}
+
+void ComputedDataModel::reclaimStrings()
+{
+    // the pool never forgets a name, it is rebuilt from the live ones once the replaced
+    // and removed names outnumber them. Copies of the data keep the old pool alive
+    if (m_document->data.strings->size() <= 2 * (m_document->data.subjects.size() + m_document->data.articles.size()) + minReclaimedStrings) {
+        return;
+    }
+
+    TS_PROFILE_SCOPE("ComputedDataModel::reclaimStrings");
+
+    auto strings = std::make_shared<StringPool>();
+
+    for (auto& subject : m_document->data.subjects) {
+        subject.name = strings->intern(subject.name.view());
+    }
+
+    for (auto& article : m_document->data.articles) {
+        article.name = strings->intern(article.name.view());
+    }
+
+    m_document->data.strings = std::move(strings);
+}
+
+bool ComputedDataModel::hasSubject(Subject::Id id) const noexcept
+{
+    return std::ranges::find(m_document->data.subjects, id, &Subject::id) != m_document->data.subjects.end();
+}
+
+bool ComputedDataModel::hasArticle(Article::Id id) const noexcept
+{
+    return m_document->computedData.contains(id);
+}
+
+bool ComputedDataModel::isArticleAppearedAt(Article::Id articleId, Subject::Id subjectId) const
+{
+    auto articleColumn = m_document->data.appearance.find(articleId);
+
+    if (articleColumn == m_document->data.appearance.end()) {
+        return false;
+    }
+
+    return articleColumn->second.contains(subjectId);
+}
+
+bool ComputedDataModel::isArticleFirstAppearedAt(Article::Id articleId, Subject::Id subjectId) const
+{
+    auto articleColumn = m_document->data.firstAppearance.find(articleId);
+
+    if (articleColumn == m_document->data.firstAppearance.end()) {
+        throw std::runtime_error("There are no such article");
+    }
+
+    return articleColumn->second == subjectId;
+}
+
+const algorithm::ComputedData& ComputedDataModel::getComputedDataForArticle(Article::Id id) const
+{
+    auto article = m_document->computedData.find(id);
+
+    if (article == m_document->computedData.end()) {
+        throw std::runtime_error("There are no such article");
+    }
+
+    return article->second;
+}
+
+const std::vector<algorithm::Metric>& ComputedDataModel::getMetrics() const noexcept
+{
+    return m_metricDefinitions;
+}
+
+float ComputedDataModel::getMetricValue(Article::Id id, std::size_t metric) const
+{
+    return m_document->metrics.value(id, metric);
+}
+
+std::vector<algorithm::CellSensitivity> ComputedDataModel::computeSensitivity(Article::Id id) const
+{
+    return algorithm::computeToggleSensitivity(m_document->data.subjects, m_document->data.firstAppearance, m_document->data.appearance, id, m_document->data.scoring);
+}
+
+AppearanceColumns::SubjectLoad ComputedDataModel::getSubjectLoad(Subject::Id id) const
+{
+    const auto* load = m_columns.load(id);
+
+    if (!load) {
+        throw std::runtime_error("There are no such subject");
+    }
+
+    return *load;
+}
+
+tl::expected<std::vector<Article::Id>, std::string> ComputedDataModel::queryArticles(std::string_view query) const
+{
+    auto parsed = AppearanceQuery::parse(query, m_document->data.subjects);
+
+    if (!parsed) {
+        return tl::unexpected(parsed.error());
+    }
+
+    return parsed->evaluate(m_columns);
+}
+
+void ComputedDataModel::toggleSubjectAppearance(Article::Id id)
+{
+    TS_PROFILE_SCOPE("ComputedDataModel::toggleSubjectAppearance");
+
+    if (!hasArticle(id)) {
+        throw std::runtime_error("There are no such article");
+    }
+
+    auto& articleAppearance = m_document->data.appearance.at(id);
+
+    if (articleAppearance.size() == 1) {
+        SubjectIdSet subjectsSet(m_document->memory->resource());
+        for (const auto& subject : m_document->data.subjects) {
+            subjectsSet.insert(subject.id);
+        }
+        articleAppearance = std::move(subjectsSet);
+    } else {
+        articleAppearance.clear();
+        articleAppearance.insert(m_document->data.subjects.front().id);
+    }
+
+    auto data = computeData(id);
+    auto& computedData = m_document->computedData.at(id);
+
+    updateC_nu(computedData.c, data.c);
+
+    computedData = std::move(data);
+
+    if (m_journal) {
+        m_journal->toggleSubjectAppearance(originalId(id));
+    }
+}
+
+std::optional<float> ComputedDataModel::getC_nu() const noexcept
+{
+    return m_C_nu;
+}
+
+void ComputedDataModel::sort()
+{
+    TS_PROFILE_SCOPE("ComputedDataModel::sort");
+
+    class AppearanceOrder {
+    public:
+        AppearanceOrder(const SubjectIdSet& appearance,
+                        const std::vector<Subject>& subjects, float score)
+        {
+            m_score = score;
+
+            m_apperance.resize(subjects.size());
+
+            for (auto i = 0u; i < subjects.size(); ++i) {
+                m_apperance[i] = appearance.count(subjects[i].id);
+            }
+        }
+
+        std::strong_ordering operator<=>(const AppearanceOrder& e) const {
+            if (m_score != e.m_score) {
+                return m_score < e.m_score ? std::strong_ordering::less : std::strong_ordering::greater;
+            }
+
+            for (auto i = 0u; i < m_apperance.size(); ++i) {
+                if (m_apperance[i] != e.m_apperance[i]) {
+                    return !m_apperance[i] ? std::strong_ordering::less : std::strong_ordering::greater;
+                }
+            }
+
+            return std::strong_ordering::equal;
+        }
+
+    private:
+        std::vector<bool> m_apperance;
+        float m_score;
+    };
+
+    std::vector<std::pair<Article, AppearanceOrder>> articlesWithC;
+
+    articlesWithC.reserve(m_document->data.articles.size());
+
+    for (const auto& articleId : m_document->data.articles) {
+        articlesWithC.push_back({articleId, AppearanceOrder(m_document->data.appearance.at(articleId.id), m_document->data.subjects, m_document->computedData.at(articleId.id).h)});
+    }
+
+    std::ranges::sort(articlesWithC, std::greater{}, [](const auto& t) { return t.second; });
+
+    for (auto i = 0u; i < articlesWithC.size(); i++) {
+        m_document->data.articles[i] = std::move(articlesWithC[i].first);
+    }
+
+    if (m_journal) {
+        m_journal->sort();
+    }
+}
+
+VerifiedData ComputedDataModel::getData() const noexcept
+{
+    return ts::VerifiedData::unverifiedFromRawData(ts::Data(m_document->data));
+}
+
+VerifiedData ComputedDataModel::getOriginalData() const
+{
+    auto data = ts::Data(m_document->data);
+
+    if (m_remap) {
+        m_remap->restore(data);
+    }
+
+    return ts::VerifiedData::unverifiedFromRawData(std::move(data));
+}
+
+bool ComputedDataModel::hasCompactIds() const noexcept
+{
+    return m_remap.has_value();
+}
+
+Subject::Id ComputedDataModel::originalId(Subject::Id id) const
+{
+    return m_remap ? m_remap->subjects.originalOf(id) : id;
+}
+
+Article::Id ComputedDataModel::originalId(Article::Id id) const
+{
+    return m_remap ? m_remap->articles.originalOf(id) : id;
+}
+
+Subject::Id ComputedDataModel::subjectIdOf(Subject::Id original) const noexcept
+{
+    if (!m_remap) {
+        return original;
+    }
+
+    return m_remap->subjects.idOf(original).value_or(Subject::Id(0));
+}
+
+Subject::Id ComputedDataModel::addSubjectIdOf(Subject::Id original)
+{
+    if (!m_remap) {
+        return original;
+    }
+
+    if (const auto id = m_remap->subjects.idOf(original)) {
+        return id.value();
+    }
+
+    const auto id = Subject::Id(++m_lastSubjectId);
+    m_remap->subjects.add(id, original);
+
+    return id;
+}
+
+Article::Id ComputedDataModel::articleIdOf(Article::Id original) const noexcept
+{
+    if (!m_remap) {
+        return original;
+    }
+
+    return m_remap->articles.idOf(original).value_or(Article::Id(0));
+}
+
+std::vector<diagnostics::MemoryUsage> ComputedDataModel::memoryUsage() const
+{
+    diagnostics::MemoryUsage subjects { .component = "subjects" };
+    diagnostics::addVector(subjects, m_document->data.subjects);
+
+    diagnostics::MemoryUsage articles { .component = "articles" };
+    diagnostics::addVector(articles, m_document->data.articles);
+
+    diagnostics::MemoryUsage names { .component = "names", .bytes = m_document->data.strings->reservedBytes(), .allocations = m_document->data.strings->blocksCount() };
+
+    diagnostics::MemoryUsage firstAppearance { .component = "firstAppearance" };
+    diagnostics::addMap(firstAppearance, m_document->data.firstAppearance);
+
+    diagnostics::MemoryUsage appearance { .component = "appearance" };
+    diagnostics::addMap(appearance, m_document->data.appearance);
+    for (const auto& [_, subjectIds] : m_document->data.appearance) {
+        if (const auto bytes = subjectIds.memoryUsage()) {
+            appearance.bytes += bytes;
+            appearance.allocations++;
+        }
+    }
+
+    diagnostics::MemoryUsage computedData { .component = "computedData" };
+    diagnostics::addMap(computedData, m_document->computedData);
+
+    diagnostics::MemoryUsage metrics { .component = "metrics", .bytes = m_document->metrics.memoryUsage(), .allocations = m_document->metrics.metricsCount() };
+
+    diagnostics::MemoryUsage columns { .component = "appearanceColumns", .bytes = m_columns.memoryUsage(), .allocations = 2 * m_document->data.subjects.size() + 1 };
+
+    // nodes above are carved from the document pool, this is what the pool holds on top of them
+    const auto nodeBytes = firstAppearance.bytes + appearance.bytes + computedData.bytes + metrics.bytes;
+    diagnostics::MemoryUsage pool { .component = "documentPool", .bytes = m_document->memory->reservedBytes() - std::min(m_document->memory->reservedBytes(), nodeBytes), .allocations = m_document->memory->blocksCount() };
+
+    std::vector<diagnostics::MemoryUsage> res { std::move(subjects), std::move(articles), std::move(names), std::move(firstAppearance), std::move(appearance), std::move(computedData), std::move(metrics), std::move(columns), std::move(pool) };
+
+    if (m_remap) {
+        res.push_back(diagnostics::MemoryUsage { .component = "idRemap", .bytes = m_remap->subjects.memoryUsage() + m_remap->articles.memoryUsage(), .allocations = 4 });
+    }
+
+    return res;
+}
+
+void ComputedDataModel::setJournal(EditJournal* journal) noexcept
+{
+    m_journal = journal;
+}
+
+ComputedDataModel::ComputedDataModel(std::unique_ptr<DocumentMemory> memory, Data&& data, ComputedDataMap&& computedData, std::vector<algorithm::Metric>&& metricDefinitions, algorithm::MetricTable&& metrics, Article::Id lastArticleId, Subject::Id lastSubjectId, std::optional<IdRemap>&& remap)
+    : m_document(new Document { .memory = std::move(memory), .data = std::move(data), .computedData = std::move(computedData), .metrics = std::move(metrics) }), m_metricDefinitions(std::move(metricDefinitions)), m_positions(m_document->data.subjects), m_lastArticleId(lastArticleId), m_lastSubjectId(lastSubjectId), m_remap(std::move(remap))
+{
+    resetC_nu();
+    rebuildColumns();
+}
+
+std::optional<float> ComputedDataModel::computeC_nu(const ComputedDataMap& computedData)
+{
+    TS_PROFILE_SCOPE("ComputedDataModel::computeC_nu");
+
+    if (computedData.empty()) {
+        return std::nullopt;
+    }
+
+    float c_sum = 0;
+
+    for (const auto& [_, data] : computedData) {
+        c_sum += data.c;
+    }
+
+    return c_sum / computedData.size();
+}
+
+float ComputedDataModel::recomputeC_nu(float C_nu, float oldC, float newC, int size)
+{
+    TS_PROFILE_COUNT("ComputedDataModel::recomputeC_nu");
+
+    return C_nu - (oldC - newC) / size;
+}
+
+void ComputedDataModel::resetC_nu()
+{
+    if (m_document->data.scoring.arithmetic != Arithmetic::Exact) {
+        m_C_nu = computeC_nu(m_document->computedData);
+        return;
+    }
+
+    TS_PROFILE_SCOPE("ComputedDataModel::resetC_nu");
+
+    // integer sums don't depend on the order of the articles
+    m_fixedCSum = 0;
+
+    for (const auto& [_, data] : m_document->computedData) {
+        m_fixedCSum += algorithm::fixedOf(data.c);
+    }
+
+    m_C_nu = m_document->computedData.empty() ? std::nullopt : std::optional(algorithm::floatOf(m_fixedCSum, std::int64_t(m_document->computedData.size())));
+}
+
+void ComputedDataModel::updateC_nu(std::span<const float> addedC, std::span<const float> removedC)
+{
+    const auto size = m_document->computedData.size();
+
+    if (size == 0) {
+        m_C_nu = std::nullopt;
+        m_fixedCSum = 0;
+        return;
+    }
+
+    if (m_document->data.scoring.arithmetic == Arithmetic::Exact) {
+        for (const auto c : addedC) {
+            m_fixedCSum += algorithm::fixedOf(c);
+        }
+        for (const auto c : removedC) {
+            m_fixedCSum -= algorithm::fixedOf(c);
+        }
+
+        m_C_nu = algorithm::floatOf(m_fixedCSum, std::int64_t(size));
+        return;
+    }
+
+    const auto oldSize = size - addedC.size() + removedC.size();
+    auto c_sum = oldSize == 0 ? 0.0 : double(m_C_nu.value()) * double(oldSize);
+
+    for (const auto c : addedC) {
+        c_sum += c;
+    }
+    for (const auto c : removedC) {
+        c_sum -= c;
+    }
+
+    m_C_nu = float(c_sum / double(size));
+}
+
+void ComputedDataModel::updateC_nu(float oldC, float newC)
+{
+    if (m_document->data.scoring.arithmetic != Arithmetic::Exact) {
+        m_C_nu = recomputeC_nu(m_C_nu.value(), oldC, newC, int(m_document->computedData.size()));
+        return;
+    }
+
+    // exact, so edits never make C_nu drift away from a full recount
+    m_fixedCSum += algorithm::fixedOf(newC) - algorithm::fixedOf(oldC);
+
+    m_C_nu = algorithm::floatOf(m_fixedCSum, std::int64_t(m_document->computedData.size()));
+}
+
+algorithm::ComputedData ComputedDataModel::computeData(Article::Id articleId)
+{
+    TS_PROFILE_SCOPE("ComputedDataModel::computeData");
+
+    std::vector<float> values(m_metricDefinitions.size());
+
+    const auto res = algorithm::computeMetrics(m_document->data.subjects, m_positions, m_document->data.firstAppearance, m_document->data.appearance, articleId, m_document->data.scoring, m_metricDefinitions, values);
+
+    m_document->metrics.set(articleId, values);
+    m_columns.setRow(articleId, m_document->data.appearance.at(articleId), m_document->data.firstAppearance.at(articleId), res);
+
+    return res;
+}
+
+std::vector<algorithm::ComputedData> ComputedDataModel::computeArticles(const Data& data, const std::vector<algorithm::Metric>& metrics, std::vector<float>& metricValues)
+{
+    std::vector<algorithm::ComputedData> res(data.articles.size());
+    metricValues.assign(data.articles.size() * metrics.size(), 0.f);
+
+    const algorithm::SubjectPositions positions(data.subjects);
+
+    ts::parallel::forEachIndex(data.articles.size(), [&](std::size_t i) {
+        const auto values = std::span(metricValues).subspan(i * metrics.size(), metrics.size());
+
+        res[i] = ts::algorithm::computeMetrics(data.subjects, positions, data.firstAppearance, data.appearance, data.articles[i].id, data.scoring, metrics, values);
+    });
+
+    return res;
+}
+
+void ComputedDataModel::recomputeAll()
+{
+    m_positions = algorithm::SubjectPositions(m_document->data.subjects);
+
+    std::vector<float> metricValues;
+    const auto computedArticles = computeArticles(m_document->data, m_metricDefinitions, metricValues);
+
+    const auto metricsCount = m_metricDefinitions.size();
+
+    for (auto i = 0u; i < m_document->data.articles.size(); i++) {
+        m_document->computedData.insert_or_assign(m_document->data.articles[i].id, computedArticles[i]);
+        m_document->metrics.set(m_document->data.articles[i].id, std::span(metricValues).subspan(i * metricsCount, metricsCount));
+    }
+
+    resetC_nu();
+
+    rebuildColumns();
+}
+
+void ComputedDataModel::rebuildColumns()
+{
+    TS_PROFILE_SCOPE("ComputedDataModel::rebuildColumns");
+
+    m_columns.reset(m_document->data.subjects);
+
+    for (const auto& article : m_document->data.articles) {
+        m_columns.setRow(article.id, m_document->data.appearance.at(article.id), m_document->data.firstAppearance.at(article.id), m_document->computedData.at(article.id));
+    }
+}
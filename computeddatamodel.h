@@ -0,0 +1,153 @@
+#ifndef COMPUTEDDATAMODEL_H
+#define COMPUTEDDATAMODEL_H
+
+#include <Data.h>
+#include <documentmemory.h>
+#include <editjournal.h>
+#include <idremap.h>
+#include <appearancequery.h>
+#include <algorithm.h>
+#include <metrics.h>
+#include <sensitivity.h>
+#include <diagnostics/memoryusage.h>
+
+namespace ts {
+    class ThereMustBeAtLeastOneSubject : public std::exception {};
+
+    class ComputedDataModel {
+    public:
+        using ComputedDataMap = std::pmr::map<Article::Id, algorithm::ComputedData>;
+
+        static ComputedDataModel compute(VerifiedData&& data);
+        // Node containers of data that are already carved from memory are adopted as they
+        // are, so a document built in place over its own memory is never copied
+        static ComputedDataModel compute(VerifiedData&& data, std::unique_ptr<DocumentMemory> memory);
+        // With compact ids the model runs on ids renumbered by IdRemap, the ids of the
+        // document come back in getOriginalData and in the journal
+        static ComputedDataModel compute(VerifiedData&& data, std::unique_ptr<DocumentMemory> memory, IdMode ids);
+
+        ComputedDataModel(ComputedDataModel&& other) noexcept = default;
+        ComputedDataModel& operator=(ComputedDataModel&& other) noexcept;
+
+        void swap(ComputedDataModel& other) noexcept;
+
+        void setAppearance(Subject::Id, Article::Id, bool appearance);
+        void setFirstAppearance(Subject::Id, Article::Id);
+
+        Subject::Id addSubject(std::string&& name);
+        Article::Id addArticle(std::string&& article);
+        // new rows are scored in parallel and C_nu is updated once for all of them
+        std::vector<Article::Id> addArticles(std::span<const std::string_view> names);
+
+        void renameArticle(int index, std::string&& name);
+        void renameSubject(int index, std::string&& name);
+
+        const std::vector<Subject>& getSubjects() const noexcept;
+        const std::vector<Article>& getArticles() const noexcept;
+
+        void setSubjects(std::vector<Subject>&& subjects);
+        void removeArticle(Article::Id articleId);
+        // one pass over the articles whatever the count, C_nu follows the removed scores only
+        void removeArticles(const std::vector<Article::Id>& articleIds);
+
+        const ScoringPolicy& getScoringPolicy() const noexcept;
+        // rescores every article in parallel
+        void setScoringPolicy(const ScoringPolicy& policy);
+
+        bool hasSubject(Subject::Id id) const noexcept;
+        bool hasArticle(Article::Id id) const noexcept;
+
+        bool isArticleAppearedAt(Article::Id, Subject::Id) const;
+        bool isArticleFirstAppearedAt(Article::Id, Subject::Id) const;
+
+        const algorithm::ComputedData& getComputedDataForArticle(Article::Id id) const;
+
+        // metrics registered when the document was computed, in column order
+        const std::vector<algorithm::Metric>& getMetrics() const noexcept;
+        float getMetricValue(Article::Id id, std::size_t metric) const;
+        std::vector<algorithm::CellSensitivity> computeSensitivity(Article::Id id) const;
+
+        // counted as the document changes, never by a scan
+        AppearanceColumns::SubjectLoad getSubjectLoad(Subject::Id id) const;
+
+        // ids of the articles matching an AppearanceQuery, in ascending order
+        tl::expected<std::vector<Article::Id>, std::string> queryArticles(std::string_view query) const;
+
+        void toggleSubjectAppearance(Article::Id);
+
+        std::optional<float> getC_nu() const noexcept;
+
+        void sort();
+
+        VerifiedData getData() const noexcept;
+        // the data with the ids it was loaded with, what is exported to the document file
+        VerifiedData getOriginalData() const;
+
+        bool hasCompactIds() const noexcept;
+        Subject::Id originalId(Subject::Id id) const;
+        Article::Id originalId(Article::Id id) const;
+        // the id of the model for an original one. With compact ids an unknown one has
+        // id 0, which is never valid, without them it comes back as is, so check it
+        // with hasSubject or hasArticle
+        Subject::Id subjectIdOf(Subject::Id original) const noexcept;
+        Article::Id articleIdOf(Article::Id original) const noexcept;
+        // as subjectIdOf, but a subject the model hasn't seen is given the next free id
+        Subject::Id addSubjectIdOf(Subject::Id original);
+
+        std::vector<diagnostics::MemoryUsage> memoryUsage() const;
+
+        // every following mutation is recorded to the journal, pass nullptr to stop recording
+        void setJournal(EditJournal* journal) noexcept;
+    private:
+        ComputedDataModel(std::unique_ptr<DocumentMemory> memory, Data&& data, ComputedDataMap&& computedData, std::vector<algorithm::Metric>&& metricDefinitions, algorithm::MetricTable&& metrics, Article::Id lastArticleId, Subject::Id lastSubjectId, std::optional<IdRemap>&& remap);
+
+        static std::optional<float> computeC_nu(const ComputedDataMap& computedData);
+        static float recomputeC_nu(float C_nu, float oldC, float newC, int size);
+        // C_nu of the current scores in the arithmetic of the scoring policy
+        void resetC_nu();
+        void updateC_nu(float oldC, float newC);
+        // the computed data already holds the added articles and no longer the removed ones
+        void updateC_nu(std::span<const float> addedC, std::span<const float> removedC);
+
+        algorithm::ComputedData computeData(Article::Id articleId);
+        // metric values are returned row by row, metrics.size() values per article
+        static std::vector<algorithm::ComputedData> computeArticles(const Data& data, const std::vector<algorithm::Metric>& metrics, std::vector<float>& metricValues);
+        void recomputeAll();
+        void rebuildColumns();
+        // rebuilds the names pool when it holds mostly names no longer in the document
+        void reclaimStrings();
+
+        static constexpr std::size_t minReclaimedStrings = 4096;
+
+        // Everything carved from the document memory. A pmr container can't move to another
+        // resource, so models trade their documents by pointer
+        struct Document {
+            ~Document();
+
+            // declared first, so the containers are destroyed before their memory is released
+            std::unique_ptr<DocumentMemory> memory;
+            Data data;
+            ComputedDataMap computedData;
+            algorithm::MetricTable metrics;
+        };
+
+        std::unique_ptr<Document> m_document;
+
+        std::vector<algorithm::Metric> m_metricDefinitions;
+        // follows the order of the subjects, so sparse rows are scored from their dots
+        algorithm::SubjectPositions m_positions;
+        // follows every change of the appearance and of the scores
+        AppearanceColumns m_columns;
+        std::optional<float> m_C_nu;
+        // sum of c in fixed point, kept in exact arithmetic only
+        std::int64_t m_fixedCSum = 0;
+        unsigned m_lastArticleId = 0;
+        unsigned m_lastSubjectId = 0;
+        // only with compact ids
+        std::optional<IdRemap> m_remap;
+
+        EditJournal* m_journal = nullptr;
+    };
+}
+
+#endif // COMPUTEDDATAMODEL_H
@@ -1,7 +1,7 @@
 #ifndef DATAFORMATS_H
 #define DATAFORMATS_H
 
-#include "datamodel.h"
+#include "computeddatamodel.h"
 #include "libs/expected/include/tl/expected.hpp"
 
 namespace ts::formats {
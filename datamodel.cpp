@@ -1,316 +1,29 @@
 #include "datamodel.h"
+#include "parallel.h"
+#include "diagnostics/profiler.h"
 
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <ranges>
 #include <QColor>
 #include <QBrush>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
 
 using namespace ts;
 
-ComputedDataModel ComputedDataModel::compute(VerifiedData &&verified_data)
-{
-    auto data = std::move(verified_data).data();
-    std::map<Article::Id, algorithm::ComputedData> computedData;
-    for (const auto& article : data.articles) {
-        auto computedDataForArticle = ts::algorithm::computeOuterLinks(data.subjects, data.firstAppearance, data.appearance, article.id);
-        computedData.insert_or_assign(article.id, std::move(computedDataForArticle));
-    }
-
-    auto lastArticleId = data.articles.empty() ? Article::Id{0} : data.articles.front().id;
-    for (const auto& article: data.articles) {
-        lastArticleId = std::max(article.id, lastArticleId);
-    }
-
-    auto lastSubjectId = data.subjects.front().id;
-    for (const auto& subject: data.subjects) {
-        lastSubjectId = std::max(subject.id, lastSubjectId);
-    }
-
-    const auto C_nu = computeC_nu(computedData);
-
-    return ComputedDataModel(std::move(data), std::move(computedData), C_nu, lastArticleId, lastSubjectId);
-}
-
-class ThereMustBeAtLeastOneSubject : public std::exception {};
-
-void ComputedDataModel::setAppearance(Subject::Id subjectId, Article::Id articleId, bool appearance)
-{
-    auto& articleAppearance = m_data.appearance[articleId];
-
-    if (appearance) {
-        articleAppearance.insert(subjectId);
-    } else {
-        if (articleAppearance.size() == 1 && articleAppearance.count(subjectId) == 1) {
-            throw ThereMustBeAtLeastOneSubject{};
-        }
-        articleAppearance.erase(subjectId);
-    }
-
-    const auto oldC = m_computedData.at(articleId).c;
-    const auto newComputedData = computeData(articleId);
-
-    m_computedData.insert_or_assign(articleId, newComputedData);
-
-    m_C_nu = recomputeC_nu(m_C_nu.value(), oldC, newComputedData.c, int(m_computedData.size()));
-}
-
-void ComputedDataModel::setFirstAppearance(Subject::Id subjectId, Article::Id articleId)
-{
-    m_data.firstAppearance.insert_or_assign(articleId, subjectId);
-
-    const auto oldC = m_computedData.at(articleId).c;
-
-    const auto newComputedData = computeData(articleId);
-
-    m_computedData.insert_or_assign(articleId, newComputedData);
-
-    m_C_nu = recomputeC_nu(m_C_nu.value(), oldC, newComputedData.c, int(m_computedData.size()));
-}
-
-Subject::Id ComputedDataModel::addSubject(std::string&& name)
-{
-    auto subjectId = Subject::Id(++m_lastSubjectId);
-
-    m_data.subjects.emplace_back(Subject { .id = subjectId, .name = std::move(name) });
-
-    for (auto& [articleId, data] : m_computedData) {
-        data = computeData(articleId);
-    }
-
-    m_C_nu = computeC_nu(m_computedData);
-
-    return subjectId;
-}
-
-Article::Id ComputedDataModel::addArticle(std::string&& name)
-{
-    auto articleId = Article::Id(++m_lastArticleId);
-
-    m_data.articles.emplace_back(Article { .id = articleId, .name = std::move(name) });
-
-    m_data.appearance.insert_or_assign(articleId, std::set<Subject::Id> { m_data.subjects.front().id });
-    m_data.firstAppearance.insert_or_assign(articleId, m_data.subjects.front().id);
-
-    m_computedData.insert_or_assign(articleId, computeData(articleId));
-
-    m_C_nu = computeC_nu(m_computedData);
-
-    return articleId;
-}
-
-void ComputedDataModel::renameArticle(int index, std::string &&name)
-{
-    m_data.articles.at(index).name = std::move(name);
-}
-
-void ComputedDataModel::renameSubject(int index, std::string &&name)
-{
-    m_data.subjects.at(index).name = std::move(name);
-}
-
-const std::vector<Subject> &ComputedDataModel::getSubjects() const noexcept
-{
-    return m_data.subjects;
-}
-
-const std::vector<Article> &ComputedDataModel::getArticles() const noexcept
-{
-    return m_data.articles;
-}
-
-void ComputedDataModel::setSubjects(std::vector<Subject>&& subjects)
-{
-    if (subjects.empty()) {
-        throw std::exception("There must be atleast one subject");
-    }
-
-    std::set<Subject::Id> subjectIds;
-
-    for (const auto& [id, _] : subjects) {
-        if (subjectIds.contains(id)) {
-            std::exception("There are diplicated subject ids");
-        }
-        subjectIds.insert(id);
-    }
-
-    m_data.subjects = std::move(subjects);
-
-    for (auto& [articleId, m] : m_data.appearance) {
-        for (auto iter = m.begin(); iter != m.end();) {
-            if (!subjectIds.contains(*iter)) {
-                iter = m.erase(iter);
-            } else {
-                ++iter;
-            }
-        }
-    }
-
-    for (auto iter = m_data.firstAppearance.begin(); iter != m_data.firstAppearance.end();) {
-        if (!subjectIds.contains(iter->second)) {
-            iter = m_data.firstAppearance.erase(iter);
-        } else {
-            ++iter;
-        }
-    }
-
-    m_C_nu = computeC_nu(m_computedData);
-}
-
-void ComputedDataModel::removeArticle(Article::Id articleId)
-{
-    auto iter = std::ranges::remove(m_data.articles, articleId, &Article::id);
-    m_data.articles.erase(iter.begin(), iter.end());
-
-    m_data.appearance.erase(articleId);
-    m_data.firstAppearance.erase(articleId);
-
-    m_computedData.erase(articleId);
-
-    m_C_nu = computeC_nu(m_computedData);
-}
-
-bool ComputedDataModel::isArticleAppearedAt(Article::Id articleId, Subject::Id subjectId) const
-{
-    auto articleColumn = m_data.appearance.find(articleId);
-
-    if (articleColumn == m_data.appearance.end()) {
-        return false;
-    }
+namespace {
+    float maxSensitivityOf(const std::vector<ts::algorithm::CellSensitivity>& rowSensitivity)
+    {
+        auto res = 0.f;
 
-    return articleColumn->second.contains(subjectId);
-}
-
-bool ComputedDataModel::isArticleFirstAppearedAt(Article::Id articleId, Subject::Id subjectId) const
-{
-    auto articleColumn = m_data.firstAppearance.find(articleId);
-
-    if (articleColumn == m_data.firstAppearance.end()) {
-        throw std::exception("There are no such article");
-    }
-
-    return articleColumn->second == subjectId;
-}
-
-const algorithm::ComputedData& ComputedDataModel::getComputedDataForArticle(Article::Id id) const
-{
-    auto article = m_computedData.find(id);
-
-    if (article == m_computedData.end()) {
-        throw std::exception("There are no such article");
-    }
-
-    return article->second;
-}
-
-void ComputedDataModel::toggleSubjectAppearance(Article::Id id)
-{
-    if (m_data.appearance[id].size() == 1) {
-        std::set<Subject::Id> subjectsSet;
-        for (const auto& subject : m_data.subjects) {
-            subjectsSet.insert(subject.id);
-        }
-        m_data.appearance[id] = std::move(subjectsSet);
-    } else {
-        m_data.appearance[id].clear();
-        m_data.appearance[id].insert(m_data.subjects.front().id);
-    }
-
-    auto data = computeData(id);
-
-    m_C_nu = recomputeC_nu(m_C_nu.value(), m_computedData[id].c, data.c, m_computedData.size());
-
-    m_computedData[id] = std::move(data);
-}
-
-std::optional<float> ComputedDataModel::getC_nu() const noexcept
-{
-    return m_C_nu;
-}
-
-void ComputedDataModel::sort()
-{
-    class AppearanceOrder {
-    public:
-        AppearanceOrder(const std::set<Subject::Id>& appearance,
-                        const std::vector<Subject>& subjects, float score)
-        {
-            m_score = score;
-
-            m_apperance.resize(subjects.size());
-
-            for (auto i = 0u; i < subjects.size(); ++i) {
-                m_apperance[i] = appearance.count(subjects[i].id);
-            }
+        for (const auto& cell : rowSensitivity) {
+            res = std::max(res, std::abs(cell.h));
         }
 
-        std::strong_ordering operator<=>(const AppearanceOrder& e) const {
-            if (m_score != e.m_score) {
-                return m_score < e.m_score ? std::strong_ordering::less : std::strong_ordering::greater;
-            }
-
-            for (auto i = 0u; i < m_apperance.size(); ++i) {
-                if (m_apperance[i] != e.m_apperance[i]) {
-                    return !m_apperance[i] ? std::strong_ordering::less : std::strong_ordering::greater;
-                }
-            }
-
-            return std::strong_ordering::equal;
-        }
-
-    private:
-        std::vector<bool> m_apperance;
-        float m_score;
-    };
-
-    std::vector<std::pair<Article, AppearanceOrder>> articlesWithC;
-
-    articlesWithC.reserve(m_data.articles.size());
-
-    for (const auto& articleId : m_data.articles) {
-        articlesWithC.push_back({articleId, AppearanceOrder(m_data.appearance.at(articleId.id), m_data.subjects, m_computedData.at(articleId.id).h)});
+        return res;
     }
-
-    std::ranges::sort(articlesWithC, std::greater{}, [](const auto& t) { return t.second; });
-
-    for (auto i = 0u; i < articlesWithC.size(); i++) {
-        m_data.articles[i] = std::move(articlesWithC[i].first);
-    }
-}
-
-VerifiedData ComputedDataModel::getData() const noexcept
-{
-    return ts::VerifiedData::unverifiedFromRawData(ts::Data(m_data));
-}
-
-ComputedDataModel::ComputedDataModel(Data&& data, std::map<Article::Id, algorithm::ComputedData>&& computedData, std::optional<float> C_nu, Article::Id lastArticleId, Subject::Id lastSubjectId)
-    : m_data(std::move(data)), m_computedData(std::move(computedData)), m_C_nu(C_nu), m_lastArticleId(lastArticleId), m_lastSubjectId(lastSubjectId)
-{
-
-}
-
-std::optional<float> ComputedDataModel::computeC_nu(const std::map<Article::Id, algorithm::ComputedData>& computedData)
-{
-    if (computedData.empty()) {
-        return std::nullopt;
-    }
-
-    float c_sum = 0;
-
-    for (const auto& [_, data] : computedData) {
-        c_sum += data.c;
-    }
-
-    return c_sum / computedData.size();
-}
-
-float ComputedDataModel::recomputeC_nu(float C_nu, float oldC, float newC, int size)
-{
-    return C_nu - (oldC - newC) / size;
-}
-
-algorithm::ComputedData ComputedDataModel::computeData(Article::Id articleId) const
-{
-    return algorithm::computeOuterLinks(m_data.subjects, m_data.firstAppearance, m_data.appearance, articleId);
 }
 
 DataModel::DataModel(ts::ComputedDataModel&& dataModel) : m_dataModel(std::move(dataModel))
@@ -335,38 +48,43 @@ int DataModel::rowCount(const QModelIndex &parent) const
 
 int DataModel::columnCount(const QModelIndex &parent) const
 {
-    return static_cast<int>(m_dataModel.getSubjects().size() + 4);
+    return static_cast<int>(m_dataModel.getSubjects().size() + subjectsStart + reservedColumns + m_dataModel.getMetrics().size());
 }
 
 QVariant DataModel::data(const QModelIndex &index, int role) const
 {
+    TS_PROFILE_COUNT("DataModel::data");
+
     const auto& article = m_dataModel.getArticles()[index.row()];
 
     if (role == Qt::ItemDataRole::DisplayRole) {
         if (index.column() == 0) {
-            return QString::fromStdString(article.name);
+            return article.name.toQString();
         }
 
         const auto getComputedData = [&]() {
             return m_dataModel.getComputedDataForArticle(article.id);
         };
 
-        const auto colCount = columnCount(QModelIndex());
+        const auto scoresStart = getSubjectsColumnIndexEnd();
 
-        if (index.column() == colCount - 3) {
+        if (index.column() == scoresStart) {
             return QString::number(getComputedData().l, 'f', 2);
         }
-        if (index.column() == colCount - 2) {
+        if (index.column() == scoresStart + 1) {
             return QString::number(getComputedData().c, 'f', 2);
         }
-        if (index.column() == colCount - 1) {
+        if (index.column() == scoresStart + 2) {
             return QString::number(getComputedData().h, 'f', 2);
         }
+        if (index.column() >= scoresStart + reservedColumns) {
+            return QString::number(m_dataModel.getMetricValue(article.id, index.column() - scoresStart - reservedColumns), 'f', 2);
+        }
     }
 
     if (role == Qt::ItemDataRole::EditRole) {
         if (index.column() == 0) {
-            return QString::fromStdString(article.name);
+            return article.name.toQString();
         }
     }
 
@@ -377,11 +95,41 @@ QVariant DataModel::data(const QModelIndex &index, int role) const
             return m_dataModel.isArticleAppearedAt(article.id, subject.id) ? QString::fromWCharArray(L"🔴") : QVariant();
         }
         if (role == Qt::BackgroundRole) {
-            return m_dataModel.isArticleFirstAppearedAt(article.id, subject.id) ? QBrush(QColor(Qt::gray)) : QVariant();
+            if (m_dataModel.isArticleFirstAppearedAt(article.id, subject.id)) {
+                return QBrush(QColor(Qt::gray));
+            }
+
+            if (m_sensitivity && m_sensitivityScale > 0) {
+                const auto& cell = (*m_sensitivity)[index.row()][subjectIndex.value()];
+
+                if (!cell.allowed || cell.h == 0) {
+                    return QVariant();
+                }
+
+                auto color = QColor(cell.h > 0 ? Qt::green : Qt::red);
+                color.setAlpha(int(std::min(1.f, std::abs(cell.h) / m_sensitivityScale) * 160));
+
+                return QBrush(color);
+            }
+
+            return QVariant();
         }
         if (role == Qt::TextAlignmentRole) {
             return Qt::AlignCenter;
         }
+        if (role == sensitivityRole || role == C_nuSensitivityRole) {
+            if (!m_sensitivity) {
+                return QVariant();
+            }
+
+            const auto& cell = (*m_sensitivity)[index.row()][subjectIndex.value()];
+
+            if (!cell.allowed) {
+                return QVariant();
+            }
+
+            return role == sensitivityRole ? cell.h : cell.c / rowCount(QModelIndex());
+        }
     }
 
     return QVariant();
@@ -389,26 +137,51 @@ QVariant DataModel::data(const QModelIndex &index, int role) const
 
 QVariant DataModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
+    TS_PROFILE_COUNT("DataModel::headerData");
+
     if (role == Qt::ItemDataRole::DisplayRole && orientation == Qt::Orientation::Horizontal) {
         if (section == 0) {
             return "Article Name";
         }
 
-        const auto colCount = columnCount(QModelIndex());
+        const auto scoresStart = getSubjectsColumnIndexEnd();
 
-        if (section == colCount - 3) {
+        if (section == scoresStart) {
             return "L";
         }
-        if (section == colCount - 2) {
+        if (section == scoresStart + 1) {
             return "C";
         }
-        if (section == colCount - 1) {
+        if (section == scoresStart + 2) {
             return "h";
         }
+        if (section >= scoresStart + reservedColumns) {
+            return QString::fromStdString(m_dataModel.getMetrics().at(section - scoresStart - reservedColumns).name);
+        }
 
         const auto& subject = m_dataModel.getSubjects().at(section - subjectsStart);
 
-        return QString::fromStdString(subject.name) + "\n" + QString::number(section);
+        return subject.name.toQString() + "\n" + QString::number(section);
+    }
+
+    if ((role == subjectLoadRole || role == Qt::ItemDataRole::ToolTipRole) && orientation == Qt::Orientation::Horizontal) {
+        const auto subjectIndex = getSubjectIndex(section);
+
+        if (!subjectIndex) {
+            return QVariant();
+        }
+
+        const auto load = m_dataModel.getSubjectLoad(m_dataModel.getSubjects().at(subjectIndex.value()).id);
+
+        if (role == Qt::ItemDataRole::ToolTipRole) {
+            return tr("Dots: %1\nFirst appearances: %2\nMean h of first appearances: %3").arg(qulonglong(load.dots)).arg(qulonglong(load.firstAppearances)).arg(load.meanH(), 0, 'f', 3);
+        }
+
+        return QVariantMap {
+            { "dots", qulonglong(load.dots) },
+            { "firstAppearances", qulonglong(load.firstAppearances) },
+            { "meanH", load.meanH() }
+        };
     }
 
     if (role == Qt::ItemDataRole::DisplayRole && orientation == Qt::Orientation::Vertical) {
@@ -432,6 +205,7 @@ bool DataModel::setData(const QModelIndex &index, const QVariant &value, int rol
     if (role == Qt::EditRole) {
         if (index.column() == 0) {
             m_dataModel.renameArticle(index.row(), value.toString().toStdString());
+            articleRenamed(m_dataModel.getArticles().at(index.row()));
 
             emit dataChanged(index, index, QList<int> {role});
 
@@ -451,6 +225,8 @@ bool DataModel::setData(const QModelIndex &index, const QVariant &value, int rol
                 return false;
             }
 
+            updateSensitivity(index.row());
+
             emit dataChanged(index, index);
             emit dataChanged(createIndex(index.row(), getSubjectsColumnIndexEnd() - 1), createIndex(index.row(), columnCount(QModelIndex()) - 1));
 
@@ -462,6 +238,8 @@ bool DataModel::setData(const QModelIndex &index, const QVariant &value, int rol
         if (role == Qt::EditRole && value.toBool()) {
             m_dataModel.setFirstAppearance(subject.id, article.id);
 
+            updateSensitivity(index.row());
+
             emit dataChanged(createIndex(index.row(), subjectsStart), createIndex(index.row(), columnCount(QModelIndex()) - 1));
 
             emit C_nu_changed(m_dataModel.getC_nu());
@@ -493,6 +271,7 @@ void DataModel::addSubject(std::string&& name)
     const auto subjectsEndColumnIndex = getSubjectsColumnIndexEnd();
     beginInsertColumns(QModelIndex(), subjectsEndColumnIndex, subjectsEndColumnIndex);
     m_dataModel.addSubject(std::move(name));
+    updateSensitivity();
     endInsertColumns();
 
     emit C_nu_changed(m_dataModel.getC_nu());
@@ -500,8 +279,36 @@ void DataModel::addSubject(std::string&& name)
 
 void DataModel::addArticle(std::string&& name)
 {
-    beginInsertRows(QModelIndex(), rowCount(QModelIndex()), rowCount(QModelIndex()));
-    m_dataModel.addArticle(std::move(name));
+    const auto names = std::array { std::string_view(name) };
+
+    addArticles(names);
+}
+
+void DataModel::addArticles(std::span<const std::string_view> names)
+{
+    TS_PROFILE_SCOPE("DataModel::addArticles");
+
+    if (names.empty()) {
+        return;
+    }
+
+    const auto first = rowCount(QModelIndex());
+
+    beginInsertRows(QModelIndex(), first, first + int(names.size()) - 1);
+    m_dataModel.addArticles(names);
+    m_articlesRevision++;
+    if (m_searchIndex) {
+        for (auto row = first; row < rowCount(QModelIndex()); row++) {
+            const auto& article = m_dataModel.getArticles()[row];
+            m_searchIndex->add(article.id, article.name.view());
+        }
+    }
+    if (m_sensitivity) {
+        m_sensitivity->resize(m_dataModel.getArticles().size());
+        for (auto row = first; row < rowCount(QModelIndex()); row++) {
+            updateSensitivity(row);
+        }
+    }
     endInsertRows();
 
     emit C_nu_changed(m_dataModel.getC_nu());
@@ -511,6 +318,8 @@ void DataModel::sort()
 {
     m_dataModel.sort();
 
+    updateSensitivity();
+
     emit dataChanged(createIndex(0, 0), createIndex(rowCount(QModelIndex()) - 1, columnCount(QModelIndex()) - 1));
 }
 
@@ -522,6 +331,8 @@ void DataModel::toggleWholeRow(const QModelIndex &index)
 
     m_dataModel.toggleSubjectAppearance(m_dataModel.getArticles()[index.row()].id);
 
+    updateSensitivity(index.row());
+
     emit dataChanged(createIndex(index.row(), 0), createIndex(index.row(), columnCount(QModelIndex()) - 1));
     emit C_nu_changed(m_dataModel.getC_nu());
 }
@@ -549,11 +360,28 @@ void DataModel::setSubjects(std::vector<ts::Subject> &&subjects)
 {
     m_dataModel.setSubjects(std::move(subjects));
 
+    updateSensitivity();
+
     emit dataChanged(createIndex(0, 0), createIndex(rowCount(QModelIndex()) - 1, columnCount(QModelIndex()) - 1));
     emit headerDataChanged(Qt::Horizontal, 0, columnCount(QModelIndex()) - 1);
     emit C_nu_changed(m_dataModel.getC_nu());
 }
 
+const ts::ScoringPolicy& DataModel::getScoringPolicy() const
+{
+    return m_dataModel.getScoringPolicy();
+}
+
+void DataModel::setScoringPolicy(const ts::ScoringPolicy& policy)
+{
+    m_dataModel.setScoringPolicy(policy);
+
+    updateSensitivity();
+
+    emit dataChanged(createIndex(0, 0), createIndex(rowCount(QModelIndex()) - 1, columnCount(QModelIndex()) - 1));
+    emit C_nu_changed(m_dataModel.getC_nu());
+}
+
 void DataModel::toggleAppearance(const QModelIndex &index)
 {
     const auto& article = m_dataModel.getArticles().at(index.row());
@@ -569,19 +397,276 @@ void DataModel::toggleAppearance(const QModelIndex &index)
 
 void DataModel::removeArticle(int row)
 {
-    beginRemoveRows(QModelIndex(), row, row);
-    m_dataModel.removeArticle(m_dataModel.getArticles().at(row).id);
-    endRemoveRows();
+    removeArticles({ row });
+}
+
+void DataModel::removeArticles(std::vector<int> rows)
+{
+    TS_PROFILE_SCOPE("DataModel::removeArticles");
+
+    std::ranges::sort(rows, std::greater{});
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    if (rows.empty()) {
+        return;
+    }
+
+    // descending [first, last] ranges, so removing one doesn't shift the rows of the next
+    std::vector<std::pair<int, int>> ranges;
+
+    for (const auto row : rows) {
+        if (!ranges.empty() && ranges.back().first == row + 1) {
+            ranges.back().first = row;
+        } else {
+            ranges.emplace_back(row, row);
+        }
+    }
+
+    const auto articleIdsOf = [&](int first, int last) {
+        std::vector<ts::Article::Id> res;
+        res.reserve(std::size_t(last - first + 1));
+
+        for (auto row = first; row <= last; row++) {
+            res.push_back(m_dataModel.getArticles().at(row).id);
+        }
+
+        return res;
+    };
+
+    const auto forgetRows = [&](int first, int last, const std::vector<ts::Article::Id>& articleIds) {
+        if (m_searchIndex) {
+            for (const auto articleId : articleIds) {
+                m_searchIndex->remove(articleId);
+            }
+        }
+        if (m_sensitivity) {
+            const auto begin = m_sensitivity->begin() + first;
+            const auto end = m_sensitivity->begin() + last + 1;
+            const auto heldScale = std::any_of(begin, end, [this](const auto& rowSensitivity) { return maxSensitivityOf(rowSensitivity) >= m_sensitivityScale; });
+
+            m_sensitivity->erase(begin, end);
+
+            if (heldScale) {
+                updateSensitivityScale();
+            }
+        }
+    };
+
+    m_articlesRevision++;
+
+    std::vector<std::vector<ts::Article::Id>> rangeIds;
+    std::vector<ts::Article::Id> articleIds;
+    rangeIds.reserve(ranges.size());
+    articleIds.reserve(rows.size());
+
+    for (const auto& [first, last] : ranges) {
+        rangeIds.push_back(articleIdsOf(first, last));
+        articleIds.insert(articleIds.end(), rangeIds.back().begin(), rangeIds.back().end());
+    }
+
+    // the articles are removed in one pass, so only a single range can be announced to
+    // the views as removed rows, a scattered selection resets them
+    if (ranges.size() == 1) {
+        beginRemoveRows(QModelIndex(), ranges.front().first, ranges.front().second);
+    } else {
+        beginResetModel();
+    }
+
+    m_dataModel.removeArticles(articleIds);
+
+    for (std::size_t i = 0; i < ranges.size(); i++) {
+        forgetRows(ranges[i].first, ranges[i].second, rangeIds[i]);
+    }
+
+    if (ranges.size() == 1) {
+        endRemoveRows();
+    } else {
+        endResetModel();
+    }
 
     emit C_nu_changed(m_dataModel.getC_nu());
 }
 
 int DataModel::getSubjectsColumnIndexEnd() const
 {
-    return columnCount(QModelIndex()) - reservedColumns;
+    return subjectsStart + static_cast<int>(m_dataModel.getSubjects().size());
 }
 
 std::optional<float> DataModel::getC_nu() const
 {
     return m_dataModel.getC_nu();
 }
+
+void DataModel::setSensitivityOverlay(bool enabled)
+{
+    if (enabled == m_sensitivity.has_value()) {
+        return;
+    }
+
+    if (enabled) {
+        m_sensitivity.emplace();
+        updateSensitivity();
+    } else {
+        m_sensitivity.reset();
+    }
+
+    if (rowCount(QModelIndex()) > 0) {
+        emit dataChanged(createIndex(0, subjectsStart), createIndex(rowCount(QModelIndex()) - 1, getSubjectsColumnIndexEnd() - 1));
+    }
+}
+
+bool DataModel::isSensitivityOverlayEnabled() const
+{
+    return m_sensitivity.has_value();
+}
+
+void DataModel::buildSearchIndex()
+{
+    TS_PROFILE_SCOPE("DataModel::buildSearchIndex");
+
+    std::vector<std::pair<ts::Article::Id, std::string>> names;
+    names.reserve(m_dataModel.getArticles().size());
+
+    for (const auto& article : m_dataModel.getArticles()) {
+        names.emplace_back(article.id, article.name.toStdString());
+    }
+
+    const auto revision = m_articlesRevision;
+
+    auto watcher = new QFutureWatcher<std::shared_ptr<ts::ArticleIndex>>(this);
+
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, revision]() {
+        watcher->deleteLater();
+
+        // articles were edited while the index was built from the old ones
+        if (revision != m_articlesRevision) {
+            buildSearchIndex();
+            return;
+        }
+
+        m_searchIndex = watcher->result();
+
+        emit searchIndexReady();
+    });
+
+    watcher->setFuture(QtConcurrent::run([names = std::move(names)]() {
+        TS_PROFILE_SCOPE("ArticleIndex::build");
+
+        auto index = std::make_shared<ts::ArticleIndex>();
+
+        for (const auto& [id, name] : names) {
+            index->add(id, name);
+        }
+
+        return index;
+    }));
+}
+
+std::optional<std::vector<ts::Article::Id>> DataModel::searchArticles(const QString& query) const
+{
+    TS_PROFILE_SCOPE("DataModel::searchArticles");
+
+    if (!m_searchIndex) {
+        return std::nullopt;
+    }
+
+    return m_searchIndex->search(query);
+}
+
+tl::expected<std::vector<ts::Article::Id>, std::string> DataModel::queryArticles(const QString& query) const
+{
+    TS_PROFILE_SCOPE("DataModel::queryArticles");
+
+    return m_dataModel.queryArticles(query.toStdString());
+}
+
+std::optional<int> DataModel::getArticleRow(ts::Article::Id articleId) const
+{
+    const auto& articles = m_dataModel.getArticles();
+    const auto iter = std::ranges::find(articles, articleId, &ts::Article::id);
+
+    if (iter == articles.end()) {
+        return std::nullopt;
+    }
+
+    return int(std::distance(articles.begin(), iter));
+}
+
+void DataModel::articleRenamed(const ts::Article& article)
+{
+    m_articlesRevision++;
+
+    if (m_searchIndex) {
+        m_searchIndex->rename(article.id, article.name.view());
+    }
+}
+
+void DataModel::setJournal(ts::EditJournal* journal)
+{
+    m_dataModel.setJournal(journal);
+}
+
+std::vector<ts::diagnostics::MemoryUsage> DataModel::memoryUsage() const
+{
+    auto res = m_dataModel.memoryUsage();
+
+    if (m_sensitivity) {
+        ts::diagnostics::MemoryUsage sensitivity { .component = "sensitivityOverlay" };
+        ts::diagnostics::addVector(sensitivity, *m_sensitivity);
+        for (const auto& row : *m_sensitivity) {
+            ts::diagnostics::addVector(sensitivity, row);
+        }
+
+        res.push_back(std::move(sensitivity));
+    }
+
+    return res;
+}
+
+void DataModel::updateSensitivity()
+{
+    if (!m_sensitivity) {
+        return;
+    }
+
+    const auto& articles = m_dataModel.getArticles();
+
+    m_sensitivity->resize(articles.size());
+
+    ts::parallel::forEachIndex(articles.size(), [&](std::size_t row) {
+        (*m_sensitivity)[row] = m_dataModel.computeSensitivity(articles[row].id);
+    });
+
+    updateSensitivityScale();
+}
+
+void DataModel::updateSensitivity(int row)
+{
+    if (!m_sensitivity) {
+        return;
+    }
+
+    auto& rowSensitivity = m_sensitivity->at(row);
+
+    const auto oldMax = maxSensitivityOf(rowSensitivity);
+
+    rowSensitivity = m_dataModel.computeSensitivity(m_dataModel.getArticles().at(row).id);
+
+    const auto newMax = maxSensitivityOf(rowSensitivity);
+
+    if (newMax >= m_sensitivityScale) {
+        m_sensitivityScale = newMax;
+    } else if (oldMax >= m_sensitivityScale) {
+        // the row held the largest value, it may be gone
+        updateSensitivityScale();
+    }
+}
+
+void DataModel::updateSensitivityScale()
+{
+    m_sensitivityScale = 0;
+
+    for (const auto& rowSensitivity : *m_sensitivity) {
+        m_sensitivityScale = std::max(m_sensitivityScale, maxSensitivityOf(rowSensitivity));
+    }
+}
@@ -2,60 +2,11 @@
 #define DATAMODEL_H
 
 #include <QAbstractItemModel>
-#include <Data.h>
-#include <algorithm.h>
+#include <computeddatamodel.h>
+#include <articleindex.h>
 
 #include <ranges>
 
-namespace ts {
-    class ComputedDataModel {
-    public:
-        static ComputedDataModel compute(VerifiedData&& data);
-
-        void setAppearance(Subject::Id, Article::Id, bool appearance);
-        void setFirstAppearance(Subject::Id, Article::Id);
-
-        Subject::Id addSubject(std::string&& name);
-        Article::Id addArticle(std::string&& article);
-
-        void renameArticle(int index, std::string&& name);
-        void renameSubject(int index, std::string&& name);
-
-        const std::vector<Subject>& getSubjects() const noexcept;
-        const std::vector<Article>& getArticles() const noexcept;
-
-        void setSubjects(std::vector<Subject>&& subjects);
-        void removeArticle(Article::Id articleId);
-
-        bool isArticleAppearedAt(Article::Id, Subject::Id) const;
-        bool isArticleFirstAppearedAt(Article::Id, Subject::Id) const;
-
-        const algorithm::ComputedData& getComputedDataForArticle(Article::Id id) const;
-
-        void toggleSubjectAppearance(Article::Id);
-
-        std::optional<float> getC_nu() const noexcept;
-
-        void sort();
-
-        VerifiedData getData() const noexcept;
-    private:
-        ComputedDataModel(Data&& data, std::map<Article::Id, algorithm::ComputedData>&& computedData, std::optional<float> C_nu, Article::Id lastArticleId, Subject::Id lastSubjectId);
-
-        static std::optional<float> computeC_nu(const std::map<Article::Id, algorithm::ComputedData>& computedData);
-        static float recomputeC_nu(float C_nu, float oldC, float newC, int size);
-
-        algorithm::ComputedData computeData(Article::Id articleId) const;
-
-        Data m_data;
-
-        std::map<Article::Id, algorithm::ComputedData> m_computedData;
-        std::optional<float> m_C_nu;
-        unsigned m_lastArticleId = 0;
-        unsigned m_lastSubjectId = 0;
-    };
-}
-
 class DataModel : public QAbstractItemModel
 {
     Q_OBJECT
@@ -76,6 +27,8 @@ public:
 
     void addSubject(std::string&& name);
     void addArticle(std::string&& name);
+    // inserted as one range at the end
+    void addArticles(std::span<const std::string_view> names);
 
     void sort();
 
@@ -89,20 +42,61 @@ public:
 
     void setSubjects(std::vector<ts::Subject>&& subjects);
 
+    const ts::ScoringPolicy& getScoringPolicy() const;
+    void setScoringPolicy(const ts::ScoringPolicy& policy);
+
     void toggleAppearance(const QModelIndex &index);
 
     void removeArticle(int row);
+    // rows in any order, contiguous ones are removed as one range
+    void removeArticles(std::vector<int> rows);
 
     static constexpr auto subjectsStart = 1;
+    // L, C and h, they are followed by one column per metric
     static constexpr auto reservedColumns = 3;
 
+    static constexpr auto sensitivityRole = Qt::UserRole + 1;
+    static constexpr auto C_nuSensitivityRole = Qt::UserRole + 2;
+    // QVariantMap of the dots, firstAppearances and meanH of a subject column
+    static constexpr auto subjectLoadRole = Qt::UserRole + 3;
+
     int getSubjectsColumnIndexEnd() const;
     std::optional<float> getC_nu() const;
 
+    void setSensitivityOverlay(bool enabled);
+    bool isSensitivityOverlayEnabled() const;
+
+    std::vector<ts::diagnostics::MemoryUsage> memoryUsage() const;
+
+    void setJournal(ts::EditJournal* journal);
+
+    // Builds the article search index on the global thread pool, searchIndexReady
+    // is emitted once it can be queried. Afterwards it follows article edits
+    void buildSearchIndex();
+    // std::nullopt while the index is being built
+    std::optional<std::vector<ts::Article::Id>> searchArticles(const QString& query) const;
+    std::optional<int> getArticleRow(ts::Article::Id articleId) const;
+
+    // evaluates an appearance query over the whole document, see ts::AppearanceQuery
+    tl::expected<std::vector<ts::Article::Id>, std::string> queryArticles(const QString& query) const;
+
 signals:
     void C_nu_changed(std::optional<float>);
+    void searchIndexReady();
 private:
+    void updateSensitivity();
+    void updateSensitivity(int row);
+    void updateSensitivityScale();
+    void articleRenamed(const ts::Article& article);
+
     ts::ComputedDataModel m_dataModel;
+
+    std::optional<std::vector<std::vector<ts::algorithm::CellSensitivity>>> m_sensitivity;
+    float m_sensitivityScale = 0;
+
+    std::shared_ptr<ts::ArticleIndex> m_searchIndex;
+    // bumped on every article edit, an index built from older articles is rebuilt
+    unsigned m_articlesRevision = 0;
 };
 
 #endif // DATAMODEL_H
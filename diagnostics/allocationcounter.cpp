@@ -0,0 +1,62 @@
+#include "allocationcounter.h"
+
+#include <cstdlib>
+#include <new>
+
+#ifdef TS_ENABLE_PROFILING
+
+namespace {
+    thread_local std::uint64_t t_allocations = 0;
+    thread_local std::uint64_t t_bytes = 0;
+
+    void* allocate(std::size_t size) noexcept
+    {
+        t_allocations++;
+        t_bytes += size;
+
+        return std::malloc(size ? size : 1);
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    if (auto ptr = allocate(size)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+ts::diagnostics::AllocationCount ts::diagnostics::threadAllocations() noexcept
+{
+    return AllocationCount { .allocations = t_allocations, .bytes = t_bytes };
+}
+
+#else
+
+ts::diagnostics::AllocationCount ts::diagnostics::threadAllocations() noexcept
+{
+    return AllocationCount {};
+}
+
+#endif
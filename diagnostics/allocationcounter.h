@@ -0,0 +1,17 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+
+namespace ts::diagnostics {
+    struct AllocationCount {
+        std::uint64_t allocations = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    // Heap allocations made through operator new by the calling thread so far.
+    // Always zero when TS_ENABLE_PROFILING is off.
+    AllocationCount threadAllocations() noexcept;
+}
+
+#endif // ALLOCATIONCOUNTER_H
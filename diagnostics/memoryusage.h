@@ -0,0 +1,50 @@
+#ifndef MEMORYUSAGE_H
+#define MEMORYUSAGE_H
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ts::diagnostics {
+    struct MemoryUsage {
+        std::string component;
+        std::size_t bytes = 0;
+        std::size_t allocations = 0;
+    };
+
+    // Node-based containers are estimated from the usual red-black tree node
+    // layout: three links, a color field and the value, rounded to the malloc alignment
+    template<typename T>
+    constexpr std::size_t treeNodeSize() noexcept
+    {
+        constexpr auto alignment = alignof(std::max_align_t);
+        return (4 * sizeof(void*) + sizeof(T) + alignment - 1) / alignment * alignment;
+    }
+
+    template<typename T>
+    void addVector(MemoryUsage& usage, const std::vector<T>& value) noexcept
+    {
+        if (value.capacity()) {
+            usage.bytes += value.capacity() * sizeof(T);
+            usage.allocations++;
+        }
+    }
+
+    template<typename T, typename Compare, typename Allocator>
+    void addSet(MemoryUsage& usage, const std::set<T, Compare, Allocator>& value) noexcept
+    {
+        usage.bytes += value.size() * treeNodeSize<T>();
+        usage.allocations += value.size();
+    }
+
+    template<typename K, typename V, typename Compare, typename Allocator>
+    void addMap(MemoryUsage& usage, const std::map<K, V, Compare, Allocator>& value) noexcept
+    {
+        usage.bytes += value.size() * treeNodeSize<std::pair<const K, V>>();
+        usage.allocations += value.size();
+    }
+}
+
+#endif // MEMORYUSAGE_H
@@ -0,0 +1,171 @@
+#include "profiler.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <bit>
+
+using namespace ts::diagnostics;
+
+namespace {
+    std::uint64_t percentile(const std::array<std::uint64_t, Histogram::bucketsCount>& buckets, std::uint64_t count, double p)
+    {
+        if (count == 0) {
+            return 0;
+        }
+
+        const auto rank = std::uint64_t(p * double(count - 1)) + 1;
+        auto seen = std::uint64_t(0);
+
+        for (auto i = 0; i < Histogram::bucketsCount; i++) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                // upper bound of the bucket
+                return i == 0 ? 0 : (std::uint64_t(1) << i) - 1;
+            }
+        }
+
+        return std::uint64_t(1) << (Histogram::bucketsCount - 1);
+    }
+}
+
+void Histogram::record(std::uint64_t nanoseconds) noexcept
+{
+    const auto bucket = std::min(int(std::bit_width(nanoseconds)), bucketsCount - 1);
+
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_total.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    auto max = m_max.load(std::memory_order_relaxed);
+    while (max < nanoseconds && !m_max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {}
+}
+
+void Histogram::reset() noexcept
+{
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_total.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+std::uint64_t Histogram::count() const noexcept
+{
+    return m_count.load(std::memory_order_relaxed);
+}
+
+std::uint64_t Histogram::totalNanoseconds() const noexcept
+{
+    return m_total.load(std::memory_order_relaxed);
+}
+
+std::uint64_t Histogram::maxNanoseconds() const noexcept
+{
+    return m_max.load(std::memory_order_relaxed);
+}
+
+std::array<std::uint64_t, Histogram::bucketsCount> Histogram::buckets() const noexcept
+{
+    std::array<std::uint64_t, bucketsCount> res;
+
+    for (auto i = 0; i < bucketsCount; i++) {
+        res[i] = m_buckets[i].load(std::memory_order_relaxed);
+    }
+
+    return res;
+}
+
+Registry& Registry::instance()
+{
+    static Registry registry;
+    return registry;
+}
+
+Operation& Registry::operation(const char* name)
+{
+    std::lock_guard lock(m_mutex);
+
+    for (auto& operation : m_operations) {
+        if (operation.name == name) {
+            return operation;
+        }
+    }
+
+    auto& operation = m_operations.emplace_back();
+    operation.name = name;
+
+    return operation;
+}
+
+std::vector<OperationStats> Registry::snapshot() const
+{
+    std::lock_guard lock(m_mutex);
+
+    std::vector<OperationStats> res;
+    res.reserve(m_operations.size());
+
+    for (const auto& operation : m_operations) {
+        OperationStats stats;
+
+        stats.name = operation.name;
+        stats.calls = operation.calls.load(std::memory_order_relaxed);
+        stats.allocations = operation.allocations.load(std::memory_order_relaxed);
+        stats.allocatedBytes = operation.allocatedBytes.load(std::memory_order_relaxed);
+        stats.buckets = operation.latency.buckets();
+        stats.timed = operation.latency.count();
+        stats.totalNanoseconds = operation.latency.totalNanoseconds();
+        stats.maxNanoseconds = operation.latency.maxNanoseconds();
+        stats.p50Nanoseconds = percentile(stats.buckets, stats.timed, 0.5);
+        stats.p90Nanoseconds = percentile(stats.buckets, stats.timed, 0.9);
+        stats.p99Nanoseconds = percentile(stats.buckets, stats.timed, 0.99);
+
+        res.push_back(std::move(stats));
+    }
+
+    return res;
+}
+
+QByteArray Registry::toJson() const
+{
+    QJsonArray operationsJson;
+
+    for (const auto& stats : snapshot()) {
+        QJsonArray bucketsJson;
+        for (const auto bucket : stats.buckets) {
+            bucketsJson.append(double(bucket));
+        }
+
+        operationsJson.append(QJsonObject{
+                                  { "name", QString::fromStdString(stats.name) },
+                                  { "calls", double(stats.calls) },
+                                  { "timed", double(stats.timed) },
+                                  { "totalNs", double(stats.totalNanoseconds) },
+                                  { "maxNs", double(stats.maxNanoseconds) },
+                                  { "p50Ns", double(stats.p50Nanoseconds) },
+                                  { "p90Ns", double(stats.p90Nanoseconds) },
+                                  { "p99Ns", double(stats.p99Nanoseconds) },
+                                  { "allocations", double(stats.allocations) },
+                                  { "allocatedBytes", double(stats.allocatedBytes) },
+                                  { "log2Buckets", std::move(bucketsJson) }
+                              });
+    }
+
+    return QJsonDocument(QJsonObject{
+                             { "operations", std::move(operationsJson) }
+                         }).toJson();
+}
+
+void Registry::reset()
+{
+    std::lock_guard lock(m_mutex);
+
+    for (auto& operation : m_operations) {
+        operation.calls.store(0, std::memory_order_relaxed);
+        operation.allocations.store(0, std::memory_order_relaxed);
+        operation.allocatedBytes.store(0, std::memory_order_relaxed);
+        operation.latency.reset();
+    }
+}
@@ -0,0 +1,134 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "tracer.h"
+#include "allocationcounter.h"
+
+#include <QByteArray>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ts::diagnostics {
+    class Histogram {
+    public:
+        // bucket i holds durations in [2^(i-1), 2^i) nanoseconds
+        static constexpr auto bucketsCount = 48;
+
+        void record(std::uint64_t nanoseconds) noexcept;
+        void reset() noexcept;
+
+        std::uint64_t count() const noexcept;
+        std::uint64_t totalNanoseconds() const noexcept;
+        std::uint64_t maxNanoseconds() const noexcept;
+        std::array<std::uint64_t, bucketsCount> buckets() const noexcept;
+
+    private:
+        std::array<std::atomic<std::uint64_t>, bucketsCount> m_buckets {};
+        std::atomic<std::uint64_t> m_count = 0;
+        std::atomic<std::uint64_t> m_total = 0;
+        std::atomic<std::uint64_t> m_max = 0;
+    };
+
+    struct Operation {
+        std::string name;
+        Histogram latency;
+        std::atomic<std::uint64_t> calls = 0;
+        // allocations made by the thread that runs the timed section
+        std::atomic<std::uint64_t> allocations = 0;
+        std::atomic<std::uint64_t> allocatedBytes = 0;
+    };
+
+    struct OperationStats {
+        std::string name;
+        std::uint64_t calls = 0;
+        std::uint64_t timed = 0;
+        std::uint64_t totalNanoseconds = 0;
+        std::uint64_t maxNanoseconds = 0;
+        std::uint64_t p50Nanoseconds = 0;
+        std::uint64_t p90Nanoseconds = 0;
+        std::uint64_t p99Nanoseconds = 0;
+        std::uint64_t allocations = 0;
+        std::uint64_t allocatedBytes = 0;
+        std::array<std::uint64_t, Histogram::bucketsCount> buckets {};
+    };
+
+    class Registry {
+    public:
+        static Registry& instance();
+
+        // Operations are never removed, so the returned reference can be cached
+        Operation& operation(const char* name);
+
+        std::vector<OperationStats> snapshot() const;
+        QByteArray toJson() const;
+        void reset();
+
+    private:
+        Registry() = default;
+
+        mutable std::mutex m_mutex;
+        std::deque<Operation> m_operations;
+    };
+
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Operation& operation) noexcept
+            : m_operation(operation), m_start(std::chrono::steady_clock::now()), m_isTraced(Tracer::isEnabled()), m_allocationsAtStart(threadAllocations())
+        {
+            if (m_isTraced) {
+                Tracer::instance().record(m_operation.name.c_str(), 'B', m_start);
+            }
+        }
+
+        ~ScopedTimer()
+        {
+            const auto end = std::chrono::steady_clock::now();
+
+            if (m_isTraced) {
+                Tracer::instance().record(m_operation.name.c_str(), 'E', end);
+            }
+
+            const auto allocations = threadAllocations();
+            m_operation.allocations.fetch_add(allocations.allocations - m_allocationsAtStart.allocations, std::memory_order_relaxed);
+            m_operation.allocatedBytes.fetch_add(allocations.bytes - m_allocationsAtStart.bytes, std::memory_order_relaxed);
+
+            m_operation.calls.fetch_add(1, std::memory_order_relaxed);
+            m_operation.latency.record(std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_start).count()));
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Operation& m_operation;
+        std::chrono::steady_clock::time_point m_start;
+        bool m_isTraced;
+        AllocationCount m_allocationsAtStart;
+    };
+}
+
+#define TS_PROFILE_CONCAT_IMPL(a, b) a##b
+#define TS_PROFILE_CONCAT(a, b) TS_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef TS_ENABLE_PROFILING
+#define TS_PROFILE_SCOPE(name) \
+    static auto& TS_PROFILE_CONCAT(tsProfileOperation, __LINE__) = ::ts::diagnostics::Registry::instance().operation(name); \
+    const ::ts::diagnostics::ScopedTimer TS_PROFILE_CONCAT(tsProfileTimer, __LINE__)(TS_PROFILE_CONCAT(tsProfileOperation, __LINE__))
+#define TS_PROFILE_COUNT(name) \
+    do { \
+        static auto& tsProfileOperation = ::ts::diagnostics::Registry::instance().operation(name); \
+        tsProfileOperation.calls.fetch_add(1, std::memory_order_relaxed); \
+    } while (false)
+#else
+#define TS_PROFILE_SCOPE(name) static_cast<void>(0)
+#define TS_PROFILE_COUNT(name) static_cast<void>(0)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,241 @@
+#include "tracer.h"
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+#include <algorithm>
+#include <new>
+#include <thread>
+
+using namespace ts::diagnostics;
+
+namespace {
+    std::int64_t toNanoseconds(std::chrono::steady_clock::time_point time) noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+}
+
+ThreadTraceBuffer::ThreadTraceBuffer(int threadId, bool isMainThread)
+    : m_events(std::make_unique<TraceEvent[]>(capacity)), m_threadId(threadId), m_isMainThread(isMainThread)
+{
+
+}
+
+void ThreadTraceBuffer::push(const TraceEvent& event) noexcept
+{
+    const auto written = m_written.load(std::memory_order_relaxed);
+
+    m_events[written % capacity] = event;
+
+    m_written.store(written + 1, std::memory_order_release);
+}
+
+std::vector<TraceEvent> ThreadTraceBuffer::events() const
+{
+    const auto written = m_written.load(std::memory_order_acquire);
+    const auto count = std::min<std::uint64_t>(written, capacity);
+
+    std::vector<TraceEvent> res;
+    res.reserve(count);
+
+    for (auto i = written - count; i < written; i++) {
+        res.push_back(m_events[i % capacity]);
+    }
+
+    return res;
+}
+
+void ThreadTraceBuffer::clear() noexcept
+{
+    m_written.store(0, std::memory_order_release);
+}
+
+void ThreadTraceBuffer::beginWrite() noexcept
+{
+    m_writing.store(true);
+}
+
+void ThreadTraceBuffer::endWrite() noexcept
+{
+    m_writing.store(false, std::memory_order_release);
+}
+
+bool ThreadTraceBuffer::isWriting() const noexcept
+{
+    return m_writing.load();
+}
+
+int ThreadTraceBuffer::threadId() const noexcept
+{
+    return m_threadId;
+}
+
+bool ThreadTraceBuffer::isMainThread() const noexcept
+{
+    return m_isMainThread;
+}
+
+Tracer& Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+void Tracer::start()
+{
+    pauseWriters();
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        freeReleasedBuffers();
+
+        for (auto& buffer : m_buffers) {
+            buffer->clear();
+        }
+
+        m_collecting = true;
+    }
+
+    m_start.store(toNanoseconds(std::chrono::steady_clock::now()), std::memory_order_relaxed);
+    s_enabled.store(true, std::memory_order_release);
+}
+
+QByteArray Tracer::stop()
+{
+    pauseWriters();
+
+    const auto pid = QCoreApplication::applicationPid();
+
+    QJsonArray eventsJson;
+
+    std::lock_guard lock(m_mutex);
+
+    for (const auto& buffer : m_buffers) {
+        eventsJson.append(QJsonObject{
+                              { "name", "thread_name" },
+                              { "ph", "M" },
+                              { "pid", pid },
+                              { "tid", buffer->threadId() },
+                              { "args", QJsonObject{ { "name", buffer->isMainThread() ? QString("main") : "worker " + QString::number(buffer->threadId()) } } }
+                          });
+
+        for (const auto& event : buffer->events()) {
+            eventsJson.append(QJsonObject{
+                                  { "name", event.name },
+                                  { "ph", QString(QChar(event.phase)) },
+                                  { "ts", double(event.timestamp) / 1000. },
+                                  { "pid", pid },
+                                  { "tid", buffer->threadId() }
+                              });
+        }
+    }
+
+    m_collecting = false;
+    freeReleasedBuffers();
+
+    return QJsonDocument(QJsonObject{
+                             { "traceEvents", std::move(eventsJson) },
+                             { "displayTimeUnit", "ms" }
+                         }).toJson(QJsonDocument::Compact);
+}
+
+void Tracer::record(const char* name, char phase, std::chrono::steady_clock::time_point time) noexcept
+{
+    // registered before the buffer is marked as written, pauseWriters waits holding the mutex
+    const auto buffer = threadBuffer();
+
+    if (!buffer) {
+        return;
+    }
+
+    // Both the flag and s_enabled are sequentially consistent, so either this thread sees
+    // recording stopped or pauseWriters sees the flag and waits for the push
+    buffer->beginWrite();
+
+    // recording may have been stopped since the caller checked
+    if (s_enabled.load()) {
+        buffer->push(TraceEvent {
+                         .name = name,
+                         .timestamp = toNanoseconds(time) - m_start.load(std::memory_order_relaxed),
+                         .phase = phase
+                     });
+    }
+
+    buffer->endWrite();
+}
+
+ThreadTraceBuffer* Tracer::threadBuffer() noexcept
+{
+    // hands the buffer back when the thread exits, so pool threads that come and go
+    // don't leave a buffer each behind
+    struct Owner {
+        ThreadTraceBuffer* buffer = nullptr;
+
+        ~Owner()
+        {
+            if (buffer) {
+                Tracer::instance().release(buffer);
+            }
+        }
+    };
+
+    thread_local Owner owner;
+
+    if (!owner.buffer) {
+        try {
+            std::lock_guard lock(m_mutex);
+
+            const auto isMainThread = QCoreApplication::instance() && QThread::currentThread() == QCoreApplication::instance()->thread();
+
+            m_buffers.push_back(std::make_unique<ThreadTraceBuffer>(m_nextThreadId++, isMainThread));
+            owner.buffer = m_buffers.back().get();
+        } catch (const std::exception&) {
+            return nullptr;
+        }
+    }
+
+    return owner.buffer;
+}
+
+void Tracer::release(ThreadTraceBuffer* buffer) noexcept
+{
+    std::lock_guard lock(m_mutex);
+
+    // out of a trace its events have been returned already or are about to be cleared
+    if (m_collecting) {
+        try {
+            m_releasedBuffers.push_back(buffer);
+            return;
+        } catch (const std::exception&) {
+            // the events of the thread are lost with its buffer
+        }
+    }
+
+    std::erase_if(m_buffers, [&](const auto& owned) { return owned.get() == buffer; });
+}
+
+void Tracer::freeReleasedBuffers() noexcept
+{
+    std::erase_if(m_buffers, [&](const auto& owned) { return std::ranges::find(m_releasedBuffers, owned.get()) != m_releasedBuffers.end(); });
+
+    m_releasedBuffers.clear();
+}
+
+void Tracer::pauseWriters() noexcept
+{
+    s_enabled.store(false);
+
+    // a thread that registers its buffer after this sees recording stopped
+    std::lock_guard lock(m_mutex);
+
+    for (const auto& buffer : m_buffers) {
+        while (buffer->isWriting()) {
+            std::this_thread::yield();
+        }
+    }
+}
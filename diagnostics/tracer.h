@@ -0,0 +1,93 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QByteArray>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ts::diagnostics {
+    struct TraceEvent {
+        const char* name = nullptr;
+        std::int64_t timestamp = 0; // nanoseconds since the trace start
+        char phase = 'B';
+    };
+
+    // Written only by its owner thread; once full, the oldest events are overwritten
+    class ThreadTraceBuffer {
+    public:
+        static constexpr std::size_t capacity = 1 << 16;
+
+        ThreadTraceBuffer(int threadId, bool isMainThread);
+
+        void push(const TraceEvent& event) noexcept;
+        std::vector<TraceEvent> events() const;
+        void clear() noexcept;
+
+        // set by the owner thread while it records an event, start and stop wait for it
+        void beginWrite() noexcept;
+        void endWrite() noexcept;
+        bool isWriting() const noexcept;
+
+        int threadId() const noexcept;
+        bool isMainThread() const noexcept;
+
+    private:
+        std::unique_ptr<TraceEvent[]> m_events;
+        std::atomic<std::uint64_t> m_written = 0;
+        // on a line of its own, so writers never contend over it
+        alignas(64) std::atomic<bool> m_writing = false;
+        int m_threadId;
+        bool m_isMainThread;
+    };
+
+    // Chrome trace_event recorder for the TS_PROFILE_SCOPE sections. start and stop wait
+    // for the threads in the middle of recording an event, so buffers are never cleared
+    // or read while they are written
+    class Tracer {
+    public:
+        static Tracer& instance();
+
+        static bool isEnabled() noexcept
+        {
+            return s_enabled.load(std::memory_order_relaxed);
+        }
+
+        void start();
+        // Stops recording and returns the events as Chrome trace_event JSON
+        QByteArray stop();
+
+        void record(const char* name, char phase, std::chrono::steady_clock::time_point time) noexcept;
+
+    private:
+        Tracer() = default;
+
+        // nullptr when the buffer of a new thread can't be allocated, its events are dropped
+        ThreadTraceBuffer* threadBuffer() noexcept;
+        // called as the owner thread of the buffer exits. The buffer is freed at once
+        // unless it holds events of the trace being recorded, then stop frees it
+        void release(ThreadTraceBuffer* buffer) noexcept;
+        // m_mutex is held
+        void freeReleasedBuffers() noexcept;
+        // disables recording and waits for the events being recorded
+        void pauseWriters() noexcept;
+
+        static inline std::atomic<bool> s_enabled = false;
+
+        std::atomic<std::int64_t> m_start = 0;
+
+        std::mutex m_mutex;
+        std::vector<std::unique_ptr<ThreadTraceBuffer>> m_buffers;
+        // from start to the end of stop, buffers of threads that exit meanwhile are kept
+        // for the events they hold
+        bool m_collecting = false;
+        std::vector<const ThreadTraceBuffer*> m_releasedBuffers;
+        int m_nextThreadId = 0;
+    };
+}
+
+#endif // TRACER_H
@@ -1,6 +1,95 @@
 #include "addnewsubjectdialog.h"
 #include "ui_addnewsubjectdialog.h"
 
+#include <QChar>
+#include <QFile>
+#include <QFileDialog>
+#include <QMessageBox>
+
+#include <algorithm>
+
+namespace {
+    constexpr char32_t replacementCharacter = 0xFFFD;
+
+    struct CodePoint {
+        char32_t value;
+        std::size_t size;
+    };
+
+    // the code point of the UTF-8 sequence at text, a broken one is read as its first byte
+    // standing for the replacement character
+    CodePoint codePointAt(const char* text, std::size_t available) noexcept
+    {
+        const auto lead = static_cast<unsigned char>(text[0]);
+
+        const auto size = lead < 0x80 ? 1 : lead >> 5 == 0x6 ? 2 : lead >> 4 == 0xE ? 3 : lead >> 3 == 0x1E ? 4 : 0;
+
+        if (size == 0 || std::size_t(size) > available) {
+            return CodePoint { .value = replacementCharacter, .size = 1 };
+        }
+
+        auto value = size == 1 ? char32_t(lead) : char32_t(lead & (0x7F >> size));
+
+        for (auto i = 1; i < size; i++) {
+            const auto next = static_cast<unsigned char>(text[i]);
+
+            if (next >> 6 != 0x2) {
+                return CodePoint { .value = replacementCharacter, .size = 1 };
+            }
+
+            value = value << 6 | (next & 0x3F);
+        }
+
+        return CodePoint { .value = value, .size = std::size_t(size) };
+    }
+}
+
+NameList::NameList(QByteArray&& text) : m_text(std::move(text))
+{
+    // what QString::simplified does to a line, written over the line itself. Spaces are
+    // told by QChar::isSpace, so no-break and other Unicode spaces collapse as well
+    auto* data = m_text.data();
+    const auto size = std::size_t(m_text.size());
+
+    auto read = std::size_t(0);
+
+    while (read < size) {
+        const auto begin = read;
+        auto write = begin;
+        auto pendingSpace = false;
+
+        while (read < size && data[read] != '\n') {
+            const auto codePoint = codePointAt(data + read, size - read);
+
+            if (QChar::isSpace(codePoint.value)) {
+                pendingSpace = write != begin;
+                read += codePoint.size;
+                continue;
+            }
+
+            if (pendingSpace) {
+                data[write++] = ' ';
+                pendingSpace = false;
+            }
+
+            for (auto i = std::size_t(0); i < codePoint.size; i++) {
+                data[write++] = data[read++];
+            }
+        }
+
+        read++;
+
+        if (write != begin) {
+            m_names.emplace_back(data + begin, write - begin);
+        }
+    }
+}
+
+const std::vector<std::string_view>& NameList::names() const noexcept
+{
+    return m_names;
+}
+
 AddNewSubjectDialog::AddNewSubjectDialog(std::string&& entityName, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::AddNewSubjectDialog)
@@ -19,20 +108,47 @@ QStringList AddNewSubjectDialog::getSubjectNames() {
 
     QStringList res;
 
-    auto names = m_text.split("\n");
+    for (const auto name : getNames().names()) {
+        res.append(QString::fromUtf8(name.data(), qsizetype(name.size())));
+    }
 
-    for (auto& name : names) {
-        name = name.simplified();
+    return res;
+}
 
-        if (!name.isEmpty()) {
-            res.append(name);
-        }
+NameList AddNewSubjectDialog::getNames() const
+{
+    auto text = ui->plainTextEdit->toPlainText().toUtf8();
+
+    if (!m_fileText.isEmpty()) {
+        text.reserve(text.size() + 1 + m_fileText.size());
+        text.append('\n').append(m_fileText);
     }
 
-    return res;
+    return NameList(std::move(text));
 }
 
-void AddNewSubjectDialog::onTextChanged()
+void AddNewSubjectDialog::loadFile()
 {
-    m_text = ui->plainTextEdit->toPlainText();
+    const auto filePath = QFileDialog::getOpenFileName(this, "Load Names", QString(), "Text (*.txt *.csv);;All files (*)");
+
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        QMessageBox::critical(this, "Error", "Can't open file");
+        return;
+    }
+
+    const auto contents = file.readAll();
+
+    if (!m_fileText.isEmpty()) {
+        m_fileText.append('\n');
+    }
+    m_fileText.append(contents);
+    m_fileLinesCount += std::size_t(std::count(contents.begin(), contents.end(), '\n')) + (contents.endsWith('\n') ? 0 : 1);
+
+    ui->fileLabel->setText(QString("%1 lines from files").arg(m_fileLinesCount));
 }
@@ -3,10 +3,29 @@
 
 #include <QDialog>
 
+#include <string_view>
+#include <vector>
+
 namespace Ui {
 class AddNewSubjectDialog;
 }
 
+// Names given one per line. Lines are simplified in place in a single UTF-8 buffer
+// and the names point into it, so a long list is never split into separate strings
+class NameList {
+public:
+    explicit NameList(QByteArray&& text);
+
+    NameList(const NameList&) = delete;
+    NameList(NameList&&) noexcept = default;
+
+    const std::vector<std::string_view>& names() const noexcept;
+
+private:
+    QByteArray m_text;
+    std::vector<std::string_view> m_names;
+};
+
 class AddNewSubjectDialog : public QDialog
 {
     Q_OBJECT
@@ -16,14 +35,18 @@ public:
     ~AddNewSubjectDialog();
 
     QStringList getSubjectNames();
+    // the typed or pasted lines followed by the lines of the loaded files
+    NameList getNames() const;
 
 public slots:
-    void onTextChanged();
+    void loadFile();
 
 private:
     Ui::AddNewSubjectDialog *ui;
 
-    QString m_text;
+    // contents of the loaded files, they are not put into the editor
+    QByteArray m_fileText;
+    std::size_t m_fileLinesCount = 0;
 };
 
 #endif // ADDNEWSUBJECTDIALOG_H
@@ -0,0 +1,22 @@
+#include "comparisondialog.h"
+#include "ui_comparisondialog.h"
+
+ComparisonDialog::ComparisonDialog(std::vector<ComparisonDataModel::Document>&& documents, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::ComparisonDialog),
+    m_dataModel(std::make_unique<ComparisonDataModel>(std::move(documents), ComparisonDataModel::MatchBy::Id))
+{
+    ui->setupUi(this);
+
+    ui->tableView->setModel(m_dataModel.get());
+}
+
+ComparisonDialog::~ComparisonDialog()
+{
+    delete ui;
+}
+
+void ComparisonDialog::onMatchByChanged(int index)
+{
+    m_dataModel->setMatchBy(index == 0 ? ComparisonDataModel::MatchBy::Id : ComparisonDataModel::MatchBy::Name);
+}
@@ -0,0 +1,29 @@
+#ifndef COMPARISONDIALOG_H
+#define COMPARISONDIALOG_H
+
+#include <QDialog>
+
+#include "models/comparisondatamodel.h"
+
+namespace Ui {
+class ComparisonDialog;
+}
+
+class ComparisonDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ComparisonDialog(std::vector<ComparisonDataModel::Document>&& documents, QWidget *parent = nullptr);
+    ~ComparisonDialog();
+
+public slots:
+    void onMatchByChanged(int index);
+
+private:
+    Ui::ComparisonDialog *ui;
+
+    std::unique_ptr<ComparisonDataModel> m_dataModel;
+};
+
+#endif // COMPARISONDIALOG_H
@@ -0,0 +1,41 @@
+#include "scoringpolicydialog.h"
+#include "ui_scoringpolicydialog.h"
+
+ScoringPolicyDialog::ScoringPolicyDialog(const ts::ScoringPolicy& policy, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::ScoringPolicyDialog)
+{
+    ui->setupUi(this);
+
+    setScoringPolicy(policy);
+}
+
+ScoringPolicyDialog::~ScoringPolicyDialog()
+{
+    delete ui;
+}
+
+ts::ScoringPolicy ScoringPolicyDialog::getScoringPolicy() const
+{
+    return ts::ScoringPolicy {
+        .p_1 = ui->p_1SpinBox->value(),
+        .p_2 = ui->p_2SpinBox->value(),
+        .normalization = ui->normalizationComboBox->currentIndex() == 1 ? ts::Normalization::Span : ts::Normalization::Subjects,
+        .arithmetic = ui->exactCheckBox->isChecked() ? ts::Arithmetic::Exact : ts::Arithmetic::Float
+    };
+}
+
+void ScoringPolicyDialog::onButtonClicked(QAbstractButton* button)
+{
+    if (ui->buttonBox->buttonRole(button) == QDialogButtonBox::ResetRole) {
+        setScoringPolicy(ts::ScoringPolicy {});
+    }
+}
+
+void ScoringPolicyDialog::setScoringPolicy(const ts::ScoringPolicy& policy)
+{
+    ui->p_1SpinBox->setValue(policy.p_1);
+    ui->p_2SpinBox->setValue(policy.p_2);
+    ui->normalizationComboBox->setCurrentIndex(policy.normalization == ts::Normalization::Span ? 1 : 0);
+    ui->exactCheckBox->setChecked(policy.arithmetic == ts::Arithmetic::Exact);
+}
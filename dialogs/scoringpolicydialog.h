@@ -0,0 +1,32 @@
+#ifndef SCORINGPOLICYDIALOG_H
+#define SCORINGPOLICYDIALOG_H
+
+#include <QDialog>
+#include <scoringpolicy.h>
+
+class QAbstractButton;
+
+namespace Ui {
+class ScoringPolicyDialog;
+}
+
+class ScoringPolicyDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ScoringPolicyDialog(const ts::ScoringPolicy& policy, QWidget *parent = nullptr);
+    ~ScoringPolicyDialog();
+
+    ts::ScoringPolicy getScoringPolicy() const;
+
+public slots:
+    void onButtonClicked(QAbstractButton* button);
+
+private:
+    void setScoringPolicy(const ts::ScoringPolicy& policy);
+
+    Ui::ScoringPolicyDialog *ui;
+};
+
+#endif // SCORINGPOLICYDIALOG_H
@@ -0,0 +1,102 @@
+#include "subjectorderdialog.h"
+#include "ui_subjectorderdialog.h"
+
+#include <QMessageBox>
+
+#include <algorithm>
+
+SubjectOrderDialog::SubjectOrderDialog(const std::vector<ts::Subject>& subjects, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::SubjectOrderDialog),
+    m_subjects(subjects)
+{
+    ui->setupUi(this);
+
+    for (const auto& subject : m_subjects) {
+        const auto name = subject.name.toQString();
+
+        auto item = new QListWidgetItem(name, ui->lockedListWidget);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(Qt::Unchecked);
+
+        ui->beforeComboBox->addItem(name);
+        ui->afterComboBox->addItem(name);
+    }
+
+    if (m_subjects.size() > 1) {
+        ui->afterComboBox->setCurrentIndex(1);
+    }
+
+    onObjectiveChanged(ui->objectiveComboBox->currentIndex());
+}
+
+SubjectOrderDialog::~SubjectOrderDialog()
+{
+    delete ui;
+}
+
+ts::algorithm::SubjectOrderConstraints SubjectOrderDialog::getConstraints() const
+{
+    ts::algorithm::SubjectOrderConstraints res;
+
+    for (auto row = 0; row < ui->lockedListWidget->count(); row++) {
+        if (ui->lockedListWidget->item(row)->checkState() == Qt::Checked) {
+            res.locked.insert(m_subjects[row].id);
+        }
+    }
+
+    for (const auto& [before, after] : m_precedence) {
+        res.precedence.emplace_back(m_subjects[before].id, m_subjects[after].id);
+    }
+
+    return res;
+}
+
+ts::algorithm::SubjectOrderOptions SubjectOrderDialog::getOptions() const
+{
+    return ts::algorithm::SubjectOrderOptions {
+        .objective = ui->objectiveComboBox->currentIndex() == 1 ? ts::algorithm::SubjectOrderObjective::MinimizeHPercentile : ts::algorithm::SubjectOrderObjective::MaximizeC_nu,
+        .percentile = float(ui->percentileSpinBox->value()) / 100
+    };
+}
+
+void SubjectOrderDialog::onObjectiveChanged(int index)
+{
+    ui->percentileSpinBox->setEnabled(index == 1);
+}
+
+void SubjectOrderDialog::addPrecedence()
+{
+    const auto before = ui->beforeComboBox->currentIndex();
+    const auto after = ui->afterComboBox->currentIndex();
+
+    if (before < 0 || after < 0 || before == after) {
+        return;
+    }
+
+    // the optimizer starts from the current order, it has to satisfy every constraint
+    if (before > after) {
+        QMessageBox::warning(this, windowTitle(), tr("%1 already comes after %2").arg(ui->beforeComboBox->currentText(), ui->afterComboBox->currentText()));
+
+        return;
+    }
+
+    if (std::find(m_precedence.begin(), m_precedence.end(), std::pair(before, after)) != m_precedence.end()) {
+        return;
+    }
+
+    m_precedence.emplace_back(before, after);
+    ui->precedenceListWidget->addItem(tr("%1 before %2").arg(ui->beforeComboBox->currentText(), ui->afterComboBox->currentText()));
+}
+
+void SubjectOrderDialog::removePrecedence()
+{
+    const auto row = ui->precedenceListWidget->currentRow();
+
+    if (row < 0) {
+        return;
+    }
+
+    m_precedence.erase(m_precedence.begin() + row);
+    delete ui->precedenceListWidget->takeItem(row);
+}
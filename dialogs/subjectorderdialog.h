@@ -0,0 +1,35 @@
+#ifndef SUBJECTORDERDIALOG_H
+#define SUBJECTORDERDIALOG_H
+
+#include <QDialog>
+#include <subjectorder.h>
+
+namespace Ui {
+class SubjectOrderDialog;
+}
+
+class SubjectOrderDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit SubjectOrderDialog(const std::vector<ts::Subject>& subjects, QWidget *parent = nullptr);
+    ~SubjectOrderDialog();
+
+    ts::algorithm::SubjectOrderConstraints getConstraints() const;
+    ts::algorithm::SubjectOrderOptions getOptions() const;
+
+public slots:
+    void onObjectiveChanged(int index);
+    void addPrecedence();
+    void removePrecedence();
+
+private:
+    Ui::SubjectOrderDialog *ui;
+
+    std::vector<ts::Subject> m_subjects;
+    // indices into m_subjects, the first one must stay before the second one
+    std::vector<std::pair<int, int>> m_precedence;
+};
+
+#endif // SUBJECTORDERDIALOG_H
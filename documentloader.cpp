@@ -0,0 +1,73 @@
+#include "documentloader.h"
+#include "formats/jsonformat.h"
+#include "formats/chunkedformat.h"
+#include "parallel.h"
+
+#include <QFile>
+
+tl::expected<ts::ComputedDataModel, std::string> ts::loadDocument(const QString& filePath, IdMode ids)
+{
+    QFile openFile(filePath);
+
+    if (!openFile.open(QIODevice::ReadOnly)) {
+        return tl::unexpected<std::string>("Can't open file");
+    }
+
+    auto fileData = openFile.readAll();
+
+    if (fileData.isEmpty()) {
+        return tl::unexpected<std::string>("File is empty or unexpected error occured");
+    }
+
+    auto model = parseDocument(fileData, ids);
+
+    if (!model) {
+        return tl::unexpected("Can't open file, file corrupted: " + model.error());
+    }
+
+    // edits saved since the document was last rewritten
+    if (auto applied = EditJournal::applyCommitted(filePath, fileData, model.value()); !applied) {
+        return tl::unexpected("Can't open file, journal corrupted: " + applied.error());
+    }
+
+    return model;
+}
+
+tl::expected<ts::ComputedDataModel, std::string> ts::parseDocument(const QByteArray& contents, IdMode ids)
+{
+    auto data = ts::formats::ChunkedFormat::isContainer(contents) ? ts::formats::ChunkedFormat().importData(contents)
+                                                                   : ts::formats::JsonFormat().importData(contents);
+
+    if (!data) {
+        return tl::unexpected(data.error());
+    }
+
+    return ts::ComputedDataModel::compute(std::move(data).value(), std::make_unique<DocumentMemory>(), ids);
+}
+
+std::vector<ts::LoadedDocument> ts::loadDocuments(const QStringList& filePaths)
+{
+    std::vector<std::optional<tl::expected<ComputedDataModel, std::string>>> models(filePaths.size());
+
+    ts::parallel::forEachIndex(models.size(), [&](std::size_t i) {
+        models[i] = loadDocument(filePaths[int(i)]);
+    });
+
+    std::vector<LoadedDocument> res;
+    res.reserve(models.size());
+
+    for (auto i = 0u; i < models.size(); i++) {
+        res.push_back(LoadedDocument { .filePath = filePaths[int(i)], .model = std::move(models[i]).value() });
+    }
+
+    return res;
+}
+
+QByteArray ts::saveDocument(const ComputedDataModel& model, const QString& filePath, formats::JsonFormat::Version jsonVersion)
+{
+    if (filePath.endsWith(".tsz", Qt::CaseInsensitive)) {
+        return ts::formats::ChunkedFormat().exportData(model);
+    }
+
+    return ts::formats::JsonFormat(jsonVersion).exportData(model);
+}
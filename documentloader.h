@@ -0,0 +1,29 @@
+#ifndef DOCUMENTLOADER_H
+#define DOCUMENTLOADER_H
+
+#include "computeddatamodel.h"
+#include "formats/jsonformat.h"
+
+#include <QStringList>
+
+namespace ts {
+    struct LoadedDocument {
+        QString filePath;
+        tl::expected<ComputedDataModel, std::string> model;
+    };
+
+    // the document as it was last saved, with the committed records of its journal applied
+    tl::expected<ComputedDataModel, std::string> loadDocument(const QString& filePath, IdMode ids = IdMode::Original);
+    // contents of a JSON document or of a chunked container
+    tl::expected<ComputedDataModel, std::string> parseDocument(const QByteArray& contents, IdMode ids = IdMode::Original);
+
+    // Reads, parses and scores every file concurrently on the global thread pool
+    std::vector<LoadedDocument> loadDocuments(const QStringList& filePaths);
+
+    // Serializes the document in the format its file extension stands for:
+    // the chunked compressed container for .tsz, JSON of jsonVersion otherwise
+    QByteArray saveDocument(const ComputedDataModel& model, const QString& filePath,
+                            formats::JsonFormat::Version jsonVersion = formats::JsonFormat::Version::V1);
+}
+
+#endif // DOCUMENTLOADER_H
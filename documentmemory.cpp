@@ -0,0 +1,46 @@
+#include "documentmemory.h"
+
+using namespace ts;
+
+DocumentMemory::DocumentMemory() : m_pool(&m_upstream)
+{
+
+}
+
+std::pmr::memory_resource* DocumentMemory::resource() noexcept
+{
+    return &m_pool;
+}
+
+std::size_t DocumentMemory::reservedBytes() const noexcept
+{
+    return m_upstream.bytes;
+}
+
+std::size_t DocumentMemory::blocksCount() const noexcept
+{
+    return m_upstream.blocks;
+}
+
+void* DocumentMemory::CountingResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    auto res = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+
+    this->bytes += bytes;
+    blocks++;
+
+    return res;
+}
+
+void DocumentMemory::CountingResource::do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment)
+{
+    std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+
+    this->bytes -= bytes;
+    blocks--;
+}
+
+bool DocumentMemory::CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
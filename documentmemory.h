@@ -0,0 +1,56 @@
+#ifndef DOCUMENTMEMORY_H
+#define DOCUMENTMEMORY_H
+
+#include <memory>
+#include <memory_resource>
+
+namespace ts {
+    // Memory resource of a single document. Containers of the document take their
+    // nodes from a pool that requests large blocks upstream, and all the blocks are
+    // released at once when the document is destroyed. Not thread-safe
+    class DocumentMemory {
+    public:
+        DocumentMemory();
+        DocumentMemory(const DocumentMemory&) = delete;
+        DocumentMemory& operator=(const DocumentMemory&) = delete;
+
+        std::pmr::memory_resource* resource() noexcept;
+
+        std::size_t reservedBytes() const noexcept;
+        std::size_t blocksCount() const noexcept;
+
+        // Empties a container carved from this memory without destroying its elements
+        // one by one, they are released with the memory. Only for elements that own
+        // nothing outside of it, a container of another resource is left as it is
+        template<typename Container>
+        void abandon(Container& container) noexcept
+        {
+            const auto allocator = container.get_allocator();
+
+            if (allocator.resource() != resource()) {
+                return;
+            }
+
+            // the storage is reused without running the destructor, it would only
+            // hand the nodes back to the pool
+            std::construct_at(&container, allocator);
+        }
+
+    private:
+        class CountingResource : public std::pmr::memory_resource {
+        public:
+            std::size_t bytes = 0;
+            std::size_t blocks = 0;
+
+        private:
+            void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+            void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+        };
+
+        CountingResource m_upstream;
+        std::pmr::unsynchronized_pool_resource m_pool;
+    };
+}
+
+#endif // DOCUMENTMEMORY_H
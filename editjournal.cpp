@@ -0,0 +1,551 @@
+#include "editjournal.h"
+#include "computeddatamodel.h"
+#include "diagnostics/profiler.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+
+#include <algorithm>
+#include <set>
+
+using namespace ts;
+
+namespace {
+    constexpr char magic[] = { 'T', 'S', 'J', '1' };
+
+    template<typename... Args>
+    QByteArray payloadOf(const Args&... args)
+    {
+        QByteArray res;
+        QDataStream stream(&res, QIODevice::WriteOnly);
+
+        (stream << ... << args);
+
+        return res;
+    }
+
+    QByteArray utf8Of(std::string_view value)
+    {
+        return QByteArray(value.data(), qsizetype(value.size()));
+    }
+}
+
+QString EditJournal::journalPath(const QString& documentPath)
+{
+    return documentPath + ".journal";
+}
+
+tl::expected<std::unique_ptr<EditJournal>, std::string> EditJournal::create(const QString& documentPath, const QByteArray& snapshot)
+{
+    auto journal = std::unique_ptr<EditJournal>(new EditJournal(documentPath));
+
+    if (!journal->m_file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+        return tl::unexpected("Can't write journal " + journal->m_file.fileName().toStdString());
+    }
+
+    const auto header = headerOf(snapshot);
+
+    if (journal->m_file.write(header) != header.size() || !journal->m_file.flush()) {
+        return tl::unexpected("Can't write journal " + journal->m_file.fileName().toStdString());
+    }
+
+    journal->m_snapshotSize = snapshot.size();
+    journal->m_committedEnd = header.size();
+
+    return journal;
+}
+
+tl::expected<std::unique_ptr<EditJournal>, std::string> EditJournal::open(const QString& documentPath)
+{
+    TS_PROFILE_SCOPE("EditJournal::open");
+
+    QFile document(documentPath);
+
+    if (!document.open(QIODevice::ReadOnly)) {
+        return tl::unexpected<std::string>("Can't open file");
+    }
+
+    const auto snapshot = document.readAll();
+
+    if (!QFile::exists(journalPath(documentPath))) {
+        return create(documentPath, snapshot);
+    }
+
+    auto journal = std::unique_ptr<EditJournal>(new EditJournal(documentPath));
+
+    if (!journal->m_file.open(QIODevice::ReadWrite)) {
+        return tl::unexpected("Can't open journal " + journal->m_file.fileName().toStdString());
+    }
+
+    const auto contents = journal->m_file.readAll();
+    const auto header = headerOf(snapshot);
+
+    if (!contents.startsWith(header)) {
+        journal.reset();
+
+        return create(documentPath, snapshot);
+    }
+
+    auto read = readRecords(contents, header.size());
+
+    if (read.validEnd < contents.size()) {
+        journal->m_file.resize(read.validEnd);
+    }
+
+    // loadDocument has applied the committed records already
+    read.records.erase(read.records.begin(), read.records.begin() + qsizetype(read.committedCount));
+
+    journal->m_snapshotSize = snapshot.size();
+    journal->m_committedEnd = read.committedEnd;
+    journal->m_records = std::move(read.records);
+
+    return journal;
+}
+
+std::unique_ptr<EditJournal> EditJournal::inMemory()
+{
+    auto journal = std::unique_ptr<EditJournal>(new EditJournal());
+    journal->m_inMemory = true;
+
+    return journal;
+}
+
+tl::expected<void, std::string> EditJournal::applyCommitted(const QString& documentPath, const QByteArray& snapshot, ComputedDataModel& model)
+{
+    TS_PROFILE_SCOPE("EditJournal::applyCommitted");
+
+    QFile file(journalPath(documentPath));
+
+    if (!file.exists()) {
+        return {};
+    }
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return tl::unexpected("Can't open journal " + file.fileName().toStdString());
+    }
+
+    const auto contents = file.readAll();
+    const auto header = headerOf(snapshot);
+
+    if (!contents.startsWith(header)) {
+        return {};
+    }
+
+    const auto read = readRecords(contents, header.size());
+
+    for (auto i = 0u; i < read.committedCount; i++) {
+        if (auto applied = apply(model, read.records[i]); !applied) {
+            return tl::unexpected("Can't apply journal record " + std::to_string(i) + ": " + applied.error());
+        }
+    }
+
+    return {};
+}
+
+std::size_t EditJournal::uncommittedCount() const noexcept
+{
+    return m_records.size();
+}
+
+tl::expected<void, std::string> EditJournal::recover(ComputedDataModel& model)
+{
+    TS_PROFILE_SCOPE("EditJournal::recover");
+
+    for (auto i = 0u; i < m_records.size(); i++) {
+        if (auto applied = apply(model, m_records[i]); !applied) {
+            return tl::unexpected("Can't recover journal record " + std::to_string(i) + ": " + applied.error());
+        }
+    }
+
+    m_records.clear();
+
+    return {};
+}
+
+void EditJournal::discardUncommitted()
+{
+    m_records.clear();
+
+    if (!m_inMemory && m_file.size() > m_committedEnd && !m_file.resize(m_committedEnd)) {
+        m_failed = true;
+    }
+}
+
+bool EditJournal::commit()
+{
+    if (m_failed || !append(Kind::Commit, {})) {
+        return false;
+    }
+
+    m_committedEnd = m_file.size();
+
+    return true;
+}
+
+bool EditJournal::needsCompaction() const noexcept
+{
+    return m_file.size() > std::max(m_snapshotSize / compactionFraction, minCompactionSize);
+}
+
+tl::expected<std::size_t, std::string> EditJournal::applyRecords(ComputedDataModel& model, const QByteArray& records)
+{
+    TS_PROFILE_SCOPE("EditJournal::applyRecords");
+
+    QDataStream stream(records);
+
+    std::size_t count = 0;
+
+    while (!stream.atEnd()) {
+        quint8 kind = 0;
+        QByteArray payload;
+
+        stream >> kind >> payload;
+
+        if (stream.status() != QDataStream::Ok || kind > quint8(Kind::Sort)) {
+            return tl::unexpected("Edit record " + std::to_string(count) + " is corrupted");
+        }
+
+        if (auto applied = apply(model, Record { .kind = Kind(kind), .payload = std::move(payload) }); !applied) {
+            return tl::unexpected("Can't apply edit record " + std::to_string(count) + ": " + applied.error());
+        }
+
+        count++;
+    }
+
+    return count;
+}
+
+const QByteArray& EditJournal::records() const noexcept
+{
+    return m_memoryRecords;
+}
+
+void EditJournal::setAppearance(Subject::Id subjectId, Article::Id articleId, bool appearance)
+{
+    append(Kind::SetAppearance, payloadOf(quint32(subjectId), quint32(articleId), appearance));
+}
+
+void EditJournal::setFirstAppearance(Subject::Id subjectId, Article::Id articleId)
+{
+    append(Kind::SetFirstAppearance, payloadOf(quint32(subjectId), quint32(articleId)));
+}
+
+void EditJournal::addSubject(std::string_view name)
+{
+    append(Kind::AddSubject, payloadOf(utf8Of(name)));
+}
+
+void EditJournal::addArticle(std::string_view name)
+{
+    append(Kind::AddArticle, payloadOf(utf8Of(name)));
+}
+
+void EditJournal::renameArticle(int index, std::string_view name)
+{
+    append(Kind::RenameArticle, payloadOf(qint32(index), utf8Of(name)));
+}
+
+void EditJournal::renameSubject(int index, std::string_view name)
+{
+    append(Kind::RenameSubject, payloadOf(qint32(index), utf8Of(name)));
+}
+
+void EditJournal::setSubjects(const std::vector<Subject>& subjects)
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+
+    stream << quint32(subjects.size());
+
+    for (const auto& subject : subjects) {
+        stream << quint32(subject.id) << utf8Of(subject.name.view());
+    }
+
+    append(Kind::SetSubjects, payload);
+}
+
+void EditJournal::removeArticle(Article::Id articleId)
+{
+    append(Kind::RemoveArticle, payloadOf(quint32(articleId)));
+}
+
+void EditJournal::setScoringPolicy(const ScoringPolicy& policy)
+{
+    append(Kind::SetScoringPolicy, payloadOf(qint32(policy.p_1), qint32(policy.p_2), quint8(policy.normalization), quint8(policy.arithmetic)));
+}
+
+void EditJournal::toggleSubjectAppearance(Article::Id articleId)
+{
+    append(Kind::ToggleSubjectAppearance, payloadOf(quint32(articleId)));
+}
+
+void EditJournal::sort()
+{
+    append(Kind::Sort, {});
+}
+
+EditJournal::EditJournal(const QString& documentPath) : m_file(journalPath(documentPath))
+{
+
+}
+
+QByteArray EditJournal::headerOf(const QByteArray& snapshot)
+{
+    return QByteArray(magic, sizeof(magic)) + QCryptographicHash::hash(snapshot, QCryptographicHash::Sha1);
+}
+
+EditJournal::ReadRecords EditJournal::readRecords(const QByteArray& contents, qint64 from)
+{
+    QDataStream stream(contents);
+    stream.skipRawData(int(from));
+
+    ReadRecords res { .committedEnd = from, .validEnd = from };
+
+    while (!stream.atEnd()) {
+        quint8 kind = 0;
+        QByteArray payload;
+
+        stream >> kind >> payload;
+
+        if (stream.status() != QDataStream::Ok || kind > quint8(Kind::Sort)) {
+            break;
+        }
+
+        res.validEnd = stream.device()->pos();
+
+        if (Kind(kind) == Kind::Commit) {
+            res.committedEnd = res.validEnd;
+            res.committedCount = res.records.size();
+            continue;
+        }
+
+        res.records.push_back(Record { .kind = Kind(kind), .payload = std::move(payload) });
+    }
+
+    return res;
+}
+
+bool EditJournal::append(Kind kind, const QByteArray& payload)
+{
+    QByteArray record;
+    QDataStream stream(&record, QIODevice::WriteOnly);
+
+    stream << quint8(kind) << payload;
+
+    if (m_inMemory) {
+        m_memoryRecords.append(record);
+        return true;
+    }
+
+    // a record that reached the journal is never lost with the application
+    if (!m_file.seek(m_file.size()) || m_file.write(record) != record.size() || !m_file.flush()) {
+        m_failed = true;
+    }
+
+    return !m_failed;
+}
+
+tl::expected<void, std::string> EditJournal::apply(ComputedDataModel& model, const Record& record)
+{
+    QDataStream stream(record.payload);
+
+    quint32 subjectId = 0;
+    quint32 articleId = 0;
+    qint32 index = 0;
+    QByteArray name;
+
+    const auto nameOf = [&]() {
+        return name.toStdString();
+    };
+
+    // every record is checked against the model before it touches it, so a record that
+    // can't be applied leaves the model as it was
+    const auto articleOf = [&](quint32 original) -> tl::expected<Article::Id, std::string> {
+        const auto id = model.articleIdOf(Article::Id(original));
+
+        if (!model.hasArticle(id)) {
+            return tl::unexpected("there is no article with id " + std::to_string(original));
+        }
+
+        return id;
+    };
+
+    const auto subjectOf = [&](quint32 original) -> tl::expected<Subject::Id, std::string> {
+        const auto id = model.subjectIdOf(Subject::Id(original));
+
+        if (!model.hasSubject(id)) {
+            return tl::unexpected("there is no subject with id " + std::to_string(original));
+        }
+
+        return id;
+    };
+
+    const auto checkIndex = [&](std::size_t size) -> tl::expected<void, std::string> {
+        if (index < 0 || std::size_t(index) >= size) {
+            return tl::unexpected("index " + std::to_string(index) + " is out of range");
+        }
+
+        return {};
+    };
+
+    const auto corrupted = tl::unexpected<std::string>("record is corrupted");
+
+    try {
+        switch (record.kind) {
+        case Kind::SetAppearance: {
+            bool appearance = false;
+            stream >> subjectId >> articleId >> appearance;
+            if (stream.status() != QDataStream::Ok) {
+                return corrupted;
+            }
+            const auto subject = subjectOf(subjectId);
+            const auto article = articleOf(articleId);
+            if (!subject || !article) {
+                return tl::unexpected(subject ? article.error() : subject.error());
+            }
+            model.setAppearance(subject.value(), article.value(), appearance);
+            break;
+        }
+        case Kind::SetFirstAppearance: {
+            stream >> subjectId >> articleId;
+            if (stream.status() != QDataStream::Ok) {
+                return corrupted;
+            }
+            const auto subject = subjectOf(subjectId);
+            const auto article = articleOf(articleId);
+            if (!subject || !article) {
+                return tl::unexpected(subject ? article.error() : subject.error());
+            }
+            model.setFirstAppearance(subject.value(), article.value());
+            break;
+        }
+        case Kind::AddSubject:
+            stream >> name;
+            if (stream.status() != QDataStream::Ok) {
+                return corrupted;
+            }
+            model.addSubject(nameOf());
+            break;
+        case Kind::AddArticle:
+            stream >> name;
+            if (stream.status() != QDataStream::Ok) {
+                return corrupted;
+            }
+            model.addArticle(nameOf());
+            break;
+        case Kind::RenameArticle:
+            stream >> index >> name;
+            if (stream.status() != QDataStream::Ok) {
+                return corrupted;
+            }
+            if (auto checked = checkIndex(model.getArticles().size()); !checked) {
+                return checked;
+            }
+            model.renameArticle(index, nameOf());
+            break;
+        case Kind::RenameSubject:
+            stream >> index >> name;
+            if (stream.status() != QDataStream::Ok) {
+                return corrupted;
+            }
+            if (auto checked = checkIndex(model.getSubjects().size()); !checked) {
+                return checked;
+            }
+            model.renameSubject(index, nameOf());
+            break;
+        case Kind::SetSubjects: {
+            quint32 count = 0;
+            stream >> count;
+
+            std::vector<std::pair<quint32, QByteArray>> read;
+            std::set<quint32> readIds;
+
+            for (auto i = 0u; i < count && stream.status() == QDataStream::Ok; i++) {
+                stream >> subjectId >> name;
+
+                if (!readIds.insert(subjectId).second) {
+                    return tl::unexpected("subject id " + std::to_string(subjectId) + " is duplicated");
+                }
+
+                read.emplace_back(subjectId, name);
+            }
+
+            if (stream.status() != QDataStream::Ok) {
+                return corrupted;
+            }
+            if (read.empty()) {
+                return tl::unexpected<std::string>("there must be at least one subject");
+            }
+
+            // ids of subjects added by the record are mapped only once the record is known to be whole.
+            // setSubjects moves the names into the document pool
+            StringPool strings;
+            std::vector<Subject> subjects;
+
+            for (const auto& [id, subjectName] : read) {
+                subjects.push_back(Subject { .id = model.addSubjectIdOf(Subject::Id(id)), .name = strings.intern(std::string_view(subjectName.constData(), std::size_t(subjectName.size()))) });
+            }
+
+            model.setSubjects(std::move(subjects));
+            break;
+        }
+        case Kind::RemoveArticle: {
+            stream >> articleId;
+            if (stream.status() != QDataStream::Ok) {
+                return corrupted;
+            }
+            const auto article = articleOf(articleId);
+            if (!article) {
+                return tl::unexpected(article.error());
+            }
+            model.removeArticle(article.value());
+            break;
+        }
+        case Kind::SetScoringPolicy: {
+            qint32 p_1 = 0;
+            qint32 p_2 = 0;
+            quint8 normalization = 0;
+            quint8 arithmetic = 0;
+            stream >> p_1 >> p_2 >> normalization;
+            // records written before exact arithmetic end here
+            if (!stream.atEnd()) {
+                stream >> arithmetic;
+            }
+            if (stream.status() != QDataStream::Ok) {
+                return corrupted;
+            }
+            if (!ScoringPolicy::isValidWeight(p_1) || !ScoringPolicy::isValidWeight(p_2)) {
+                return tl::unexpected("scoring weights must be from " + std::to_string(ScoringPolicy::minWeight) + " to " + std::to_string(ScoringPolicy::maxWeight));
+            }
+            if (normalization > quint8(Normalization::Span) || arithmetic > quint8(Arithmetic::Exact)) {
+                return tl::unexpected<std::string>("unknown normalization or arithmetic");
+            }
+            model.setScoringPolicy(ScoringPolicy { .p_1 = p_1, .p_2 = p_2, .normalization = Normalization(normalization), .arithmetic = Arithmetic(arithmetic) });
+            break;
+        }
+        case Kind::ToggleSubjectAppearance: {
+            stream >> articleId;
+            if (stream.status() != QDataStream::Ok) {
+                return corrupted;
+            }
+            const auto article = articleOf(articleId);
+            if (!article) {
+                return tl::unexpected(article.error());
+            }
+            model.toggleSubjectAppearance(article.value());
+            break;
+        }
+        case Kind::Sort:
+            model.sort();
+            break;
+        case Kind::Commit:
+            break;
+        }
+    } catch (const ThereMustBeAtLeastOneSubject&) {
+        return tl::unexpected<std::string>("an article must appear at one subject at least");
+    } catch (const std::exception& e) {
+        return tl::unexpected<std::string>(e.what());
+    }
+
+    return {};
+}
@@ -0,0 +1,131 @@
+#ifndef EDITJOURNAL_H
+#define EDITJOURNAL_H
+
+#include "Data.h"
+#include "libs/expected/include/tl/expected.hpp"
+
+#include <QByteArray>
+#include <QFile>
+
+#include <memory>
+#include <string_view>
+
+namespace ts {
+    class ComputedDataModel;
+
+    // Append-only log of the edits made since the document file was last rewritten, kept
+    // next to it. A save appends a commit record, which is all it writes while the journal is
+    // small, and rewrites the document and starts a new journal once it has grown. loadDocument
+    // applies the committed records, so every reader of the file sees the saved state. Records
+    // after the last commit are edits of a session that ended without saving. Each record is
+    // flushed as it is written, so it survives a crash of the application, though not of the
+    // system, nothing is fsynced.
+    // Ids are recorded as they are in the document file, not as a model with compact ids has them
+    class EditJournal {
+    public:
+        enum class Kind : quint8 {
+            Commit,
+            SetAppearance,
+            SetFirstAppearance,
+            AddSubject,
+            AddArticle,
+            RenameArticle,
+            RenameSubject,
+            SetSubjects,
+            RemoveArticle,
+            SetScoringPolicy,
+            ToggleSubjectAppearance,
+            Sort
+        };
+
+        static QString journalPath(const QString& documentPath);
+
+        // Starts an empty journal over the snapshot just written to the document
+        static tl::expected<std::unique_ptr<EditJournal>, std::string> create(const QString& documentPath, const QByteArray& snapshot);
+        // Reads the journal of the document. A journal written over another version of
+        // the document is dropped, and so is a torn record at the end left by a crash
+        static tl::expected<std::unique_ptr<EditJournal>, std::string> open(const QString& documentPath);
+        // A journal without a file, its records are kept for applyRecords, e.g. to check
+        // and apply an edit batch given in another form
+        static std::unique_ptr<EditJournal> inMemory();
+
+        // Applies the committed records of the journal of the document to a model parsed from
+        // snapshot, the contents of the document file. Only reads the journal, one written over
+        // another version of the document is ignored
+        static tl::expected<void, std::string> applyCommitted(const QString& documentPath, const QByteArray& snapshot, ComputedDataModel& model);
+
+        // Applies records laid out as in the journal file, without its header, e.g. an edit
+        // batch received from another process. Returns how many records were applied
+        static tl::expected<std::size_t, std::string> applyRecords(ComputedDataModel& model, const QByteArray& records);
+
+        // records read by open after the last commit
+        std::size_t uncommittedCount() const noexcept;
+        // Applies them to a model loaded with the committed ones, they stay uncommitted
+        tl::expected<void, std::string> recover(ComputedDataModel& model);
+        // Cuts them off the journal
+        void discardUncommitted();
+
+        // Saves every record so far, loaders apply them from now on. Fails if a record
+        // couldn't be written, the document has to be rewritten then
+        bool commit();
+        // the journal has grown enough for the next save to rewrite the document instead
+        bool needsCompaction() const noexcept;
+
+        // records of a journal in memory, laid out as applyRecords reads them
+        const QByteArray& records() const noexcept;
+
+        // records of ComputedDataModel mutations
+        void setAppearance(Subject::Id subjectId, Article::Id articleId, bool appearance);
+        void setFirstAppearance(Subject::Id subjectId, Article::Id articleId);
+        void addSubject(std::string_view name);
+        void addArticle(std::string_view name);
+        void renameArticle(int index, std::string_view name);
+        void renameSubject(int index, std::string_view name);
+        void setSubjects(const std::vector<Subject>& subjects);
+        void removeArticle(Article::Id articleId);
+        void setScoringPolicy(const ScoringPolicy& policy);
+        void toggleSubjectAppearance(Article::Id articleId);
+        void sort();
+
+    private:
+        struct Record {
+            Kind kind;
+            QByteArray payload;
+        };
+
+        struct ReadRecords {
+            std::vector<Record> records;
+            std::size_t committedCount = 0;
+            // ends of the last commit record and of the last whole record in the file
+            qint64 committedEnd = 0;
+            qint64 validEnd = 0;
+        };
+
+        EditJournal() = default;
+        explicit EditJournal(const QString& documentPath);
+
+        static QByteArray headerOf(const QByteArray& snapshot);
+        static ReadRecords readRecords(const QByteArray& contents, qint64 from);
+
+        bool append(Kind kind, const QByteArray& payload);
+        static tl::expected<void, std::string> apply(ComputedDataModel& model, const Record& record);
+
+        // the next save rewrites the document once the journal outgrows a quarter of it,
+        // or the minimum size for small documents
+        static constexpr qint64 compactionFraction = 4;
+        static constexpr qint64 minCompactionSize = 64 * 1024;
+
+        QFile m_file;
+        qint64 m_snapshotSize = 0;
+        qint64 m_committedEnd = 0;
+        // a record was lost, so the journal can't stand for the saved state any more
+        bool m_failed = false;
+        bool m_inMemory = false;
+        QByteArray m_memoryRecords;
+
+        // uncommitted records read by open
+        std::vector<Record> m_records;
+    };
+}
+
+#endif // EDITJOURNAL_H
@@ -0,0 +1,217 @@
+#include "chunkedformat.h"
+#include "jsonformat.h"
+#include "parallel.h"
+#include "diagnostics/profiler.h"
+
+#include <QDataStream>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+namespace {
+    constexpr char magic[] = { 'T', 'S', 'C', 'Z' };
+    constexpr quint32 containerVersion = 1;
+
+    constexpr qint64 headerSize = sizeof(magic) + 2 * sizeof(quint32);
+    constexpr qint64 indexEntrySize = 3 * sizeof(quint32) + sizeof(quint64);
+
+    // the fields of a JSON v2 document that are split into row chunks
+    constexpr const char* rowFields[] = { "articles", "firstAppearance", "appearance" };
+}
+
+ts::formats::ChunkedFormat::ChunkedFormat(int rowsPerChunk) : m_rowsPerChunk(std::max(1, rowsPerChunk))
+{
+
+}
+
+tl::expected<ts::VerifiedData, std::string> ts::formats::ChunkedFormat::importData(const QByteArray& data) const noexcept
+{
+    TS_PROFILE_SCOPE("ChunkedFormat::importData");
+
+    auto index = readIndex(data);
+
+    if (!index) {
+        return tl::unexpected(std::move(index).error());
+    }
+
+    const auto& chunks = index.value();
+
+    std::vector<tl::expected<QJsonObject, std::string>> decoded(chunks.size());
+
+    ts::parallel::forEachIndex(chunks.size(), [&](std::size_t i) {
+        decoded[i] = readChunk(data, chunks[i]);
+    });
+
+    for (auto i = 0u; i < decoded.size(); i++) {
+        if (!decoded[i]) {
+            return tl::unexpected("Error at chunk " + std::to_string(i) + ": " + decoded[i].error());
+        }
+    }
+
+    auto root = std::move(decoded.front()).value();
+
+    QJsonArray rows[std::size(rowFields)];
+
+    for (auto i = 1u; i < decoded.size(); i++) {
+        const auto& chunk = decoded[i].value();
+
+        if (chunks[i].firstRow != quint32(rows[0].size())) {
+            return tl::unexpected("chunk " + std::to_string(i) + " doesn't continue the previous one");
+        }
+
+        for (auto field = 0u; field < std::size(rowFields); field++) {
+            const auto values = chunk[rowFields[field]].toArray();
+
+            if (quint32(values.size()) != chunks[i].rowsCount) {
+                return tl::unexpected("chunk " + std::to_string(i) + " must have " + std::to_string(chunks[i].rowsCount) + " rows at '" + rowFields[field] + "' field");
+            }
+
+            for (const auto& value : values) {
+                rows[field].append(value);
+            }
+        }
+    }
+
+    for (auto field = 0u; field < std::size(rowFields); field++) {
+        root[rowFields[field]] = std::move(rows[field]);
+    }
+
+    return JsonFormat().importObject(std::move(root));
+}
+
+QByteArray ts::formats::ChunkedFormat::exportData(const ts::ComputedDataModel& data) const noexcept
+{
+    TS_PROFILE_SCOPE("ChunkedFormat::exportData");
+
+    auto header = JsonFormat(JsonFormat::Version::V2).exportObject(data);
+
+    QJsonArray rows[std::size(rowFields)];
+    for (auto field = 0u; field < std::size(rowFields); field++) {
+        rows[field] = header.take(rowFields[field]).toArray();
+    }
+
+    const auto rowsCount = quint32(rows[0].size());
+    const auto rowsPerChunk = quint32(m_rowsPerChunk);
+
+    std::vector<Chunk> chunks(1 + (rowsCount + rowsPerChunk - 1) / rowsPerChunk);
+    std::vector<QByteArray> payloads(chunks.size());
+
+    ts::parallel::forEachIndex(chunks.size(), [&](std::size_t i) {
+        if (i == 0) {
+            payloads[i] = qCompress(QJsonDocument(header).toJson(QJsonDocument::Compact));
+            return;
+        }
+
+        auto& chunk = chunks[i];
+        chunk.firstRow = quint32(i - 1) * rowsPerChunk;
+        chunk.rowsCount = std::min(rowsPerChunk, rowsCount - chunk.firstRow);
+
+        QJsonObject chunkJson;
+
+        for (auto field = 0u; field < std::size(rowFields); field++) {
+            QJsonArray values;
+
+            for (auto row = chunk.firstRow; row < chunk.firstRow + chunk.rowsCount; row++) {
+                values.append(rows[field].at(int(row)));
+            }
+
+            chunkJson[rowFields[field]] = std::move(values);
+        }
+
+        payloads[i] = qCompress(QJsonDocument(chunkJson).toJson(QJsonDocument::Compact));
+    });
+
+    QByteArray res;
+    QDataStream stream(&res, QIODevice::WriteOnly);
+
+    stream.writeRawData(magic, sizeof(magic));
+    stream << containerVersion << quint32(chunks.size());
+
+    auto offset = quint64(headerSize + indexEntrySize * qint64(chunks.size()));
+
+    for (auto i = 0u; i < chunks.size(); i++) {
+        chunks[i].offset = offset;
+        chunks[i].compressedSize = quint32(payloads[i].size());
+        offset += chunks[i].compressedSize;
+
+        stream << chunks[i].firstRow << chunks[i].rowsCount << chunks[i].offset << chunks[i].compressedSize;
+    }
+
+    for (const auto& payload : payloads) {
+        stream.writeRawData(payload.constData(), int(payload.size()));
+    }
+
+    return res;
+}
+
+bool ts::formats::ChunkedFormat::isContainer(const QByteArray& data) noexcept
+{
+    return data.startsWith(QByteArray::fromRawData(magic, sizeof(magic)));
+}
+
+tl::expected<std::vector<ts::formats::ChunkedFormat::Chunk>, std::string> ts::formats::ChunkedFormat::readIndex(const QByteArray& data) noexcept
+{
+    if (!isContainer(data)) {
+        return tl::unexpected<std::string>("not a chunked document");
+    }
+
+    QDataStream stream(data);
+    stream.skipRawData(sizeof(magic));
+
+    quint32 version = 0;
+    quint32 chunksCount = 0;
+    stream >> version >> chunksCount;
+
+    if (version != containerVersion) {
+        return tl::unexpected("unsupported container version " + std::to_string(version));
+    }
+
+    if (chunksCount == 0 || headerSize + indexEntrySize * qint64(chunksCount) > qint64(data.size())) {
+        return tl::unexpected<std::string>("chunk index is truncated");
+    }
+
+    std::vector<Chunk> res(chunksCount);
+
+    for (auto& chunk : res) {
+        stream >> chunk.firstRow >> chunk.rowsCount >> chunk.offset >> chunk.compressedSize;
+
+        if (chunk.offset > quint64(data.size()) || chunk.compressedSize > quint64(data.size()) - chunk.offset) {
+            return tl::unexpected<std::string>("chunk is out of the container bounds");
+        }
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        return tl::unexpected<std::string>("chunk index is corrupted");
+    }
+
+    if (res.front().rowsCount != 0) {
+        return tl::unexpected<std::string>("the first chunk must be the header");
+    }
+
+    return res;
+}
+
+tl::expected<QJsonObject, std::string> ts::formats::ChunkedFormat::readChunk(const QByteArray& data, const Chunk& chunk) noexcept
+{
+    if (chunk.offset > quint64(data.size()) || chunk.compressedSize > quint64(data.size()) - chunk.offset) {
+        return tl::unexpected<std::string>("chunk is out of the container bounds");
+    }
+
+    const auto json = qUncompress(reinterpret_cast<const uchar*>(data.constData() + chunk.offset), int(chunk.compressedSize));
+
+    if (json.isEmpty()) {
+        return tl::unexpected<std::string>("chunk can't be decompressed");
+    }
+
+    QJsonParseError error;
+    const auto document = QJsonDocument::fromJson(json, &error);
+
+    if (error.error != QJsonParseError::NoError) {
+        return tl::unexpected(error.errorString().toStdString());
+    }
+
+    if (!document.isObject()) {
+        return tl::unexpected<std::string>("chunk must have object type");
+    }
+
+    return document.object();
+}
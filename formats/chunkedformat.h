@@ -0,0 +1,41 @@
+#ifndef CHUNKEDFORMAT_H
+#define CHUNKEDFORMAT_H
+
+#include "dataformats.h"
+#include "computeddatamodel.h"
+
+#include <QJsonObject>
+
+namespace ts::formats {
+    // Container of independently zlib-compressed chunks with an index in front of them.
+    // The first chunk holds the subjects and the scoring policy of a JSON v2 document,
+    // every next one holds a contiguous range of its article rows. Chunks are compressed
+    // and decompressed in parallel, and a viewer can decode only the rows it needs
+    class ChunkedFormat : public DataExporter, public DataImporter
+    {
+    public:
+        struct Chunk {
+            quint32 firstRow = 0;
+            quint32 rowsCount = 0;
+            // from the beginning of the container
+            quint64 offset = 0;
+            quint32 compressedSize = 0;
+        };
+
+        explicit ChunkedFormat(int rowsPerChunk = 4096);
+
+        [[nodiscard]] tl::expected<ts::VerifiedData, std::string> importData(const QByteArray& data) const noexcept override;
+        [[nodiscard]] QByteArray exportData(const ts::ComputedDataModel& data) const noexcept override;
+
+        [[nodiscard]] static bool isContainer(const QByteArray& data) noexcept;
+
+        // the header chunk goes first and has no rows
+        [[nodiscard]] static tl::expected<std::vector<Chunk>, std::string> readIndex(const QByteArray& data) noexcept;
+        [[nodiscard]] static tl::expected<QJsonObject, std::string> readChunk(const QByteArray& data, const Chunk& chunk) noexcept;
+
+    private:
+        int m_rowsPerChunk;
+    };
+}
+
+#endif // CHUNKEDFORMAT_H
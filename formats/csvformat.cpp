@@ -1,10 +1,210 @@
 #include "csvformat.h"
+#include "parallel.h"
+#include "diagnostics/profiler.h"
 
+#include <QFile>
 #include <QStringList>
 #include <QStringBuilder>
 
+#include <algorithm>
+#include <deque>
+#include <string_view>
+
+namespace {
+    constexpr std::string_view dotMarker = "🔴";
+    constexpr std::string_view firstAppearanceMarker = "✅";
+    constexpr std::string_view byteOrderMark = "\xEF\xBB\xBF";
+
+    QString quoted(const QString& value)
+    {
+        if (!value.contains(',') && !value.contains('"') && !value.contains('\n') && !value.contains('\r')) {
+            return value;
+        }
+
+        return "\"" % QString(value).replace("\"", "\"\"") % "\"";
+    }
+
+    struct Field {
+        // between the quotes of a quoted field, with its quotes still doubled
+        std::string_view raw;
+        bool quoted = false;
+    };
+
+    std::string unescaped(const Field& field)
+    {
+        std::string res(field.raw);
+
+        if (field.quoted) {
+            for (auto position = res.find("\"\""); position != std::string::npos; position = res.find("\"\"", position + 1)) {
+                res.erase(position, 1);
+            }
+        }
+
+        return res;
+    }
+
+    // Splits the record at begin into fields and returns the beginning of the next one,
+    // nullptr for a quote that is never closed or is followed by anything but a separator,
+    // or for a quote inside an unquoted field. Quotes then only ever open or close quoted
+    // fields, so their parity tells where records begin just as reading them in turn does
+    const char* readRecord(const char* begin, const char* end, std::vector<Field>& fields)
+    {
+        fields.clear();
+
+        auto p = begin;
+
+        while (true) {
+            if (p < end && *p == '"') {
+                const auto start = ++p;
+
+                while (true) {
+                    p = std::find(p, end, '"');
+
+                    if (p == end) {
+                        return nullptr;
+                    }
+                    if (p + 1 < end && p[1] == '"') {
+                        p += 2;
+                        continue;
+                    }
+                    break;
+                }
+
+                fields.push_back(Field { .raw = std::string_view(start, std::size_t(p - start)), .quoted = true });
+
+                p++;
+
+                if (p < end && *p == '\r' && (p + 1 == end || p[1] == '\n')) {
+                    p++;
+                }
+                if (p == end || *p == '\n') {
+                    return p == end ? end : p + 1;
+                }
+                if (*p != ',') {
+                    return nullptr;
+                }
+
+                p++;
+            } else {
+                auto fieldEnd = p;
+                while (fieldEnd < end && *fieldEnd != ',' && *fieldEnd != '\n' && *fieldEnd != '"') {
+                    fieldEnd++;
+                }
+
+                if (fieldEnd < end && *fieldEnd == '"') {
+                    return nullptr;
+                }
+
+                auto raw = std::string_view(p, std::size_t(fieldEnd - p));
+
+                if (fieldEnd == end || *fieldEnd == '\n') {
+                    if (raw.ends_with('\r')) {
+                        raw.remove_suffix(1);
+                    }
+
+                    fields.push_back(Field { .raw = raw });
+
+                    return fieldEnd == end ? end : fieldEnd + 1;
+                }
+
+                fields.push_back(Field { .raw = raw });
+
+                p = fieldEnd + 1;
+            }
+        }
+    }
+
+    // article rows of one chunk, the dots of all of them are kept in one vector
+    struct ParsedRows {
+        std::vector<std::string_view> names;
+        // names that had doubled quotes, the views point into it
+        std::deque<std::string> unescapedNames;
+        std::vector<std::uint32_t> dots;
+        // per row, end of its dots
+        std::vector<std::size_t> dotsEnds;
+        std::vector<std::uint32_t> firstAppearance;
+
+        // beginning of the record that failed
+        std::optional<std::pair<const char*, std::string>> error;
+    };
+
+    // Parses the records that begin in [begin, chunkEnd), the last one may not go past it
+    void parseRows(const char* begin, const char* chunkEnd, const char* end, std::size_t subjectsCount, ParsedRows& res)
+    {
+        std::vector<Field> fields;
+        fields.reserve(subjectsCount + 1);
+
+        auto record = begin;
+
+        const auto fail = [&](std::string message) {
+            res.error = std::pair(record, std::move(message));
+        };
+
+        for (auto p = begin; p < chunkEnd;) {
+            record = p;
+
+            const auto next = readRecord(p, end, fields);
+
+            if (!next) {
+                return fail("broken quoting");
+            }
+            // the quotes before the next chunk didn't pair up the way the records read
+            if (next > chunkEnd) {
+                return fail("record crosses a chunk boundary, quotes don't match");
+            }
+
+            p = next;
+
+            // blank lines
+            if (fields.size() == 1 && fields.front().raw.empty() && !fields.front().quoted) {
+                continue;
+            }
+
+            const auto dotsBegin = res.dots.size();
+            std::optional<std::uint32_t> first;
+
+            for (auto column = std::size_t(1); column < std::min(fields.size(), subjectsCount + 1); column++) {
+                const auto cell = fields[column].raw;
+
+                if (cell.find(dotMarker) != std::string_view::npos) {
+                    res.dots.push_back(std::uint32_t(column - 1));
+                }
+
+                if (cell.find(firstAppearanceMarker) != std::string_view::npos) {
+                    if (first) {
+                        return fail("more than one first appearance");
+                    }
+                    first = std::uint32_t(column - 1);
+                }
+            }
+
+            if (res.dots.size() == dotsBegin) {
+                return fail("article has no dots");
+            }
+
+            const auto& name = fields.front();
+
+            if (name.quoted && name.raw.find("\"\"") != std::string_view::npos) {
+                res.names.push_back(res.unescapedNames.emplace_back(unescaped(name)));
+            } else {
+                res.names.push_back(name.raw);
+            }
+
+            res.firstAppearance.push_back(first.value_or(res.dots[dotsBegin]));
+            res.dotsEnds.push_back(res.dots.size());
+        }
+    }
+}
+
+ts::formats::CsvFormat::CsvFormat(std::size_t minChunkBytes) : m_minChunkBytes(std::max<std::size_t>(minChunkBytes, 1))
+{
+
+}
+
 QByteArray ts::formats::CsvFormat::exportData(const ts::ComputedDataModel &data) const noexcept
 {
+    TS_PROFILE_SCOPE("CsvFormat::exportData");
+
     QStringList res;
 
     {
@@ -12,11 +212,15 @@ QByteArray ts::formats::CsvFormat::exportData(const ts::ComputedDataModel &data)
         line << "Article Names";
 
         for (const auto& subject : data.getSubjects()) {
-            line << QString::fromStdString(subject.name);
+            line << quoted(subject.name.toQString());
         }
 
         line << "L" << "C" << "h";
 
+        for (const auto& metric : data.getMetrics()) {
+            line << quoted(QString::fromStdString(metric.name));
+        }
+
         res << std::move(line).join(',');
 
         line.clear();
@@ -25,7 +229,7 @@ QByteArray ts::formats::CsvFormat::exportData(const ts::ComputedDataModel &data)
     for (const auto& article : data.getArticles()) {
         QStringList line;
 
-        line << QString::fromStdString(article.name);
+        line << quoted(article.name.toQString());
 
         for (const auto& subject : data.getSubjects()) {
             QString cell;
@@ -44,8 +248,170 @@ QByteArray ts::formats::CsvFormat::exportData(const ts::ComputedDataModel &data)
 
         line << QString::number(computedData.l) << QString::number(computedData.c) << QString::number(computedData.h);
 
+        for (auto i = 0u; i < data.getMetrics().size(); i++) {
+            line << QString::number(data.getMetricValue(article.id, i));
+        }
+
         res << std::move(line).join(',');
     }
 
     return res.join('\n').toUtf8();
 }
+
+tl::expected<ts::VerifiedData, std::string> ts::formats::CsvFormat::importData(const QByteArray& data) const noexcept
+{
+    TS_PROFILE_SCOPE("CsvFormat::importData");
+
+    auto begin = data.constData();
+    const auto end = begin + data.size();
+
+    if (std::string_view(begin, std::size_t(data.size())).starts_with(byteOrderMark)) {
+        begin += byteOrderMark.size();
+    }
+
+    std::vector<Field> header;
+    const auto bodyBegin = readRecord(begin, end, header);
+
+    if (!bodyBegin) {
+        return tl::unexpected<std::string>("header row: broken quoting");
+    }
+
+    // subject columns end where the computed ones begin, if there are any
+    auto subjectsEnd = header.size();
+    for (auto i = std::size_t(1); i + 2 < header.size(); i++) {
+        if (header[i].raw == "L" && header[i + 1].raw == "C" && header[i + 2].raw == "h") {
+            subjectsEnd = i;
+            break;
+        }
+    }
+
+    if (subjectsEnd < 2) {
+        return tl::unexpected<std::string>("header row must name at least one subject");
+    }
+
+    const auto subjectsCount = subjectsEnd - 1;
+
+    // Chunks start after the first newline past their nominal start that is outside of
+    // quotes. Whether a position is inside quotes follows from the parity of the quotes
+    // before it, which is counted for all chunks in parallel first
+    const auto bodySize = std::size_t(end - bodyBegin);
+    const auto chunksCount = std::clamp<std::size_t>(bodySize / m_minChunkBytes, 1, std::size_t(std::max(1, QThread::idealThreadCount())) * 4);
+
+    const auto nominalStart = [&](std::size_t i) {
+        return bodyBegin + bodySize * i / chunksCount;
+    };
+
+    std::vector<std::size_t> quotes(chunksCount);
+
+    ts::parallel::forEachIndex(chunksCount, [&](std::size_t i) {
+        quotes[i] = std::size_t(std::count(nominalStart(i), nominalStart(i + 1), '"'));
+    });
+
+    std::vector<bool> startsInQuotes(chunksCount);
+    for (auto i = std::size_t(1); i < chunksCount; i++) {
+        startsInQuotes[i] = startsInQuotes[i - 1] != (quotes[i - 1] % 2 == 1);
+    }
+
+    std::vector<const char*> starts(chunksCount + 1, end);
+
+    ts::parallel::forEachIndex(chunksCount, [&](std::size_t i) {
+        if (i == 0) {
+            starts[i] = bodyBegin;
+            return;
+        }
+
+        auto inQuotes = bool(startsInQuotes[i]);
+
+        for (auto p = nominalStart(i); p < end; p++) {
+            if (*p == '"') {
+                inQuotes = !inQuotes;
+            } else if (*p == '\n' && !inQuotes) {
+                starts[i] = p + 1;
+                return;
+            }
+        }
+    });
+
+    std::vector<ParsedRows> parsed(chunksCount);
+
+    ts::parallel::forEachIndex(chunksCount, [&](std::size_t i) {
+        parseRows(starts[i], starts[i + 1], end, subjectsCount, parsed[i]);
+    });
+
+    auto rowsCount = std::size_t(0);
+
+    for (const auto& rows : parsed) {
+        if (rows.error) {
+            // physical lines, counting blank ones and the ones inside quoted fields
+            const auto line = std::count(data.constData(), rows.error->first, '\n') + 1;
+
+            return tl::unexpected("line " + std::to_string(line) + ": " + rows.error->second);
+        }
+
+        rowsCount += rows.names.size();
+    }
+
+    auto strings = std::make_shared<StringPool>();
+
+    Data res { .strings = strings };
+
+    res.subjects.reserve(subjectsCount);
+    for (auto i = std::size_t(0); i < subjectsCount; i++) {
+        res.subjects.push_back(Subject { .id = Subject::Id(unsigned(i + 1)), .name = strings->intern(unescaped(header[i + 1])) });
+    }
+
+    res.articles.reserve(rowsCount);
+
+    for (const auto& rows : parsed) {
+        auto dotsBegin = std::size_t(0);
+
+        for (auto row = std::size_t(0); row < rows.names.size(); row++) {
+            const auto articleId = Article::Id(unsigned(res.articles.size() + 1));
+
+            res.articles.push_back(Article { .id = articleId, .name = strings->intern(rows.names[row]) });
+
+            // ids ascend, so every node goes right before the end
+            auto& appearance = res.appearance.emplace_hint(res.appearance.end(), articleId, SubjectIdSet())->second;
+
+            for (auto dot = dotsBegin; dot < rows.dotsEnds[row]; dot++) {
+                appearance.insert(Subject::Id(rows.dots[dot] + 1));
+            }
+
+            res.firstAppearance.emplace_hint(res.firstAppearance.end(), articleId, Subject::Id(rows.firstAppearance[row] + 1));
+
+            dotsBegin = rows.dotsEnds[row];
+        }
+    }
+
+    // consistent by construction, the ids are the positions of columns and rows
+    return ts::VerifiedData::unverifiedFromRawData(std::move(res));
+}
+
+tl::expected<ts::VerifiedData, std::string> ts::formats::CsvFormat::importFile(const QString& filePath) const noexcept
+{
+    TS_PROFILE_SCOPE("CsvFormat::importFile");
+
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return tl::unexpected<std::string>("Can't open file");
+    }
+
+    if (file.size() == 0) {
+        return tl::unexpected<std::string>("File is empty");
+    }
+
+    auto* mapped = file.map(0, file.size());
+
+    // e.g. a pipe, which can't be mapped
+    if (!mapped) {
+        return importData(file.readAll());
+    }
+
+    // names are copied into the string pool, nothing points into the mapping afterwards
+    auto res = importData(QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), qsizetype(file.size())));
+
+    file.unmap(mapped);
+
+    return res;
+}
@@ -1,14 +1,30 @@
 #ifndef CSVFORMAT_H
 #define CSVFORMAT_H
 
-#include "datamodel.h"
+#include "computeddatamodel.h"
 #include "dataformats.h"
 
 namespace ts::formats {
-    class CsvFormat : public ts::formats::DataExporter
+    // A header row of "Article Names", the subject names, then L, C, h and the metric
+    // names, followed by one row per article. A cell of a subject holds 🔴 for a dot and
+    // ✅ for the first appearance. Fields may be quoted as in RFC 4180. On import the
+    // computed columns are ignored, they may as well be missing, and an article without
+    // ✅ first appears at its first dot. Ids follow the order of columns and rows
+    class CsvFormat : public ts::formats::DataExporter, public ts::formats::DataImporter
     {
     public:
+        // smaller documents are parsed on one thread
+        explicit CsvFormat(std::size_t minChunkBytes = 1 << 20);
+
         QByteArray exportData(const ts::ComputedDataModel &data) const noexcept override;
+
+        // Rows are split across threads at newlines outside of quotes
+        [[nodiscard]] tl::expected<ts::VerifiedData, std::string> importData(const QByteArray& data) const noexcept override;
+        // parses the file mapped into memory, without reading it into a buffer first
+        [[nodiscard]] tl::expected<ts::VerifiedData, std::string> importFile(const QString& filePath) const noexcept;
+
+    private:
+        std::size_t m_minChunkBytes;
     };
 }
 
@@ -1,11 +1,18 @@
 #include "jsonformat.h"
+#include "diagnostics/profiler.h"
 
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QStringList>
+
+#include <algorithm>
+#include <map>
+
+using namespace ts;
 
 template <typename T>
-tl::expected<std::vector<T>, std::string> parseVector(const QJsonArray& array) {
+tl::expected<std::vector<T>, std::string> parseVector(const QJsonArray& array, ts::StringPool& strings) {
     std::vector<T> res;
 
     for (const auto& elementJson : array) {
@@ -37,17 +44,241 @@ tl::expected<std::vector<T>, std::string> parseVector(const QJsonArray& array) {
             return tl::unexpected<std::string>("\'name\' field in elements must have string type");
         }
 
-        auto name = nameJson.toString().toStdString();
-
-        res.push_back(T{ .id = std::move(id), .name = std::move(name) });
+        res.push_back(T{ .id = std::move(id), .name = strings.intern(nameJson.toString()) });
     }
 
     return res;
 }
 
+namespace {
+    tl::expected<std::pair<AppearanceMap, FirstAppearanceMap>, std::string> parseAppearanceV1(const QJsonObject& root)
+    {
+        AppearanceMap appearance;
+        {
+            auto appearanceField = root["appearance"];
+
+            if (!appearanceField.isObject()) {
+                return tl::unexpected<std::string>("\'appearance\' field must have object type");
+            }
+
+            const auto appearanceObjet = appearanceField.toObject();
+
+            for (auto iter = appearanceObjet.begin(); iter != appearanceObjet.end(); ++iter) {
+                bool ok = false;
+                auto articleIdInt = iter.key().toUInt(&ok);
+                if (!ok) {
+                    return tl::unexpected<std::string>("\'articleId\' at 'appearance' field has bad format: " + iter.key().toStdString());
+                }
+
+                auto articleId = Article::Id(articleIdInt);
+
+                if (appearance.count(articleId)) {
+                    return tl::unexpected<std::string>("duplicate article ids at 'appearance' list " + std::to_string(unsigned(articleId)));
+                }
+
+                if (!iter.value().isArray()) {
+                    return tl::unexpected<std::string>("field values at 'appearance' object must have array type");
+                }
+
+                const auto subjectIdListJson = iter.value().toArray();
+
+                SubjectIdSet subjectIdsSet;
+                for (const auto& subjectIdJson : subjectIdListJson) {
+                    if (!subjectIdJson.isDouble()) {
+                        return tl::unexpected<std::string>("field values at 'appearance' object must have array type");
+                    }
+
+                    auto subjectId = Subject::Id(subjectIdJson.toInt());
+
+                    if (subjectIdsSet.contains(subjectId)) {
+                        return tl::unexpected<std::string>("duplicate subject ids at 'appearance' list " + std::to_string(unsigned(subjectId)));
+                    }
+
+                    subjectIdsSet.insert(subjectId);
+                }
+
+                appearance.insert_or_assign(articleId, std::move(subjectIdsSet));
+            }
+        }
+
+        FirstAppearanceMap firstAppearance;
+        {
+            auto firstAppearanceField = root["firstAppearance"];
+
+            if (!firstAppearanceField.isObject()) {
+                return tl::unexpected<std::string>("\'firstAppearance\' field must have object type");
+            }
+
+            const auto firstAppearanceObjet = firstAppearanceField.toObject();
+
+            for (auto iter = firstAppearanceObjet.begin(); iter != firstAppearanceObjet.end(); ++iter) {
+                bool ok = false;
+                auto articleIdInt = iter.key().toUInt(&ok);
+                if (!ok) {
+                    return tl::unexpected<std::string>("\'articleId\' at 'appearance' field has bad format: " + iter.key().toStdString());
+                }
+
+                auto articleId = Article::Id(articleIdInt);
+
+                if (firstAppearance.count(articleId)) {
+                    return tl::unexpected<std::string>("duplicate article ids at 'appearance' list " + std::to_string(unsigned(articleId)));
+                }
+
+                if (!iter.value().isDouble()) {
+                    return tl::unexpected<std::string>("field values at 'appearance' object must have array type");
+                }
+
+                const auto subjectId = Subject::Id(iter.value().toInt());
+
+                firstAppearance.insert_or_assign(articleId, subjectId);
+            }
+        }
+
+        return std::pair(std::move(appearance), std::move(firstAppearance));
+    }
+
+    // In v2 a row is a bitstring over the subjects order. It is written either as base64
+    // of the bits, least significant bit first, or as the marker followed by comma separated
+    // run lengths that alternate between empty and dotted positions, starting with an empty run
+    constexpr QChar runLengthMarker = u'*';
+
+    QString encodeRow(const std::vector<bool>& dots)
+    {
+        QByteArray bits(int((dots.size() + 7) / 8), '\0');
+        QStringList runs;
+
+        auto current = false;
+        auto run = 0;
+
+        for (auto i = 0u; i < dots.size(); i++) {
+            if (dots[i]) {
+                bits[i / 8] = char(bits[i / 8] | (1 << (i % 8)));
+            }
+
+            if (dots[i] != current) {
+                runs << QString::number(run);
+                current = dots[i];
+                run = 0;
+            }
+
+            run++;
+        }
+
+        if (current) {
+            runs << QString::number(run);
+        }
+
+        auto runLength = runLengthMarker + runs.join(',');
+        auto base64 = QString::fromLatin1(bits.toBase64());
+
+        return runLength.size() < base64.size() ? std::move(runLength) : std::move(base64);
+    }
+
+    tl::expected<SubjectIdSet, std::string> decodeRow(const QString& row, const std::vector<ts::Subject>& subjects)
+    {
+        SubjectIdSet res;
+
+        if (row.startsWith(runLengthMarker)) {
+            const auto runs = row.mid(1);
+
+            if (runs.isEmpty()) {
+                return res;
+            }
+
+            auto position = std::size_t(0);
+            auto dotted = false;
+
+            for (const auto& runText : runs.split(',')) {
+                bool ok = false;
+                const auto run = runText.toUInt(&ok);
+
+                if (!ok || position + run > subjects.size()) {
+                    return tl::unexpected<std::string>("run-length row has bad format or is longer than subjects list: " + row.toStdString());
+                }
+
+                for (auto i = position; dotted && i < position + run; i++) {
+                    res.insert(subjects[i].id);
+                }
+
+                position += run;
+                dotted = !dotted;
+            }
+
+            return res;
+        }
+
+        const auto bits = QByteArray::fromBase64Encoding(row.toLatin1(), QByteArray::AbortOnBase64DecodingErrors);
+
+        if (!bits || std::size_t(bits->size()) != (subjects.size() + 7) / 8) {
+            return tl::unexpected<std::string>("bitstring row has bad format or doesn't match subjects count: " + row.toStdString());
+        }
+
+        for (auto i = 0u; i < std::size_t(bits->size()) * 8; i++) {
+            if (!((bits->at(i / 8) >> (i % 8)) & 1)) {
+                continue;
+            }
+
+            if (i >= subjects.size()) {
+                return tl::unexpected<std::string>("bitstring row is longer than subjects list: " + row.toStdString());
+            }
+
+            res.insert(subjects[i].id);
+        }
+
+        return res;
+    }
+
+    tl::expected<std::pair<AppearanceMap, FirstAppearanceMap>, std::string> parseAppearanceV2(const QJsonObject& root, const std::vector<ts::Subject>& subjects, const std::vector<ts::Article>& articles)
+    {
+        const auto appearanceField = root["appearance"];
+        const auto firstAppearanceField = root["firstAppearance"];
+
+        if (!appearanceField.isArray() || !firstAppearanceField.isArray()) {
+            return tl::unexpected<std::string>("'appearance' and 'firstAppearance' fields must have array type");
+        }
+
+        const auto appearanceArray = appearanceField.toArray();
+        const auto firstAppearanceArray = firstAppearanceField.toArray();
+
+        if (std::size_t(appearanceArray.size()) != articles.size() || std::size_t(firstAppearanceArray.size()) != articles.size()) {
+            return tl::unexpected<std::string>("'appearance' and 'firstAppearance' must have a row per article");
+        }
+
+        AppearanceMap appearance;
+        FirstAppearanceMap firstAppearance;
+
+        for (auto i = 0u; i < articles.size(); i++) {
+            const auto rowJson = appearanceArray[int(i)];
+
+            if (!rowJson.isString()) {
+                return tl::unexpected<std::string>("rows at 'appearance' field must have string type");
+            }
+
+            auto row = decodeRow(rowJson.toString(), subjects);
+
+            if (!row) {
+                return tl::unexpected("Error at parse row " + std::to_string(i) + " of 'appearance': " + row.error());
+            }
+
+            const auto firstJson = firstAppearanceArray[int(i)];
+
+            if (!firstJson.isDouble() || firstJson.toInt(-1) < 0 || std::size_t(firstJson.toInt()) >= subjects.size()) {
+                return tl::unexpected<std::string>("values at 'firstAppearance' field must be subject indices");
+            }
+
+            appearance.insert_or_assign(articles[i].id, std::move(row).value());
+            firstAppearance.insert_or_assign(articles[i].id, subjects[firstJson.toInt()].id);
+        }
+
+        return std::pair(std::move(appearance), std::move(firstAppearance));
+    }
+}
+
 
 tl::expected<ts::VerifiedData, std::string> ts::formats::JsonFormat::importData(const QByteArray& data) const noexcept
 {
+    TS_PROFILE_SCOPE("JsonFormat::importData");
+
     QJsonParseError error;
     auto json = QJsonDocument::fromJson(data, &error);
 
@@ -59,12 +290,17 @@ tl::expected<ts::VerifiedData, std::string> ts::formats::JsonFormat::importData(
         return tl::unexpected<std::string>("Root element must have object type");
     }
 
-    auto root = json.object();
+    return importObject(json.object());
+}
 
+tl::expected<ts::VerifiedData, std::string> ts::formats::JsonFormat::importObject(QJsonObject root) const noexcept
+{
     if (!root.contains("subjects")) {
         return tl::unexpected<std::string>("Root object must contains \'subjects\' field");
     }
 
+    auto strings = std::make_shared<StringPool>();
+
     std::vector<ts::Subject> subjects;
     {
         auto subjectsField = root["subjects"];
@@ -75,7 +311,7 @@ tl::expected<ts::VerifiedData, std::string> ts::formats::JsonFormat::importData(
 
         const auto subjectsArray = subjectsField.toArray();
 
-        auto subjectsRes = parseVector<ts::Subject>(subjectsArray);
+        auto subjectsRes = parseVector<ts::Subject>(subjectsArray, *strings);
 
         if (!subjectsRes) {
             return tl::unexpected("Error at parse field 'subjects': " + subjectsRes.error());
@@ -94,7 +330,7 @@ tl::expected<ts::VerifiedData, std::string> ts::formats::JsonFormat::importData(
 
         const auto articlesArray = articlesField.toArray();
 
-        auto articlesRes = parseVector<ts::Article>(articlesArray);
+        auto articlesRes = parseVector<ts::Article>(articlesArray, *strings);
 
         if (!articlesRes) {
             return tl::unexpected("Error at parse field 'articles': " + articlesRes.error());
@@ -103,84 +339,66 @@ tl::expected<ts::VerifiedData, std::string> ts::formats::JsonFormat::importData(
         articles = std::move(articlesRes).value();
     }
 
-    std::map<Article::Id, std::set<Subject::Id>> appearance;
-    {
-        auto appearanceField = root["appearance"];
-
-        if (!appearanceField.isObject()) {
-            return tl::unexpected<std::string>("\'appearance\' field must have object type");
-        }
-
-        const auto appearanceObjet = appearanceField.toObject();
+    const auto version = root.contains("version") ? root["version"].toInt() : 1;
 
-        for (auto iter = appearanceObjet.begin(); iter != appearanceObjet.end(); ++iter) {
-            bool ok = false;
-            auto articleIdInt = iter.key().toUInt(&ok);
-            if (!ok) {
-                return tl::unexpected<std::string>("\'articleId\' at 'appearance' field has bad format: " + iter.key().toStdString());
-            }
-
-            auto articleId = Article::Id(articleIdInt);
+    if (version != 1 && version != 2) {
+        return tl::unexpected("unsupported document version " + std::to_string(version));
+    }
 
-            if (appearance.count(articleId)) {
-                return tl::unexpected<std::string>("duplicate article ids at 'appearance' list " + std::to_string(unsigned(articleId)));
-            }
+    auto appearanceRes = version == 1 ? parseAppearanceV1(root) : parseAppearanceV2(root, subjects, articles);
 
-            if (!iter.value().isArray()) {
-                return tl::unexpected<std::string>("field values at 'appearance' object must have array type");
-            }
+    if (!appearanceRes) {
+        return tl::unexpected(std::move(appearanceRes).error());
+    }
 
-            const auto subjectIdListJson = iter.value().toArray();
+    auto [appearance, firstAppearance] = std::move(appearanceRes).value();
 
-            std::set<Subject::Id> subjectIdsSet;
-            for (const auto& subjectIdJson : subjectIdListJson) {
-                if (!subjectIdJson.isDouble()) {
-                    return tl::unexpected<std::string>("field values at 'appearance' object must have array type");
-                }
+    ScoringPolicy scoring;
+    if (root.contains("scoring")) {
+        auto scoringField = root["scoring"];
 
-                auto subjectId = Subject::Id(subjectIdJson.toInt());
+        if (!scoringField.isObject()) {
+            return tl::unexpected<std::string>("\'scoring\' field must have object type");
+        }
 
-                if (subjectIdsSet.contains(subjectId)) {
-                    return tl::unexpected<std::string>("duplicate subject ids at 'appearance' list " + std::to_string(unsigned(subjectId)));
-                }
+        const auto scoringObject = scoringField.toObject();
 
-                subjectIdsSet.insert(subjectId);
+        for (const auto& [key, weight] : { std::pair("p_1", &scoring.p_1), std::pair("p_2", &scoring.p_2) }) {
+            if (!scoringObject.contains(key)) {
+                continue;
             }
 
-            appearance.insert_or_assign(articleId, std::move(subjectIdsSet));
-        }
-    }
+            const auto weightJson = scoringObject[key];
 
-    std::map<ts::Article::Id, ts::Subject::Id> firstAppearance;
-    {
-        auto firstAppearanceField = root["firstAppearance"];
+            if (!weightJson.isDouble() || weightJson.toDouble() != weightJson.toInt() || !ScoringPolicy::isValidWeight(weightJson.toInt())) {
+                return tl::unexpected("\'" + std::string(key) + "\' field at 'scoring' object must be an integer from " + std::to_string(ScoringPolicy::minWeight) + " to " + std::to_string(ScoringPolicy::maxWeight));
+            }
 
-        if (!firstAppearanceField.isObject()) {
-            return tl::unexpected<std::string>("\'firstAppearance\' field must have object type");
+            *weight = weightJson.toInt();
         }
 
-        const auto firstAppearanceObjet = firstAppearanceField.toObject();
+        if (scoringObject.contains("normalization")) {
+            const auto normalization = scoringObject["normalization"].toString();
 
-        for (auto iter = firstAppearanceObjet.begin(); iter != firstAppearanceObjet.end(); ++iter) {
-            bool ok = false;
-            auto articleIdInt = iter.key().toUInt(&ok);
-            if (!ok) {
-                return tl::unexpected<std::string>("\'articleId\' at 'appearance' field has bad format: " + iter.key().toStdString());
+            if (normalization == "subjects") {
+                scoring.normalization = Normalization::Subjects;
+            } else if (normalization == "span") {
+                scoring.normalization = Normalization::Span;
+            } else {
+                return tl::unexpected<std::string>("\'normalization\' field at 'scoring' object must be 'subjects' or 'span'");
             }
+        }
 
-            auto articleId = Article::Id(articleIdInt);
-
-            if (firstAppearance.count(articleId)) {
-                return tl::unexpected<std::string>("duplicate article ids at 'appearance' list " + std::to_string(unsigned(articleId)));
-            }
+        if (scoringObject.contains("arithmetic")) {
+            const auto arithmetic = scoringObject["arithmetic"].toString();
 
-            if (!iter.value().isDouble()) {
-                return tl::unexpected<std::string>("field values at 'appearance' object must have array type");
+            if (arithmetic == "float") {
+                scoring.arithmetic = Arithmetic::Float;
+            } else if (arithmetic == "exact") {
+                scoring.arithmetic = Arithmetic::Exact;
+            } else {
+                return tl::unexpected<std::string>("\'arithmetic\' field at 'scoring' object must be 'float' or 'exact'");
             }
-
-            const auto subjectId = Subject::Id(iter.value().toInt());
-
-            firstAppearance.insert_or_assign(articleId, subjectId);
         }
     }
 
@@ -188,20 +406,29 @@ tl::expected<ts::VerifiedData, std::string> ts::formats::JsonFormat::importData(
                                     .subjects = std::move(subjects),
                                     .articles = std::move(articles),
                                     .firstAppearance = std::move(firstAppearance),
-                                    .appearance = std::move(appearance)
+                                    .appearance = std::move(appearance),
+                                    .scoring = scoring,
+                                    .strings = std::move(strings)
                                 });
 }
 
 QByteArray ts::formats::JsonFormat::exportData(const ts::ComputedDataModel &data_model) const noexcept
 {
-    const auto data = data_model.getData();
+    TS_PROFILE_SCOPE("JsonFormat::exportData");
+
+    return QJsonDocument(exportObject(data_model)).toJson(m_exportVersion == Version::V2 ? QJsonDocument::Compact : QJsonDocument::Indented);
+}
+
+QJsonObject ts::formats::JsonFormat::exportObject(const ts::ComputedDataModel &data_model) const noexcept
+{
+    const auto data = data_model.getOriginalData();
 
     QJsonArray subjectsListJson;
 
     for (const auto& subject : data.data().subjects) {
         subjectsListJson.append(QJsonObject{
                                 { "id", int(unsigned(subject.id)) },
-                                { "name", QString::fromStdString(subject.name) }
+                                { "name", subject.name.toQString() }
                             });
     }
 
@@ -209,10 +436,57 @@ QByteArray ts::formats::JsonFormat::exportData(const ts::ComputedDataModel &data
     for (const auto& article : data.data().articles) {
         articlesListJson.append(QJsonObject{
                                 { "id", int(unsigned(article.id)) },
-                                { "name", QString::fromStdString(article.name) }
+                                { "name", article.name.toQString() }
                             });
     }
 
+    const auto& scoring = data.data().scoring;
+
+    QJsonObject scoringJson {
+        { "p_1", scoring.p_1 },
+        { "p_2", scoring.p_2 },
+        { "normalization", scoring.normalization == Normalization::Span ? "span" : "subjects" }
+    };
+
+    // float documents are written as before the field existed
+    if (scoring.arithmetic == Arithmetic::Exact) {
+        scoringJson.insert("arithmetic", "exact");
+    }
+
+    if (m_exportVersion == Version::V2) {
+        const auto& subjects = data.data().subjects;
+
+        std::map<Subject::Id, std::size_t> subjectIndices;
+        for (auto i = 0u; i < subjects.size(); i++) {
+            subjectIndices.insert_or_assign(subjects[i].id, i);
+        }
+
+        QJsonArray firstAppearanceJson;
+        QJsonArray appearanceJson;
+
+        std::vector<bool> dots(subjects.size());
+
+        for (const auto& article : data.data().articles) {
+            firstAppearanceJson.append(int(subjectIndices.at(data.data().firstAppearance.at(article.id))));
+
+            std::ranges::fill(dots, false);
+            for (const auto& subjectId : data.data().appearance.at(article.id)) {
+                dots[subjectIndices.at(subjectId)] = true;
+            }
+
+            appearanceJson.append(encodeRow(dots));
+        }
+
+        return QJsonObject{
+            {"version", 2},
+            {"subjects", std::move(subjectsListJson)},
+            {"articles", std::move(articlesListJson)},
+            {"firstAppearance", std::move(firstAppearanceJson)},
+            {"appearance", std::move(appearanceJson)},
+            {"scoring", std::move(scoringJson)}
+        };
+    }
+
     QJsonObject firstAppearanceJson;
     for (const auto& [articleId, subjectId] : data.data().firstAppearance) {
         firstAppearanceJson[QString::number(unsigned(articleId))] = int(unsigned(subjectId));
@@ -229,10 +503,16 @@ QByteArray ts::formats::JsonFormat::exportData(const ts::ComputedDataModel &data
         appearanceJson[QString::number(unsigned(articleId))] = std::move(subjectIdsJson);
     }
 
-    return QJsonDocument(QJsonObject{
-                             {"subjects", std::move(subjectsListJson)},
-                             {"articles", std::move(articlesListJson)},
-                             {"firstAppearance", std::move(firstAppearanceJson)},
-                             {"appearance", std::move(appearanceJson)}
-                         }).toJson();
+    return QJsonObject{
+        {"subjects", std::move(subjectsListJson)},
+        {"articles", std::move(articlesListJson)},
+        {"firstAppearance", std::move(firstAppearanceJson)},
+        {"appearance", std::move(appearanceJson)},
+        {"scoring", std::move(scoringJson)}
+    };
+}
+
+ts::formats::JsonFormat::JsonFormat(Version exportVersion) : m_exportVersion(exportVersion)
+{
+
 }
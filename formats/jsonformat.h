@@ -2,14 +2,33 @@
 #define JSONFORMAT_H
 
 #include "dataformats.h"
-#include "datamodel.h"
+#include "computeddatamodel.h"
+
+#include <QJsonObject>
 
 namespace ts::formats {
     class JsonFormat : public DataExporter, public DataImporter
     {
     public:
+        // v2 writes every appearance row as a compact bitstring over the subjects order
+        // and first appearance as a subject index. Import detects the version by itself.
+        // Releases before v2 can't open it, so v1 stays the default unless a save asks for v2
+        enum class Version {
+            V1 = 1,
+            V2 = 2
+        };
+
+        explicit JsonFormat(Version exportVersion = Version::V1);
+
         [[nodiscard]] tl::expected<ts::VerifiedData, std::string> importData(const QByteArray& data) const noexcept override;
         [[nodiscard]] QByteArray exportData(const ts::ComputedDataModel& data) const noexcept override;
+
+        // same as importData and exportData, for containers that embed the document
+        [[nodiscard]] tl::expected<ts::VerifiedData, std::string> importObject(QJsonObject root) const noexcept;
+        [[nodiscard]] QJsonObject exportObject(const ts::ComputedDataModel& data) const noexcept;
+
+    private:
+        Version m_exportVersion;
     };
 }
 
@@ -0,0 +1,123 @@
+#include "generator.h"
+
+#include <limits>
+#include <random>
+
+using namespace ts;
+using namespace ts::fuzz;
+
+namespace {
+    std::uint64_t splitMix(std::uint64_t x) noexcept
+    {
+        x += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    template<typename Id>
+    std::vector<Id> makeIds(int count, bool maximum, std::mt19937_64& rng)
+    {
+        using K = typename Id::underlying_type;
+
+        std::vector<Id> ids;
+        ids.reserve(count);
+
+        if (maximum) {
+            for (auto i = 0; i < count; i++) {
+                ids.push_back(Id(std::numeric_limits<K>::max() - K(i)));
+            }
+        } else {
+            std::vector<K> values(count * 3);
+            for (auto i = 0u; i < values.size(); i++) {
+                values[i] = K(i + 1);
+            }
+            std::shuffle(values.begin(), values.end(), rng);
+
+            for (auto i = 0; i < count; i++) {
+                ids.push_back(Id(values[i]));
+            }
+        }
+
+        std::shuffle(ids.begin(), ids.end(), rng);
+
+        return ids;
+    }
+
+    std::string makeName(const char* prefix, int index, std::mt19937_64& rng)
+    {
+        static const char* suffixes[] = { "", " ", "\"quoted\"", ",comma", "Ж", "🔴", "\n" };
+
+        return prefix + std::to_string(index) + suffixes[rng() % std::size(suffixes)];
+    }
+}
+
+CurriculumGenerator::CurriculumGenerator(std::uint64_t seed, GeneratorOptions options)
+    : m_seed(seed), m_options(options)
+{
+
+}
+
+Data CurriculumGenerator::generate(std::uint64_t caseIndex) const
+{
+    std::mt19937_64 rng(splitMix(m_seed ^ splitMix(caseIndex)));
+
+    const auto edgeCase = edgeCaseOf(caseIndex);
+
+    const auto subjectsCount = edgeCase == EdgeCase::SingleSubject ? 1 : 1 + int(rng() % m_options.maxSubjects);
+    const auto articlesCount = int(rng() % (m_options.maxArticles + 1));
+
+    Data data;
+
+    const auto subjectIds = makeIds<Subject::Id>(subjectsCount, edgeCase == EdgeCase::MaximumIds, rng);
+    for (auto i = 0; i < subjectsCount; i++) {
+        data.subjects.push_back(Subject { .id = subjectIds[i], .name = data.strings->intern(makeName("Subject ", i, rng)) });
+    }
+
+    const auto articleIds = makeIds<Article::Id>(articlesCount, edgeCase == EdgeCase::MaximumIds, rng);
+
+    std::uniform_real_distribution<double> chance(0, 1);
+    const auto density = chance(rng);
+
+    for (auto i = 0; i < articlesCount; i++) {
+        const auto articleId = articleIds[i];
+
+        data.articles.push_back(Article { .id = articleId, .name = data.strings->intern(makeName("Article ", i, rng)) });
+
+        SubjectIdSet appearance;
+        auto lastDot = 0;
+
+        if (edgeCase != EdgeCase::EmptyRows || rng() % 2) {
+            for (auto k = 0; k < subjectsCount; k++) {
+                if (chance(rng) < density) {
+                    appearance.insert(data.subjects[k].id);
+                    lastDot = k;
+                }
+            }
+        }
+
+        auto firstAppearance = int(rng() % subjectsCount);
+
+        if (edgeCase == EdgeCase::FirstAppearanceAfterAllDots) {
+            firstAppearance = std::min(subjectsCount - 1, lastDot + 1);
+        }
+
+        data.firstAppearance.insert_or_assign(articleId, data.subjects[firstAppearance].id);
+        data.appearance.insert_or_assign(articleId, std::move(appearance));
+    }
+
+    // Half of the cases keep the default weights, so the specialized kernels are covered too
+    if (rng() % 2) {
+        data.scoring.p_1 = 1 + int(rng() % 3);
+        data.scoring.p_2 = 1 + int(rng() % 4);
+        data.scoring.normalization = rng() % 2 ? Normalization::Span : Normalization::Subjects;
+        data.scoring.arithmetic = rng() % 2 ? Arithmetic::Exact : Arithmetic::Float;
+    }
+
+    return data;
+}
+
+EdgeCase CurriculumGenerator::edgeCaseOf(std::uint64_t caseIndex) noexcept
+{
+    return EdgeCase(caseIndex % 5);
+}
@@ -0,0 +1,37 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include "Data.h"
+
+#include <cstdint>
+
+namespace ts::fuzz {
+    enum class EdgeCase {
+        None,
+        SingleSubject,
+        FirstAppearanceAfterAllDots,
+        EmptyRows,
+        MaximumIds
+    };
+
+    struct GeneratorOptions {
+        int maxSubjects = 12;
+        int maxArticles = 24;
+    };
+
+    // Deterministic random curricula: the same seed and case index always give the same data
+    class CurriculumGenerator {
+    public:
+        explicit CurriculumGenerator(std::uint64_t seed, GeneratorOptions options = {});
+
+        Data generate(std::uint64_t caseIndex) const;
+
+        static EdgeCase edgeCaseOf(std::uint64_t caseIndex) noexcept;
+
+    private:
+        std::uint64_t m_seed;
+        GeneratorOptions m_options;
+    };
+}
+
+#endif // GENERATOR_H
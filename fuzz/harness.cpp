@@ -0,0 +1,1123 @@
+#include "harness.h"
+#include "appearancecolumns.h"
+#include "computeddatamodel.h"
+#include "editjournal.h"
+#include "formats/jsonformat.h"
+#include "formats/chunkedformat.h"
+#include "formats/csvformat.h"
+#include "parallel.h"
+#include "sensitivity.h"
+#include "service/scoringservice.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QTextStream>
+
+#include <atomic>
+#include <cmath>
+#include <mutex>
+
+using namespace ts;
+using namespace ts::fuzz;
+
+namespace {
+    std::optional<std::string> invoke(const Check& check, const Data& data)
+    {
+        try {
+            return check(data);
+        } catch (const std::exception& e) {
+            return std::string("exception: ") + e.what();
+        } catch (...) {
+            return std::string("unknown exception");
+        }
+    }
+
+    std::string idOf(Article::Id id)
+    {
+        return std::to_string(unsigned(id));
+    }
+
+    std::string idOf(Subject::Id id)
+    {
+        return std::to_string(unsigned(id));
+    }
+
+    tl::expected<ComputedDataModel, std::string> computeModel(const Data& data)
+    {
+        auto verified = VerifiedData::verify(Data(data));
+
+        if (!verified) {
+            return tl::unexpected("generated data does not verify: " + verified.error());
+        }
+
+        return ComputedDataModel::compute(std::move(verified).value());
+    }
+
+    std::optional<std::string> compareData(const Data& expected, const Data& actual)
+    {
+        if (expected.subjects.size() != actual.subjects.size()) {
+            return "subjects count differs";
+        }
+        for (auto i = 0u; i < expected.subjects.size(); i++) {
+            if (expected.subjects[i].id != actual.subjects[i].id || expected.subjects[i].name != actual.subjects[i].name) {
+                return "subject at " + std::to_string(i) + " differs";
+            }
+        }
+
+        if (expected.articles.size() != actual.articles.size()) {
+            return "articles count differs";
+        }
+        for (auto i = 0u; i < expected.articles.size(); i++) {
+            if (expected.articles[i].id != actual.articles[i].id || expected.articles[i].name != actual.articles[i].name) {
+                return "article at " + std::to_string(i) + " differs";
+            }
+        }
+
+        if (expected.firstAppearance != actual.firstAppearance) {
+            return "first appearance differs";
+        }
+        if (expected.appearance != actual.appearance) {
+            return "appearance differs";
+        }
+        if (expected.scoring != actual.scoring) {
+            return "scoring policy differs";
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<std::string> checkSensitivity(const Data& data)
+    {
+        auto appearance = data.appearance;
+
+        for (const auto& article : data.articles) {
+            const auto base = algorithm::computeOuterLinks(data.subjects, data.firstAppearance, appearance, article.id, data.scoring);
+            const auto sensitivity = algorithm::computeToggleSensitivity(data.subjects, data.firstAppearance, appearance, article.id, data.scoring);
+
+            auto& row = appearance.at(article.id);
+
+            for (auto i = 0u; i < data.subjects.size(); i++) {
+                const auto subjectId = data.subjects[i].id;
+                const auto hadDot = row.contains(subjectId);
+                const auto allowed = !(hadDot && row.size() == 1);
+
+                const auto where = "article " + idOf(article.id) + ", subject " + idOf(subjectId);
+
+                if (allowed != sensitivity[i].allowed) {
+                    return where + ": toggle is " + (allowed ? "allowed" : "forbidden") + " but sensitivity says otherwise";
+                }
+                if (!allowed) {
+                    continue;
+                }
+
+                if (hadDot) {
+                    row.erase(subjectId);
+                } else {
+                    row.insert(subjectId);
+                }
+
+                const auto toggled = algorithm::computeOuterLinks(data.subjects, data.firstAppearance, appearance, article.id, data.scoring);
+
+                if (hadDot) {
+                    row.insert(subjectId);
+                } else {
+                    row.erase(subjectId);
+                }
+
+                const auto expected = toggled.h - base.h;
+
+                if (std::abs(expected - sensitivity[i].h) > 1e-4f || std::abs((toggled.c - base.c) - sensitivity[i].c) > 1e-4f) {
+                    return where + ": expected dh " + std::to_string(expected) + ", got " + std::to_string(sensitivity[i].h);
+                }
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<std::string> checkCompute(const Data& data)
+    {
+        auto model = computeModel(data);
+
+        if (!model) {
+            return model.error();
+        }
+
+        std::map<Article::Id, float> c;
+
+        const algorithm::SubjectPositions positions(data.subjects);
+
+        for (const auto& article : data.articles) {
+            const auto expected = algorithm::computeOuterLinks(data.subjects, data.firstAppearance, data.appearance, article.id, data.scoring);
+            const auto& actual = model.value().getComputedDataForArticle(article.id);
+
+            if (expected.l != actual.l || expected.c != actual.c || expected.h != actual.h) {
+                return "article " + idOf(article.id) + ": scores differ from computeOuterLinks";
+            }
+
+            const auto& metrics = model.value().getMetrics();
+            std::vector<float> values(metrics.size());
+            const auto fused = algorithm::computeMetrics(data.subjects, positions, data.firstAppearance, data.appearance, article.id, data.scoring, metrics, values);
+
+            if (expected.l != fused.l || expected.c != fused.c || expected.h != fused.h) {
+                return "article " + idOf(article.id) + ": fused metric pass changes the scores";
+            }
+            for (auto i = 0u; i < metrics.size(); i++) {
+                if (values[i] != model.value().getMetricValue(article.id, i)) {
+                    return "article " + idOf(article.id) + ": metric " + metrics[i].name + " differs from the stored one";
+                }
+            }
+
+            c.insert_or_assign(article.id, expected.c);
+        }
+
+        std::optional<float> C_nu;
+
+        if (!c.empty()) {
+            auto sum = 0.f;
+            auto fixedSum = std::int64_t(0);
+            for (const auto& [_, value] : c) {
+                sum += value;
+                fixedSum += algorithm::fixedOf(value);
+            }
+            C_nu = data.scoring.arithmetic == Arithmetic::Exact ? algorithm::floatOf(fixedSum, std::int64_t(c.size())) : sum / c.size();
+        }
+
+        if (C_nu != model.value().getC_nu()) {
+            return "C_nu differs from the serial sum";
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<std::string> checkRows(const Data& data)
+    {
+        // every subject is added and then removed, so rows cross between the sparse and the dense form,
+        // an id past 16 bits crosses between the narrow and the wide sparse one
+        for (const auto& [articleId, row] : data.appearance) {
+            auto edited = row;
+            std::set<Subject::Id> expected(row.begin(), row.end());
+
+            const auto compare = [&]() -> std::optional<std::string> {
+                if (edited.size() != expected.size() || !std::ranges::equal(edited, expected)) {
+                    return "article " + idOf(articleId) + ": row differs from std::set after an edit";
+                }
+                return std::nullopt;
+            };
+
+            for (const auto& subject : data.subjects) {
+                edited.insert(subject.id);
+                expected.insert(subject.id);
+
+                if (auto error = compare()) {
+                    return error;
+                }
+            }
+
+            for (const auto farId : { Subject::Id(0x10000), Subject::Id(0x10001) }) {
+                edited.insert(farId);
+                expected.insert(farId);
+
+                if (auto error = compare()) {
+                    return error;
+                }
+            }
+
+            for (const auto farId : { Subject::Id(0x10001), Subject::Id(0x10000) }) {
+                edited.erase(farId);
+                expected.erase(farId);
+
+                if (auto error = compare()) {
+                    return error;
+                }
+            }
+
+            for (const auto& subject : data.subjects) {
+                edited.erase(subject.id);
+                expected.erase(subject.id);
+
+                if (auto error = compare()) {
+                    return error;
+                }
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<std::string> checkColumns(const Data& data)
+    {
+        struct Row {
+            SubjectIdSet appearance;
+            Subject::Id firstAppearance;
+            algorithm::ComputedData scores;
+        };
+
+        std::map<Article::Id, Row> expected;
+
+        for (const auto& article : data.articles) {
+            const auto scores = algorithm::computeOuterLinks(data.subjects, data.firstAppearance, data.appearance, article.id, data.scoring);
+            expected.insert_or_assign(article.id, Row { data.appearance.at(article.id), data.firstAppearance.at(article.id), scores });
+        }
+
+        auto missingSubject = Subject::Id(0);
+        while (std::ranges::find(data.subjects, missingSubject, &Subject::id) != data.subjects.end()) {
+            missingSubject = Subject::Id(unsigned(missingSubject) + 1);
+        }
+
+        AppearanceColumns columns;
+        columns.reset(data.subjects);
+
+        for (const auto& [articleId, row] : expected) {
+            columns.setRow(articleId, row.appearance, row.firstAppearance, row.scores);
+        }
+
+        // rows move between articles and gain a subject the columns don't have, every third is
+        // erased and every sixth is set again into a freed slot
+        const auto originals = expected;
+
+        for (auto i = 0u; i < data.articles.size(); i++) {
+            auto row = originals.at(data.articles[(i + 1) % data.articles.size()].id);
+            row.appearance.insert(missingSubject);
+            if (i % 5 == 0) {
+                row.firstAppearance = missingSubject;
+            }
+
+            columns.setRow(data.articles[i].id, row.appearance, row.firstAppearance, row.scores);
+            expected.insert_or_assign(data.articles[i].id, std::move(row));
+        }
+
+        for (auto i = 0u; i < data.articles.size(); i += 3) {
+            columns.eraseRow(data.articles[i].id);
+            expected.erase(data.articles[i].id);
+        }
+
+        for (auto i = 0u; i < data.articles.size(); i += 6) {
+            const auto& row = originals.at(data.articles[i].id);
+
+            columns.setRow(data.articles[i].id, row.appearance, row.firstAppearance, row.scores);
+            expected.insert_or_assign(data.articles[i].id, row);
+        }
+
+        // a full recount of the rows that are left
+        const auto bitOf = [](const AppearanceColumns::Bitset& bitset, std::size_t slot) {
+            return (bitset[slot / AppearanceColumns::wordBits] >> (slot % AppearanceColumns::wordBits) & 1) != 0;
+        };
+
+        if (columns.appearance(missingSubject) || columns.firstAppearance(missingSubject) || columns.load(missingSubject)) {
+            return "columns have a subject the document doesn't";
+        }
+
+        std::set<Article::Id> seen;
+
+        for (auto slot = std::size_t(0); slot < columns.wordsCount() * AppearanceColumns::wordBits; slot++) {
+            if (!bitOf(columns.rows(), slot)) {
+                for (const auto& subject : data.subjects) {
+                    if (bitOf(*columns.appearance(subject.id), slot) || bitOf(*columns.firstAppearance(subject.id), slot)) {
+                        return "empty slot " + std::to_string(slot) + " has bits set";
+                    }
+                }
+                continue;
+            }
+
+            const auto articleId = columns.articleAt(slot);
+            const auto row = expected.find(articleId);
+
+            if (row == expected.end() || !seen.insert(articleId).second) {
+                return "slot " + std::to_string(slot) + " holds article " + idOf(articleId) + ", which is erased or in another slot";
+            }
+
+            for (const auto& subject : data.subjects) {
+                if (bitOf(*columns.appearance(subject.id), slot) != row->second.appearance.contains(subject.id)
+                    || bitOf(*columns.firstAppearance(subject.id), slot) != (row->second.firstAppearance == subject.id)) {
+                    return "article " + idOf(articleId) + ": column of subject " + idOf(subject.id) + " differs from its row";
+                }
+            }
+
+            const auto& scores = row->second.scores;
+
+            if (columns.scores(AppearanceColumns::Score::L)[slot] != scores.l || columns.scores(AppearanceColumns::Score::C)[slot] != scores.c
+                || columns.scores(AppearanceColumns::Score::H)[slot] != scores.h) {
+                return "article " + idOf(articleId) + ": scores in the columns differ";
+            }
+        }
+
+        if (seen.size() != expected.size()) {
+            return "columns hold " + std::to_string(seen.size()) + " rows instead of " + std::to_string(expected.size());
+        }
+
+        for (const auto& subject : data.subjects) {
+            AppearanceColumns::SubjectLoad load;
+
+            for (const auto& [_, row] : expected) {
+                load.dots += row.appearance.contains(subject.id);
+
+                if (row.firstAppearance == subject.id) {
+                    load.firstAppearances++;
+                    load.firstAppearanceHSum += row.scores.h;
+                }
+            }
+
+            const auto* actual = columns.load(subject.id);
+
+            if (actual->dots != load.dots || actual->firstAppearances != load.firstAppearances
+                || std::abs(actual->firstAppearanceHSum - load.firstAppearanceHSum) > 1e-6 * std::max(1.0, std::abs(load.firstAppearanceHSum))) {
+                return "subject " + idOf(subject.id) + ": load differs from the recount";
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<std::string> checkExact(const Data& data)
+    {
+        auto exactData = data;
+        exactData.scoring.arithmetic = Arithmetic::Exact;
+
+        auto model = computeModel(exactData);
+
+        if (!model) {
+            return model.error();
+        }
+
+        // C_nu that followed the edits has to match a recount bitwise
+        for (const auto& article : data.articles) {
+            model.value().setFirstAppearance(data.subjects.back().id, article.id);
+            model.value().setAppearance(data.subjects.front().id, article.id, true);
+        }
+
+        const auto recounted = ComputedDataModel::compute(model.value().getData());
+
+        if (model.value().getC_nu() != recounted.getC_nu()) {
+            return "C_nu after edits differs from the recount";
+        }
+
+        for (const auto& article : data.articles) {
+            const auto& expected = recounted.getComputedDataForArticle(article.id);
+            const auto& actual = model.value().getComputedDataForArticle(article.id);
+
+            if (expected.l != actual.l || expected.c != actual.c || expected.h != actual.h) {
+                return "article " + idOf(article.id) + ": scores after edits differ from the recount";
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<std::string> checkCompactIds(const Data& data)
+    {
+        auto model = computeModel(data);
+        auto verified = VerifiedData::verify(Data(data));
+
+        if (!model || !verified) {
+            return model ? verified.error() : model.error();
+        }
+
+        auto compact = ComputedDataModel::compute(std::move(verified).value(), std::make_unique<DocumentMemory>(), IdMode::Compact);
+
+        // the same edits through the original ids
+        for (const auto& article : data.articles) {
+            model.value().setAppearance(data.subjects.back().id, article.id, true);
+            compact.setAppearance(compact.subjectIdOf(data.subjects.back().id), compact.articleIdOf(article.id), true);
+        }
+
+        if (!data.articles.empty()) {
+            model.value().removeArticle(data.articles.front().id);
+            compact.removeArticle(compact.articleIdOf(data.articles.front().id));
+        }
+
+        model.value().addArticle("added");
+        compact.addArticle("added");
+
+        const auto& articles = model.value().getArticles();
+        const auto& compactArticles = compact.getArticles();
+
+        for (auto i = 0u; i < articles.size(); i++) {
+            const auto& expected = model.value().getComputedDataForArticle(articles[i].id);
+            const auto& actual = compact.getComputedDataForArticle(compactArticles[i].id);
+
+            if (expected.l != actual.l || expected.c != actual.c || expected.h != actual.h) {
+                return "article " + idOf(articles[i].id) + ": scores on compact ids differ";
+            }
+        }
+
+        // articles are summed in the order of their ids, which compaction changes
+        const auto C_nu = model.value().getC_nu();
+        const auto compactC_nu = compact.getC_nu();
+
+        if (C_nu.has_value() != compactC_nu.has_value() || (C_nu && std::abs(C_nu.value() - compactC_nu.value()) > 1e-4f * std::max(1.0f, std::abs(C_nu.value())))) {
+            return "C_nu on compact ids differs";
+        }
+
+        if (auto error = compareData(model.value().getData().data(), compact.getOriginalData().data())) {
+            return "restored ids differ: " + error.value();
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<std::string> checkRemoveArticles(const Data& data)
+    {
+        auto model = computeModel(data);
+
+        if (!model) {
+            return model.error();
+        }
+
+        // every other article, plus an id twice and one that isn't there
+        std::vector<Article::Id> removed;
+        for (auto i = 0u; i < data.articles.size(); i += 2) {
+            removed.push_back(data.articles[i].id);
+        }
+        if (!removed.empty()) {
+            removed.push_back(removed.front());
+        }
+        removed.push_back(Article::Id(0));
+
+        model.value().removeArticles(removed);
+
+        const auto recounted = ComputedDataModel::compute(model.value().getData());
+        const auto& articles = model.value().getArticles();
+
+        if (articles.size() != data.articles.size() / 2) {
+            return "wrong count of articles left";
+        }
+
+        for (auto i = 0u; i < articles.size(); i++) {
+            if (articles[i].id != data.articles[2 * i + 1].id) {
+                return "article " + idOf(articles[i].id) + " is out of order after the removal";
+            }
+        }
+
+        const auto C_nu = model.value().getC_nu();
+        const auto expected = recounted.getC_nu();
+
+        // float C_nu follows the removed scores, so only the exact one has to match bitwise
+        const auto tolerance = data.scoring.arithmetic == Arithmetic::Exact ? 0.0f : 1e-4f * std::max(1.0f, std::abs(expected.value_or(0)));
+
+        if (C_nu.has_value() != expected.has_value() || (C_nu && std::abs(C_nu.value() - expected.value()) > tolerance)) {
+            return "C_nu after the removal differs from the recount";
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<std::string> checkJournal(const Data& data)
+    {
+        auto model = computeModel(data);
+
+        if (!model) {
+            return model.error();
+        }
+
+        const auto journal = EditJournal::inMemory();
+        model.value().setJournal(journal.get());
+
+        // an edit of every kind that is recorded
+        for (auto i = 0u; i < data.articles.size(); i++) {
+            const auto articleId = data.articles[i].id;
+
+            try {
+                model.value().setAppearance(data.subjects[i % data.subjects.size()].id, articleId, i % 3 != 0);
+            } catch (const ThereMustBeAtLeastOneSubject&) {
+            }
+
+            model.value().setFirstAppearance(data.subjects[i * 7 % data.subjects.size()].id, articleId);
+
+            if (i % 4 == 0) {
+                model.value().toggleSubjectAppearance(articleId);
+            }
+        }
+
+        model.value().addSubject("journal subject");
+        model.value().addArticle("journal article");
+        model.value().renameArticle(0, "renamed article");
+        model.value().renameSubject(0, "renamed subject");
+
+        auto subjects = model.value().getSubjects();
+        subjects.erase(subjects.begin());
+        std::ranges::reverse(subjects);
+        model.value().setSubjects(std::move(subjects));
+
+        auto scoring = data.scoring;
+        scoring.p_1 = scoring.p_1 % ScoringPolicy::maxWeight + 1;
+        model.value().setScoringPolicy(scoring);
+
+        if (model.value().getArticles().size() > 1) {
+            model.value().removeArticle(model.value().getArticles().front().id);
+        }
+        model.value().sort();
+
+        model.value().setJournal(nullptr);
+
+        const auto expected = model.value().getData();
+
+        // ids may wrap around to 0 as they are added, so the missing ones are looked for
+        auto missingSubject = Subject::Id(0);
+        while (std::ranges::find(expected.data().subjects, missingSubject, &Subject::id) != expected.data().subjects.end()) {
+            missingSubject = Subject::Id(unsigned(missingSubject) + 1);
+        }
+        auto missingArticle = Article::Id(0);
+        while (expected.data().appearance.contains(missingArticle)) {
+            missingArticle = Article::Id(unsigned(missingArticle) + 1);
+        }
+
+        const auto someSubject = expected.data().subjects.front().id;
+        const auto someArticle = expected.data().articles.front().id;
+
+        for (const auto ids : { IdMode::Original, IdMode::Compact }) {
+            const auto where = std::string(ids == IdMode::Original ? "original" : "compact") + " ids: ";
+
+            auto replayed = ComputedDataModel::compute(VerifiedData::verify(Data(data)).value(), std::make_unique<DocumentMemory>(), ids);
+
+            if (auto applied = EditJournal::applyRecords(replayed, journal->records()); !applied) {
+                return where + "journal can't be applied: " + applied.error();
+            }
+
+            if (auto error = compareData(expected.data(), replayed.getOriginalData().data())) {
+                return where + "journal applied to the snapshot differs from the edited model: " + error.value();
+            }
+
+            // records of ids the document doesn't have fail and leave it as it was
+            const std::vector<std::function<void(EditJournal&)>> invalidEdits = {
+                [&](EditJournal& edits) { edits.setAppearance(missingSubject, someArticle, true); },
+                [&](EditJournal& edits) { edits.setAppearance(someSubject, missingArticle, true); },
+                [&](EditJournal& edits) { edits.setFirstAppearance(missingSubject, someArticle); },
+                [&](EditJournal& edits) { edits.removeArticle(missingArticle); },
+                [&](EditJournal& edits) { edits.toggleSubjectAppearance(missingArticle); },
+                [&](EditJournal& edits) { edits.renameArticle(int(expected.data().articles.size()), "past the end"); }
+            };
+
+            for (auto i = 0u; i < invalidEdits.size(); i++) {
+                const auto invalid = EditJournal::inMemory();
+                invalidEdits[i](*invalid);
+
+                if (EditJournal::applyRecords(replayed, invalid->records())) {
+                    return where + "invalid record " + std::to_string(i) + " is applied";
+                }
+                if (auto error = compareData(expected.data(), replayed.getOriginalData().data())) {
+                    return where + "invalid record " + std::to_string(i) + " changes the model: " + error.value();
+                }
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<std::string> checkServiceEdits(const Data& data)
+    {
+        auto reference = computeModel(data);
+
+        if (!reference) {
+            return reference.error();
+        }
+
+        // the same edits made on a model and sent to the service, as JSON and as journal records
+        const auto journal = EditJournal::inMemory();
+        reference.value().setJournal(journal.get());
+
+        QJsonArray edits;
+
+        for (auto i = 0u; i < data.articles.size(); i++) {
+            const auto articleId = qint64(unsigned(data.articles[i].id));
+            const auto subjectId = data.subjects[i % data.subjects.size()].id;
+
+            reference.value().setAppearance(subjectId, data.articles[i].id, true);
+            reference.value().setFirstAppearance(subjectId, data.articles[i].id);
+            edits.append(QJsonObject { { "op", "setAppearance" }, { "subject", qint64(unsigned(subjectId)) }, { "article", articleId } });
+            edits.append(QJsonObject { { "op", "setFirstAppearance" }, { "subject", qint64(unsigned(subjectId)) }, { "article", articleId } });
+
+            if (i % 4 == 0) {
+                reference.value().toggleSubjectAppearance(data.articles[i].id);
+                edits.append(QJsonObject { { "op", "toggleSubjectAppearance" }, { "article", articleId } });
+            }
+        }
+
+        reference.value().addSubject("service subject");
+        reference.value().addArticle("service article");
+        reference.value().renameArticle(0, "renamed article");
+        reference.value().renameSubject(0, "renamed subject");
+        edits.append(QJsonObject { { "op", "addSubject" }, { "name", "service subject" } });
+        edits.append(QJsonObject { { "op", "addArticle" }, { "name", "service article" } });
+        edits.append(QJsonObject { { "op", "renameArticle" }, { "index", 0 }, { "name", "renamed article" } });
+        edits.append(QJsonObject { { "op", "renameSubject" }, { "index", 0 }, { "name", "renamed subject" } });
+
+        if (!data.articles.empty()) {
+            reference.value().removeArticle(data.articles.front().id);
+            edits.append(QJsonObject { { "op", "removeArticle" }, { "article", qint64(unsigned(data.articles.front().id)) } });
+        }
+
+        reference.value().sort();
+        edits.append(QJsonObject { { "op", "sort" } });
+
+        reference.value().setJournal(nullptr);
+
+        const auto records = QString::fromLatin1(journal->records().toBase64());
+
+        const auto send = [&](const QJsonValue& batch) {
+            const auto request = service::ScoringService::Request { .message = QJsonObject { { "id", 1 }, { "edits", batch } } };
+
+            return service::ScoringService::runBatch("key", std::make_shared<ComputedDataModel>(computeModel(data).value()), { request });
+        };
+
+        for (const auto& [form, edited] : { std::pair("JSON", QJsonValue(edits)), std::pair("base64", QJsonValue(records)) }) {
+            const auto where = std::string(form) + " edits: ";
+            const auto result = send(edited);
+            const auto& response = result.responses.front();
+
+            if (response.contains("error")) {
+                return where + "fail with " + response["error"].toString().toStdString();
+            }
+
+            const auto scores = response["scores"].toArray();
+            const auto& articles = reference.value().getArticles();
+
+            if (scores.size() != qsizetype(articles.size())) {
+                return where + "scores of " + std::to_string(scores.size()) + " articles instead of " + std::to_string(articles.size());
+            }
+
+            for (auto i = 0u; i < articles.size(); i++) {
+                const auto score = scores[qsizetype(i)].toObject();
+                const auto& expected = reference.value().getComputedDataForArticle(articles[i].id);
+
+                if (score["id"].toDouble() != double(unsigned(articles[i].id)) || float(score["l"].toDouble()) != expected.l
+                    || float(score["c"].toDouble()) != expected.c || float(score["h"].toDouble()) != expected.h) {
+                    return where + "scores of article " + idOf(articles[i].id) + " differ from the edited model";
+                }
+            }
+        }
+
+        // every invalid batch is refused and drops the document it may have edited halfway
+        auto missingArticle = Article::Id(0);
+        while (std::ranges::find(data.articles, missingArticle, &Article::id) != data.articles.end()) {
+            missingArticle = Article::Id(unsigned(missingArticle) + 1);
+        }
+
+        const auto missingRecords = EditJournal::inMemory();
+        missingRecords->removeArticle(missingArticle);
+
+        const auto invalidEdits = {
+            QJsonValue(QJsonArray { QJsonObject { { "op", "removeArticle" }, { "article", qint64(unsigned(missingArticle)) } } }),
+            QJsonValue(QJsonArray { QJsonObject { { "op", "setAppearance" }, { "subject", -1 }, { "article", 1 } } }),
+            QJsonValue(QJsonArray { QJsonObject { { "op", "setAppearance" }, { "subject", "1" }, { "article", 1 }, { "value", 1 } } }),
+            QJsonValue(QJsonArray { QJsonObject { { "op", "renameArticle" }, { "index", 0.5 }, { "name", "x" } } }),
+            QJsonValue(QJsonArray { QJsonObject { { "op", "unknown" } } }),
+            QJsonValue(QJsonArray { QJsonObject { { "op", "addSubject" } } }),
+            QJsonValue(QJsonArray { 1 }),
+            QJsonValue(QString::fromLatin1(missingRecords->records().toBase64())),
+            QJsonValue("not base64!"),
+            QJsonValue(1)
+        };
+
+        auto index = 0;
+
+        for (const auto& invalid : invalidEdits) {
+            const auto result = send(invalid);
+
+            if (!result.responses.front().contains("error") || result.model) {
+                return "invalid edits " + std::to_string(index) + " are applied";
+            }
+
+            index++;
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<std::string> checkJsonRoundTrip(const Data& data)
+    {
+        auto model = computeModel(data);
+
+        if (!model) {
+            return model.error();
+        }
+
+        for (const auto version : { formats::JsonFormat::Version::V1, formats::JsonFormat::Version::V2 }) {
+            auto imported = formats::JsonFormat().importData(formats::JsonFormat(version).exportData(model.value()));
+            const auto where = "v" + std::to_string(int(version)) + " ";
+
+            if (!imported) {
+                return where + "exported document can't be imported: " + imported.error();
+            }
+
+            if (auto error = compareData(data, imported.value().data())) {
+                return where + "imported document differs: " + error.value();
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<std::string> checkChunkedRoundTrip(const Data& data)
+    {
+        auto model = computeModel(data);
+
+        if (!model) {
+            return model.error();
+        }
+
+        // small chunks, so that documents of a few articles still span several of them
+        const auto format = formats::ChunkedFormat(3);
+
+        auto imported = format.importData(format.exportData(model.value()));
+
+        if (!imported) {
+            return "exported container can't be imported: " + imported.error();
+        }
+
+        if (auto error = compareData(data, imported.value().data())) {
+            return "imported container differs: " + error.value();
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<std::string> checkCsvRoundTrip(const Data& generated)
+    {
+        // a row without dots can't be told from a blank line, so it gets one
+        auto data = generated;
+        for (auto& [articleId, row] : data.appearance) {
+            if (row.empty()) {
+                row.insert(data.firstAppearance.at(articleId));
+            }
+        }
+
+        auto model = computeModel(data);
+
+        if (!model) {
+            return model.error();
+        }
+
+        // small chunks, so that the rows are split across threads even in short documents,
+        // quoted multi-line names included
+        const auto format = formats::CsvFormat(16);
+
+        auto imported = format.importData(format.exportData(model.value()));
+
+        if (!imported) {
+            return "exported CSV can't be imported: " + imported.error();
+        }
+
+        // ids are the positions of columns and rows in CSV
+        const auto& actual = imported.value().data();
+
+        if (actual.subjects.size() != data.subjects.size() || actual.articles.size() != data.articles.size()) {
+            return "imported CSV has different counts of subjects or articles";
+        }
+        for (auto i = 0u; i < data.subjects.size(); i++) {
+            if (actual.subjects[i].name != data.subjects[i].name) {
+                return "subject at " + std::to_string(i) + " has a different name after CSV";
+            }
+        }
+
+        for (auto i = 0u; i < data.articles.size(); i++) {
+            const auto articleId = data.articles[i].id;
+            const auto actualId = actual.articles[i].id;
+
+            if (actual.articles[i].name != data.articles[i].name) {
+                return "article " + idOf(articleId) + " has a different name after CSV";
+            }
+
+            for (auto j = 0u; j < data.subjects.size(); j++) {
+                const auto subjectId = data.subjects[j].id;
+                const auto actualSubjectId = actual.subjects[j].id;
+
+                if (data.appearance.at(articleId).contains(subjectId) != actual.appearance.at(actualId).contains(actualSubjectId)) {
+                    return "article " + idOf(articleId) + ": dot at subject " + idOf(subjectId) + " differs after CSV";
+                }
+                if ((data.firstAppearance.at(articleId) == subjectId) != (actual.firstAppearance.at(actualId) == actualSubjectId)) {
+                    return "article " + idOf(articleId) + ": first appearance differs after CSV";
+                }
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<std::string> checkSort(const Data& data)
+    {
+        auto model = computeModel(data);
+
+        if (!model) {
+            return model.error();
+        }
+
+        using Key = std::pair<float, std::vector<bool>>;
+
+        const auto keyOf = [&](Article::Id articleId) {
+            Key key { model.value().getComputedDataForArticle(articleId).h, {} };
+
+            for (const auto& subject : data.subjects) {
+                key.second.push_back(model.value().isArticleAppearedAt(articleId, subject.id));
+            }
+
+            return key;
+        };
+
+        std::vector<Key> expected;
+        for (const auto& article : data.articles) {
+            expected.push_back(keyOf(article.id));
+        }
+        std::ranges::stable_sort(expected, std::greater{});
+
+        model.value().sort();
+
+        std::vector<Key> actual;
+        std::set<Article::Id> ids;
+        for (const auto& article : model.value().getArticles()) {
+            actual.push_back(keyOf(article.id));
+            ids.insert(article.id);
+        }
+
+        if (ids.size() != data.articles.size()) {
+            return "sorted articles are not a permutation of the original ones";
+        }
+        if (expected != actual) {
+            return "sorted order differs from the reference order";
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<std::string> checkQuery(const Data& data)
+    {
+        auto model = computeModel(data);
+
+        if (!model) {
+            return model.error();
+        }
+
+        // the columns have to follow removals as well
+        if (data.articles.size() > 1) {
+            model.value().removeArticle(data.articles.front().id);
+        }
+
+        const auto& subjects = model.value().getSubjects();
+
+        for (auto i = 0u; i < subjects.size(); i++) {
+            const auto position = "#" + std::to_string(i + 1);
+            const auto query = "first(" + position + ") & !after(" + position + ") | dot(" + position + ") & h >= 0.5";
+
+            const auto reference = [&](Article::Id articleId) {
+                auto appearedAfter = false;
+                for (auto j = i + 1; j < subjects.size(); j++) {
+                    appearedAfter = appearedAfter || model.value().isArticleAppearedAt(articleId, subjects[j].id);
+                }
+
+                return (model.value().isArticleFirstAppearedAt(articleId, subjects[i].id) && !appearedAfter)
+                    || (model.value().isArticleAppearedAt(articleId, subjects[i].id) && model.value().getComputedDataForArticle(articleId).h >= 0.5f);
+            };
+
+            std::vector<Article::Id> expected;
+            for (const auto& article : model.value().getArticles()) {
+                if (reference(article.id)) {
+                    expected.push_back(article.id);
+                }
+            }
+            std::sort(expected.begin(), expected.end());
+
+            auto actual = model.value().queryArticles(query);
+
+            if (!actual) {
+                return query + " can't be evaluated: " + actual.error();
+            }
+            if (actual.value() != expected) {
+                return query + " matches " + std::to_string(actual.value().size()) + " articles instead of " + std::to_string(expected.size());
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    Data withoutArticle(const Data& data, std::size_t index)
+    {
+        auto res = data;
+        const auto articleId = res.articles[index].id;
+
+        res.articles.erase(res.articles.begin() + index);
+        res.appearance.erase(articleId);
+        res.firstAppearance.erase(articleId);
+
+        return res;
+    }
+
+    Data withoutSubject(const Data& data, std::size_t index)
+    {
+        auto res = data;
+        const auto subjectId = res.subjects[index].id;
+
+        res.subjects.erase(res.subjects.begin() + index);
+
+        for (auto& [_, subjects] : res.appearance) {
+            subjects.erase(subjectId);
+        }
+        for (auto& [_, firstSubjectId] : res.firstAppearance) {
+            if (firstSubjectId == subjectId) {
+                firstSubjectId = res.subjects.front().id;
+            }
+        }
+
+        return res;
+    }
+}
+
+std::vector<NamedCheck> ts::fuzz::defaultChecks()
+{
+    return {
+        NamedCheck { .name = "sensitivity", .check = checkSensitivity },
+        NamedCheck { .name = "compute", .check = checkCompute },
+        NamedCheck { .name = "exact", .check = checkExact },
+        NamedCheck { .name = "rows", .check = checkRows },
+        NamedCheck { .name = "columns", .check = checkColumns },
+        NamedCheck { .name = "compact-ids", .check = checkCompactIds },
+        NamedCheck { .name = "remove-articles", .check = checkRemoveArticles },
+        NamedCheck { .name = "journal", .check = checkJournal },
+        NamedCheck { .name = "service-edits", .check = checkServiceEdits },
+        NamedCheck { .name = "json-roundtrip", .check = checkJsonRoundTrip },
+        NamedCheck { .name = "chunked-roundtrip", .check = checkChunkedRoundTrip },
+        NamedCheck { .name = "csv-roundtrip", .check = checkCsvRoundTrip },
+        NamedCheck { .name = "sort", .check = checkSort },
+        NamedCheck { .name = "query", .check = checkQuery }
+    };
+}
+
+Report ts::fuzz::run(const CurriculumGenerator& generator, const std::vector<NamedCheck>& checks, std::uint64_t cases, std::size_t maxCounterexamples)
+{
+    Report report { .cases = cases };
+
+    std::mutex mutex;
+    std::atomic<std::size_t> found = 0;
+
+    ts::parallel::forEachIndex(std::size_t(cases), [&](std::size_t caseIndex) {
+        if (found >= maxCounterexamples) {
+            return;
+        }
+
+        const auto data = generator.generate(caseIndex);
+
+        for (const auto& [name, check] : checks) {
+            if (auto message = invoke(check, data)) {
+                std::lock_guard lock(mutex);
+
+                if (report.counterexamples.size() < maxCounterexamples) {
+                    report.counterexamples.push_back(Counterexample { .checkName = name, .caseIndex = caseIndex, .message = std::move(message).value(), .data = data });
+                }
+                found++;
+
+                return;
+            }
+        }
+    });
+
+    std::ranges::sort(report.counterexamples, {}, &Counterexample::caseIndex);
+
+    for (auto& counterexample : report.counterexamples) {
+        const auto& check = std::ranges::find(checks, counterexample.checkName, &NamedCheck::name)->check;
+
+        counterexample.data = shrink(std::move(counterexample.data), check);
+        counterexample.message = invoke(check, counterexample.data).value_or(counterexample.message);
+    }
+
+    return report;
+}
+
+Data ts::fuzz::shrink(Data data, const Check& check)
+{
+    const auto fails = [&](const Data& candidate) {
+        return invoke(check, candidate).has_value();
+    };
+
+    for (auto progress = true; progress;) {
+        progress = false;
+
+        for (auto i = 0u; i < data.articles.size();) {
+            if (auto candidate = withoutArticle(data, i); fails(candidate)) {
+                data = std::move(candidate);
+                progress = true;
+            } else {
+                i++;
+            }
+        }
+
+        for (auto i = 0u; i < data.subjects.size() && data.subjects.size() > 1;) {
+            if (auto candidate = withoutSubject(data, i); fails(candidate)) {
+                data = std::move(candidate);
+                progress = true;
+            } else {
+                i++;
+            }
+        }
+
+        for (const auto& article : data.articles) {
+            const auto subjectIds = data.appearance[article.id];
+
+            for (const auto& subjectId : subjectIds) {
+                auto candidate = data;
+                candidate.appearance[article.id].erase(subjectId);
+
+                if (fails(candidate)) {
+                    data = std::move(candidate);
+                    progress = true;
+                }
+            }
+        }
+    }
+
+    return data;
+}
+
+std::string ts::fuzz::describe(const Data& data)
+{
+    std::string res = "subjects:";
+
+    for (const auto& subject : data.subjects) {
+        res += " [" + idOf(subject.id) + "] " + subject.name.toStdString() + ";";
+    }
+
+    res += "\narticles ('F' first appearance with dot, 'f' first appearance, 'x' dot, '.' empty):\n";
+
+    for (const auto& article : data.articles) {
+        res += "  [" + idOf(article.id) + "] ";
+
+        const auto appearance = data.appearance.find(article.id);
+        const auto firstAppearance = data.firstAppearance.find(article.id);
+
+        for (const auto& subject : data.subjects) {
+            const auto hasDot = appearance != data.appearance.end() && appearance->second.contains(subject.id);
+            const auto isFirst = firstAppearance != data.firstAppearance.end() && firstAppearance->second == subject.id;
+
+            res += isFirst ? (hasDot ? 'F' : 'f') : (hasDot ? 'x' : '.');
+        }
+
+        res += " " + article.name.toStdString() + "\n";
+    }
+
+    return res;
+}
+
+int ts::fuzz::runFromCommandLine(const QStringList& arguments)
+{
+    QTextStream out(stdout);
+
+    const auto cases = arguments.value(1, "100000").toULongLong();
+    const auto seed = arguments.value(2, "0").toULongLong();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const auto report = run(CurriculumGenerator(seed), defaultChecks(), cases);
+
+    out << "checked " << report.cases << " cases with seed " << seed << " in " << timer.elapsed() << " ms\n";
+
+    for (const auto& counterexample : report.counterexamples) {
+        out << "FAILED " << QString::fromStdString(counterexample.checkName) << " at case " << counterexample.caseIndex << ": "
+            << QString::fromStdString(counterexample.message) << "\n"
+            << "shrunk counterexample:\n" << QString::fromStdString(describe(counterexample.data));
+    }
+
+    if (report.counterexamples.empty()) {
+        out << "OK\n";
+    }
+
+    return report.counterexamples.empty() ? 0 : 1;
+}
@@ -0,0 +1,46 @@
+#ifndef HARNESS_H
+#define HARNESS_H
+
+#include "generator.h"
+
+#include <QStringList>
+
+#include <functional>
+#include <optional>
+
+namespace ts::fuzz {
+    // Returns a description of the mismatch, or nothing when the engines agree
+    using Check = std::function<std::optional<std::string>(const Data& data)>;
+
+    struct NamedCheck {
+        std::string name;
+        Check check;
+    };
+
+    struct Counterexample {
+        std::string checkName;
+        std::uint64_t caseIndex = 0;
+        std::string message;
+        Data data;
+    };
+
+    struct Report {
+        std::uint64_t cases = 0;
+        std::vector<Counterexample> counterexamples;
+    };
+
+    // Current implementations used as the oracle against their alternative engines
+    std::vector<NamedCheck> defaultChecks();
+
+    Report run(const CurriculumGenerator& generator, const std::vector<NamedCheck>& checks, std::uint64_t cases, std::size_t maxCounterexamples = 1);
+
+    // Greedily drops articles, subjects and dots while the check keeps failing
+    Data shrink(Data data, const Check& check);
+
+    std::string describe(const Data& data);
+
+    // Entry point of "teachingscores_fuzz [cases] [seed]"
+    int runFromCommandLine(const QStringList& arguments);
+}
+
+#endif // HARNESS_H
@@ -0,0 +1,9 @@
+#include "harness.h"
+
+#include <QCoreApplication>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    return ts::fuzz::runFromCommandLine(a.arguments());
+}
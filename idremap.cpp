@@ -0,0 +1,119 @@
+#include "idremap.h"
+#include "diagnostics/profiler.h"
+
+#include <stdexcept>
+
+using namespace ts;
+
+template<typename T>
+typename IdTable<T>::Id IdTable<T>::originalOf(Id id) const
+{
+    return Id(m_originals.at(unsigned(id)));
+}
+
+template<typename T>
+std::optional<typename IdTable<T>::Id> IdTable<T>::idOf(Id original) const noexcept
+{
+    const auto iter = m_ids.find(unsigned(original));
+
+    return iter != m_ids.end() ? std::optional(Id(iter->second)) : std::nullopt;
+}
+
+template<typename T>
+void IdTable<T>::add(Id id)
+{
+    add(id, Id(m_lastOriginal + 1));
+}
+
+template<typename T>
+void IdTable<T>::add(Id id, Id original)
+{
+    if (m_ids.contains(unsigned(original))) {
+        throw std::runtime_error("Original id is already taken");
+    }
+
+    if (unsigned(id) >= m_originals.size()) {
+        m_originals.resize(unsigned(id) + 1);
+    }
+
+    m_originals[unsigned(id)] = unsigned(original);
+    m_ids.insert_or_assign(unsigned(original), unsigned(id));
+    m_lastOriginal = std::max(m_lastOriginal, unsigned(original));
+}
+
+template<typename T>
+std::size_t IdTable<T>::memoryUsage() const noexcept
+{
+    return m_originals.capacity() * sizeof(unsigned) + m_ids.size() * (2 * sizeof(unsigned) + sizeof(void*)) + m_ids.bucket_count() * sizeof(void*);
+}
+
+template class ts::IdTable<Subject>;
+template class ts::IdTable<Article>;
+
+IdRemap IdRemap::compact(Data& data)
+{
+    TS_PROFILE_SCOPE("IdRemap::compact");
+
+    IdRemap res;
+
+    for (auto i = 0u; i < data.subjects.size(); i++) {
+        const auto id = Subject::Id(i + 1);
+        res.subjects.add(id, data.subjects[i].id);
+        data.subjects[i].id = id;
+    }
+
+    for (auto i = 0u; i < data.articles.size(); i++) {
+        const auto id = Article::Id(i + 1);
+        res.articles.add(id, data.articles[i].id);
+        data.articles[i].id = id;
+    }
+
+    FirstAppearanceMap firstAppearance(data.firstAppearance.get_allocator());
+    AppearanceMap appearance(data.appearance.get_allocator());
+
+    for (const auto& [articleId, subjectId] : data.firstAppearance) {
+        firstAppearance.insert_or_assign(res.articles.idOf(articleId).value(), res.subjects.idOf(subjectId).value());
+    }
+
+    for (const auto& [articleId, subjectIds] : data.appearance) {
+        auto& row = appearance[res.articles.idOf(articleId).value()];
+
+        for (const auto subjectId : subjectIds) {
+            row.insert(res.subjects.idOf(subjectId).value());
+        }
+    }
+
+    data.firstAppearance = std::move(firstAppearance);
+    data.appearance = std::move(appearance);
+
+    return res;
+}
+
+void IdRemap::restore(Data& data) const
+{
+    for (auto& subject : data.subjects) {
+        subject.id = subjects.originalOf(subject.id);
+    }
+
+    for (auto& article : data.articles) {
+        article.id = articles.originalOf(article.id);
+    }
+
+    FirstAppearanceMap firstAppearance(data.firstAppearance.get_allocator());
+    AppearanceMap appearance(data.appearance.get_allocator());
+
+    for (const auto& [articleId, subjectId] : data.firstAppearance) {
+        firstAppearance.insert_or_assign(articles.originalOf(articleId), subjects.originalOf(subjectId));
+    }
+
+    for (const auto& [articleId, subjectIds] : data.appearance) {
+        auto& row = appearance[articles.originalOf(articleId)];
+
+        for (const auto subjectId : subjectIds) {
+            row.insert(subjects.originalOf(subjectId));
+        }
+    }
+
+    data.firstAppearance = std::move(firstAppearance);
+    data.appearance = std::move(appearance);
+}
@@ -0,0 +1,51 @@
+#ifndef IDREMAP_H
+#define IDREMAP_H
+
+#include "Data.h"
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace ts {
+    enum class IdMode { Original, Compact };
+
+    // Ids of one kind given by IdRemap, and the ids they stand for in the document file
+    template<typename T>
+    class IdTable {
+    public:
+        using Id = typename T::Id;
+
+        Id originalOf(Id id) const;
+        std::optional<Id> idOf(Id original) const noexcept;
+
+        // an id given after the load, it takes the next original id nobody has
+        void add(Id id);
+        void add(Id id, Id original);
+
+        std::size_t memoryUsage() const noexcept;
+
+    private:
+        // indexed by id
+        std::vector<unsigned> m_originals;
+        std::unordered_map<unsigned, unsigned> m_ids;
+        unsigned m_lastOriginal = 0;
+    };
+
+    // Renumbers subjects and articles of a document to 1..n in their order, so tables
+    // indexed by subject id stay small and sparse appearance rows keep 16-bit ids, and
+    // keeps the way back to the ids of the file. Maps keyed by id still hold full-width
+    // ids. Gaps left by removed articles are closed on the next load
+    class IdRemap {
+    public:
+        static IdRemap compact(Data& data);
+
+        // puts back the original ids
+        void restore(Data& data) const;
+
+        IdTable<Subject> subjects;
+        IdTable<Article> articles;
+    };
+}
+
+#endif // IDREMAP_H
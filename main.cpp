@@ -1,11 +1,28 @@
 #include "mainwindow.h"
+#include "service/scoringservice.h"
+#include "service/scoringclient.h"
+#include "diagnostics/tracer.h"
 
 #include <QApplication>
+#include <QFile>
 #include <QLocale>
 #include <QTranslator>
 
+#include <optional>
+#include <string_view>
+
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && std::string_view(argv[1]) == "--serve") {
+        QCoreApplication a(argc, argv);
+        return ts::service::ScoringService::runFromCommandLine(a.arguments());
+    }
+
+    if (argc > 1 && std::string_view(argv[1]) == "--load-test") {
+        QCoreApplication a(argc, argv);
+        return ts::service::ScoringClient::runLoadTest(a.arguments());
+    }
+
     QApplication a(argc, argv);
 
     QTranslator translator;
@@ -17,6 +34,45 @@ int main(int argc, char *argv[])
             break;
         }
     }
+
+    // "--trace" or "--trace=<path>", the path is never taken from the next argument
+    const auto tracePath = [&]() -> std::optional<QString> {
+        const QString option = "--trace";
+
+        for (const auto& argument : a.arguments()) {
+            if (argument == option || argument == option + "=") {
+                return QString("trace.json");
+            }
+            if (argument.startsWith(option + "=")) {
+                return argument.mid(option.size() + 1);
+            }
+        }
+
+        return std::nullopt;
+    }();
+
+#ifndef TS_ENABLE_PROFILING
+    if (tracePath) {
+        qWarning("--trace needs a build with TS_ENABLE_PROFILING, no trace is recorded");
+    }
+#else
+    if (tracePath) {
+        ts::diagnostics::Tracer::instance().start();
+
+        QObject::connect(&a, &QCoreApplication::aboutToQuit, [path = tracePath.value()]() {
+            if (!ts::diagnostics::Tracer::isEnabled()) {
+                return;
+            }
+
+            QFile traceFile(path);
+
+            if (traceFile.open(QIODevice::WriteOnly)) {
+                traceFile.write(ts::diagnostics::Tracer::instance().stop());
+            }
+        });
+    }
+#endif
+
     MainWindow w;
     w.show();
     return a.exec();
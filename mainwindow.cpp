@@ -5,11 +5,25 @@
 
 #include "formats/jsonformat.h"
 #include "formats/csvformat.h"
+#include "subjectorder.h"
+#include "documentloader.h"
 
+#include <QApplication>
+#include <QElapsedTimer>
 #include <QFileDialog>
+#include <QFileInfo>
+#include <QFutureWatcher>
 #include <QMessageBox>
+#include <QSignalBlocker>
+#include <QtConcurrent/QtConcurrentRun>
+#include <stdexcept>
 #include "view/itemdelegate.h"
+#include "view/diagnosticsdock.h"
+#include "diagnostics/profiler.h"
 #include "dialogs/subjecteditdialog.h"
+#include "dialogs/comparisondialog.h"
+#include "dialogs/scoringpolicydialog.h"
+#include "dialogs/subjectorderdialog.h"
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -17,6 +31,30 @@ MainWindow::MainWindow(QWidget *parent)
 {
     ui->setupUi(this);
 
+    m_filterModel = new ArticleFilterProxyModel(this);
+    ui->tableView->setModel(m_filterModel);
+
+    auto diagnosticsDock = new DiagnosticsDock(this);
+    addDockWidget(Qt::BottomDockWidgetArea, diagnosticsDock);
+    diagnosticsDock->hide();
+    ui->menuView->addAction(diagnosticsDock->toggleViewAction());
+    diagnosticsDock->setMemoryUsageProvider([this]() {
+        return m_dataModel ? m_dataModel->memoryUsage() : std::vector<ts::diagnostics::MemoryUsage>();
+    });
+
+    {
+        const QSignalBlocker blocker(ui->actionRecord_Trace);
+        ui->actionRecord_Trace->setChecked(ts::diagnostics::Tracer::isEnabled());
+    }
+#ifndef TS_ENABLE_PROFILING
+    ui->actionRecord_Trace->setEnabled(false);
+#endif
+
+    {
+        const QSignalBlocker blocker(ui->actionCompact_Ids);
+        ui->actionCompact_Ids->setChecked(m_settings.value("compactIds", false).toBool());
+    }
+
     auto filePath = m_settings.value("filePath");
     if (filePath.isNull() || !openFile(filePath.toString())) {
         emit modelReady(false);
@@ -36,8 +74,9 @@ void MainWindow::C_nu_changed(std::optional<float> C_nu)
 
 void MainWindow::newFile()
 {
-    ui->tableView->setModel(nullptr);
+    m_filterModel->setSourceModel(nullptr);
     m_dataModel.reset();
+    m_journal.reset();
     m_filePath.reset();
     m_settings.remove("filePath");
 
@@ -46,8 +85,10 @@ void MainWindow::newFile()
 
 void MainWindow::saveFile()
 {
+    TS_PROFILE_SCOPE("MainWindow::saveFile");
+
     if (!m_filePath) {
-        auto filePath = QFileDialog::getSaveFileName(this, "Save File", m_filePath.value_or(QString()), "Json (*.json)");
+        auto filePath = askSaveFilePath();
 
         if (filePath.isEmpty()) {
             return;
@@ -57,42 +98,52 @@ void MainWindow::saveFile()
         m_settings.setValue("filePath", filePath);
     }
 
-    QFile saveFile(m_filePath.value());
-
-    if (!saveFile.open(QIODevice::WriteOnly)) {
-        QMessageBox::critical(this, tr("Save file"), "Can't access file");
-
-        return;
-    }
-
-    saveFile.write(ts::formats::JsonFormat().exportData(m_dataModel->getData()));
+    writeFile();
 }
 
 void MainWindow::saveFileAs()
 {
-    auto filePath = QFileDialog::getSaveFileName(this, "Save File", m_filePath.value_or(QString()), "Json (*.json)");
+    TS_PROFILE_SCOPE("MainWindow::saveFileAs");
+
+    auto filePath = askSaveFilePath();
 
     if (filePath.isEmpty()) {
         return;
     }
 
+    // the edits go to the new file, the old one stays as it was last saved
+    if (m_journal) {
+        m_dataModel->setJournal(nullptr);
+        m_journal->discardUncommitted();
+        m_journal.reset();
+    }
+
     m_filePath = filePath;
     m_settings.setValue("filePath", filePath);
 
-    QFile saveFile(m_filePath.value());
+    writeFile();
+}
 
-    if (!saveFile.open(QIODevice::WriteOnly)) {
-        QMessageBox::critical(this, tr("Save file"), "Can't access file");
+QString MainWindow::askSaveFilePath()
+{
+    // v2 is smaller and faster to load, but releases before it can't open the document
+    const QString jsonFilter = "Json (*.json)";
+    const QString compactJsonFilter = "Compact json, v2 (*.json)";
 
-        return;
+    auto selectedFilter = m_settings.value("jsonVersion", 1).toInt() == 2 ? compactJsonFilter : jsonFilter;
+    auto filePath = QFileDialog::getSaveFileName(this, "Save File", m_filePath.value_or(QString()),
+                                                 jsonFilter + ";;" + compactJsonFilter + ";;Compressed document (*.tsz)", &selectedFilter);
+
+    if (!filePath.isEmpty() && !filePath.endsWith(".tsz", Qt::CaseInsensitive)) {
+        m_settings.setValue("jsonVersion", selectedFilter == compactJsonFilter ? 2 : 1);
     }
 
-    saveFile.write(ts::formats::JsonFormat().exportData(m_dataModel->getData()));
+    return filePath;
 }
 
 void MainWindow::openFile()
 {
-    auto filePath = QFileDialog::getOpenFileName(this, "Open File", m_filePath.value_or(QString()), "Json (*.json)");
+    auto filePath = QFileDialog::getOpenFileName(this, "Open File", m_filePath.value_or(QString()), "Documents (*.json *.tsz)");
 
     if (filePath.isEmpty()) {
         return;
@@ -123,12 +174,13 @@ void MainWindow::addNewSubject()
         newSubjects.reserve(subjectNames.size());
 
         auto idGenerator = ts::IdGenerator<ts::Subject>{};
+        auto strings = std::make_shared<ts::StringPool>();
 
-        for (auto& subjectName : subjectNames) {
-            newSubjects.push_back(ts::Subject{ .id = idGenerator.newId(), .name = std::move(subjectName).toStdString() });
+        for (const auto& subjectName : subjectNames) {
+            newSubjects.push_back(ts::Subject{ .id = idGenerator.newId(), .name = strings->intern(subjectName) });
         }
 
-        auto data = ts::VerifiedData::initializeWithDefaults(std::move(newSubjects), {}).value();
+        auto data = ts::VerifiedData::initializeWithDefaults(std::move(newSubjects), {}, std::move(strings)).value();
 
         setNewModel(std::make_unique<DataModel>(ts::ComputedDataModel::compute(std::move(data))));
     } else {
@@ -141,7 +193,7 @@ void MainWindow::addNewSubject()
 void MainWindow::addNewArticle()
 {
     if (!m_dataModel) {
-        throw std::exception("Model is not ready");
+        throw std::runtime_error("Model is not ready");
     }
 
     AddNewSubjectDialog dialog("Articles");
@@ -150,20 +202,20 @@ void MainWindow::addNewArticle()
         return;
     }
 
-    auto articleNames = dialog.getSubjectNames();
+    const auto articleNames = dialog.getNames();
 
-    if (articleNames.empty()) {
+    if (articleNames.names().empty()) {
         return;
     }
 
-    for (auto& articleName : articleNames) {
-        m_dataModel->addArticle(std::move(articleName).toStdString());
-    }
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    m_dataModel->addArticles(articleNames.names());
+    QApplication::restoreOverrideCursor();
 }
 
 void MainWindow::toggleSubjects()
 {
-    m_dataModel->toggleWholeRow(ui->tableView->currentIndex());
+    m_dataModel->toggleWholeRow(m_filterModel->mapToSource(ui->tableView->currentIndex()));
 }
 
 void MainWindow::sort()
@@ -202,17 +254,32 @@ void MainWindow::removeArticle()
         return;
     }
 
-    const auto currentIndex = ui->tableView->currentIndex();
+    // every row with a selected cell, the current one when nothing is selected
+    std::vector<int> rows;
 
-    if (!currentIndex.isValid()) {
-        return;
+    for (const auto& index : ui->tableView->selectionModel()->selectedIndexes()) {
+        if (const auto sourceIndex = m_filterModel->mapToSource(index); sourceIndex.isValid()) {
+            rows.push_back(sourceIndex.row());
+        }
     }
 
-    m_dataModel->removeArticle(currentIndex.row());
+    if (rows.empty()) {
+        const auto currentIndex = m_filterModel->mapToSource(ui->tableView->currentIndex());
+
+        if (!currentIndex.isValid()) {
+            return;
+        }
+
+        rows.push_back(currentIndex.row());
+    }
+
+    m_dataModel->removeArticles(std::move(rows));
 }
 
 void MainWindow::exportData()
 {
+    TS_PROFILE_SCOPE("MainWindow::exportData");
+
     auto filePath = QFileDialog::getSaveFileName(this, "Save File", QString(), "Csv (*.csv)");
 
     if (filePath.isEmpty()) {
@@ -230,18 +297,230 @@ void MainWindow::exportData()
     saveFile.write(ts::formats::CsvFormat().exportData(m_dataModel->getData()));
 }
 
+void MainWindow::importData()
+{
+    TS_PROFILE_SCOPE("MainWindow::importData");
+
+    auto filePath = QFileDialog::getOpenFileName(this, "Import File", QString(), "Csv (*.csv)");
+
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    auto data = ts::formats::CsvFormat().importFile(filePath);
+    QApplication::restoreOverrideCursor();
+
+    if (!data) {
+        QMessageBox::critical(this, tr("Import file"), QString::fromStdString(data.error()));
+
+        return;
+    }
+
+    // the imported table is a new document, it is saved under a new name
+    if (m_dataModel) {
+        m_dataModel->setJournal(nullptr);
+    }
+    m_journal.reset();
+    m_filePath.reset();
+    m_settings.remove("filePath");
+
+    setNewModel(std::make_unique<DataModel>(ts::ComputedDataModel::compute(std::move(data).value())));
+}
+
+void MainWindow::showSensitivityMap(bool enabled)
+{
+    if (!m_dataModel) {
+        return;
+    }
+
+    m_dataModel->setSensitivityOverlay(enabled);
+}
+
+void MainWindow::optimizeSubjectOrder()
+{
+    if (!m_dataModel) {
+        return;
+    }
+
+    SubjectOrderDialog dialog(m_dataModel->getSubjects(), this);
+
+    if (dialog.exec() == QDialog::Rejected) {
+        return;
+    }
+
+    using Result = tl::expected<ts::algorithm::SubjectOrderResult, std::string>;
+
+    const auto subjectIdsOf = [](const std::vector<ts::Subject>& subjects) {
+        std::vector<ts::Subject::Id> res;
+        res.reserve(subjects.size());
+
+        for (const auto& subject : subjects) {
+            res.push_back(subject.id);
+        }
+
+        return res;
+    };
+
+    auto subjectIds = subjectIdsOf(m_dataModel->getSubjects());
+    const auto objective = dialog.getOptions().objective;
+
+    ui->actionOptimize_Subject_Order->setEnabled(false);
+    ui->statusbar->showMessage(tr("Optimizing subject order..."));
+
+    auto watcher = new QFutureWatcher<Result>(this);
+
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, subjectIds = std::move(subjectIds), objective, subjectIdsOf]() {
+        watcher->deleteLater();
+
+        ui->actionOptimize_Subject_Order->setEnabled(bool(m_dataModel));
+        ui->statusbar->clearMessage();
+
+        auto res = watcher->result();
+
+        if (!res) {
+            QMessageBox::critical(this, tr("Optimize subject order"), QString::fromStdString(res.error()));
+
+            return;
+        }
+
+        // the order found is a permutation of the subjects the optimizer started from
+        if (!m_dataModel || subjectIdsOf(m_dataModel->getSubjects()) != subjectIds) {
+            QMessageBox::warning(this, tr("Optimize subject order"), tr("The subjects were changed during the optimization, the order found is dropped"));
+
+            return;
+        }
+
+        const auto formatC_nu = [](std::optional<float> C_nu) {
+            return C_nu ? QString::number(C_nu.value(), 'f', 2) : QString("N/A");
+        };
+
+        auto message = tr("C_nu: %1 -> %2").arg(formatC_nu(m_dataModel->getC_nu()), formatC_nu(res.value().C_nu));
+
+        if (objective == ts::algorithm::SubjectOrderObjective::MinimizeHPercentile) {
+            message += tr("\nh percentile: %1").arg(res.value().hPercentile, 0, 'f', 2);
+        }
+
+        const auto answer = QMessageBox::question(this, tr("Optimize subject order"), message + tr("\nApply the new subject order?"));
+
+        if (answer != QMessageBox::Yes) {
+            return;
+        }
+
+        m_dataModel->setSubjects(std::move(res).value().subjects);
+    });
+
+    watcher->setFuture(QtConcurrent::run([data = m_dataModel->getData().getData(), constraints = dialog.getConstraints(), options = dialog.getOptions()]() -> Result {
+        TS_PROFILE_SCOPE("MainWindow::optimizeSubjectOrder");
+
+        return ts::algorithm::optimizeSubjectOrder(data.data(), constraints, options);
+    }));
+}
+
+void MainWindow::editScoringPolicy()
+{
+    if (!m_dataModel) {
+        return;
+    }
+
+    ScoringPolicyDialog dialog(m_dataModel->getScoringPolicy(), this);
+
+    if (dialog.exec() == QDialog::Rejected) {
+        return;
+    }
+
+    const auto policy = dialog.getScoringPolicy();
+
+    if (policy == m_dataModel->getScoringPolicy()) {
+        return;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    m_dataModel->setScoringPolicy(policy);
+    QApplication::restoreOverrideCursor();
+}
+
+void MainWindow::compareDocuments()
+{
+    const auto filePaths = QFileDialog::getOpenFileNames(this, "Compare Documents", m_filePath.value_or(QString()), "Documents (*.json *.tsz)");
+
+    if (filePaths.isEmpty()) {
+        return;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    auto loadedDocuments = ts::loadDocuments(filePaths);
+    QApplication::restoreOverrideCursor();
+
+    std::vector<ComparisonDataModel::Document> documents;
+    QStringList errors;
+
+    for (auto& [filePath, model] : loadedDocuments) {
+        if (!model) {
+            errors << QFileInfo(filePath).fileName() + ": " + QString::fromStdString(model.error());
+            continue;
+        }
+
+        documents.push_back(ComparisonDataModel::Document { .name = QFileInfo(filePath).fileName(), .model = std::move(model).value() });
+    }
+
+    if (!errors.isEmpty()) {
+        QMessageBox::warning(this, tr("Compare documents"), errors.join('\n'));
+    }
+
+    if (documents.empty()) {
+        return;
+    }
+
+    ComparisonDialog dialog(std::move(documents), this);
+
+    dialog.exec();
+}
+
+void MainWindow::recordTrace(bool enabled)
+{
+    if (enabled) {
+        ts::diagnostics::Tracer::instance().start();
+
+        return;
+    }
+
+    const auto trace = ts::diagnostics::Tracer::instance().stop();
+
+    auto filePath = QFileDialog::getSaveFileName(this, "Save Trace", QString(), "Chrome Trace (*.json)");
+
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    QFile saveFile(filePath);
+
+    if (!saveFile.open(QIODevice::WriteOnly)) {
+        QMessageBox::critical(this, tr("Save file"), "Can't access file");
+
+        return;
+    }
+
+    saveFile.write(trace);
+}
+
+void MainWindow::setCompactIds(bool enabled)
+{
+    m_settings.setValue("compactIds", enabled);
+}
+
 void MainWindow::onCellClicked(QModelIndex index)
 {
     if (!m_dataModel) {
         return;
     }
 
-    m_dataModel->toggleAppearance(index);
+    m_dataModel->toggleAppearance(m_filterModel->mapToSource(index));
 }
 
 void MainWindow::onCustomContextMenuRequested(QPoint point)
 {
-    const auto index = ui->tableView->indexAt(point);
+    const auto index = m_filterModel->mapToSource(ui->tableView->indexAt(point));
 
     if (!index.isValid()) {
         return;
@@ -252,11 +531,35 @@ void MainWindow::onCustomContextMenuRequested(QPoint point)
 
 void MainWindow::setNewModel(std::unique_ptr<DataModel> model)
 {
-    ui->tableView->setModel(nullptr);
+    TS_PROFILE_SCOPE("MainWindow::setNewModel");
+
+    m_filterModel->setSourceModel(nullptr);
+    m_filterModel->setArticleFilter(std::nullopt);
     m_dataModel = std::move(model);
-    ui->tableView->setModel(m_dataModel.get());
+    m_journal.reset();
+    m_filterModel->setSourceModel(m_dataModel.get());
 
     connect(m_dataModel.get(), &DataModel::C_nu_changed, this, &MainWindow::C_nu_changed);
+    connect(m_dataModel.get(), &DataModel::searchIndexReady, this, &MainWindow::updateSearch);
+    connect(m_dataModel.get(), &DataModel::rowsInserted, this, &MainWindow::updateSearch);
+    connect(m_dataModel.get(), &DataModel::rowsRemoved, this, &MainWindow::updateSearch);
+    connect(m_dataModel.get(), &DataModel::rowsInserted, this, &MainWindow::updateQuery);
+    connect(m_dataModel.get(), &DataModel::rowsRemoved, this, &MainWindow::updateQuery);
+    connect(m_dataModel.get(), &DataModel::columnsInserted, this, &MainWindow::updateQuery);
+    connect(m_dataModel.get(), &DataModel::dataChanged, this, [this](const QModelIndex& topLeft, const QModelIndex& bottomRight) {
+        // only the name column affects the search hits, and every other one the query hits
+        if (topLeft.column() == 0) {
+            updateSearch();
+        }
+        if (bottomRight.column() > 0) {
+            updateQuery();
+        }
+    });
+
+    m_dataModel->buildSearchIndex();
+    updateQuery();
+
+    m_dataModel->setSensitivityOverlay(ui->actionSensitivity_Map->isChecked());
 
     emit modelReady(true);
     C_nu_changed(m_dataModel->getC_nu());
@@ -264,31 +567,59 @@ void MainWindow::setNewModel(std::unique_ptr<DataModel> model)
 
 bool MainWindow::openFile(const QString& filePath)
 {
-    QFile openFile(filePath);
+    TS_PROFILE_SCOPE("MainWindow::openFile");
 
-    if (!openFile.open(QIODevice::ReadOnly)) {
-        QMessageBox::critical(this, tr("Open file"), tr("Can't open file"));
+    // with compact ids the document is edited on dense ids, they are mapped back when it is saved
+    const auto ids = m_settings.value("compactIds", false).toBool() ? ts::IdMode::Compact : ts::IdMode::Original;
+
+    auto model = ts::loadDocument(filePath, ids);
+
+    if (!model) {
+        QMessageBox::critical(this, tr("Open file"), QString::fromStdString(model.error()));
 
         return false;
     }
 
-    auto fileData = openFile.readAll();
+    // the journal of the current document may be the one about to be opened
+    if (m_dataModel) {
+        m_dataModel->setJournal(nullptr);
+    }
+    m_journal.reset();
 
-    if (fileData.isEmpty()) {
-        QMessageBox::critical(this, tr("Open file"), tr("File is empty or unexpected error occured"));
+    auto journal = ts::EditJournal::open(filePath);
 
-        return false;
-    }
+    if (journal && journal.value()->uncommittedCount() > 0) {
+        auto recovered = false;
 
-    auto data = ts::formats::JsonFormat().importData(fileData);
+        if (QMessageBox::question(this, tr("Open file"), tr("The document has unsaved changes left from a previous session. Recover them?")) == QMessageBox::Yes) {
+            if (auto replayed = journal.value()->recover(model.value()); !replayed) {
+                QMessageBox::warning(this, tr("Open file"), QString::fromStdString(replayed.error()));
 
-    if (!data) {
-        QMessageBox::critical(this, tr("Open file"), QString::fromStdString("Can't open file, file corrupted: " + data.error()));
+                // the records before the one that failed are applied already, so the
+                // document is read again as it was saved
+                model = ts::loadDocument(filePath, ids);
 
-        return false;
+                if (!model) {
+                    QMessageBox::critical(this, tr("Open file"), QString::fromStdString(model.error()));
+
+                    return false;
+                }
+            } else {
+                recovered = true;
+            }
+        }
+
+        if (!recovered) {
+            journal.value()->discardUncommitted();
+        }
     }
 
-    setNewModel(std::make_unique<DataModel>(ts::ComputedDataModel::compute(std::move(data).value())));
+    setNewModel(std::make_unique<DataModel>(std::move(model).value()));
+
+    if (journal && journal.value()) {
+        m_journal = std::move(journal).value();
+        m_dataModel->setJournal(m_journal.get());
+    }
 
     m_settings.setValue("filePath", filePath);
     m_filePath = filePath;
@@ -296,3 +627,182 @@ bool MainWindow::openFile(const QString& filePath)
     return true;
 }
 
+void MainWindow::searchArticles(const QString& query)
+{
+    updateSearch();
+
+    if (!ui->filterCheckBox->isChecked() && !query.isEmpty() && !m_searchHits.empty()) {
+        m_currentSearchHit = 0;
+        selectArticle(m_searchHits.front());
+    }
+}
+
+void MainWindow::findNextArticle()
+{
+    if (m_searchHits.empty()) {
+        return;
+    }
+
+    m_currentSearchHit = (m_currentSearchHit + 1) % m_searchHits.size();
+
+    selectArticle(m_searchHits[m_currentSearchHit]);
+}
+
+void MainWindow::filterArticles(bool enabled)
+{
+    updateSearch();
+}
+
+void MainWindow::queryArticles()
+{
+    updateQuery();
+}
+
+void MainWindow::onQueryTextChanged(const QString& text)
+{
+    // a query runs on Enter, clearing it drops the filter right away
+    if (text.isEmpty() && m_queryHits) {
+        updateQuery();
+    }
+}
+
+void MainWindow::updateSearch()
+{
+    if (!m_dataModel) {
+        return;
+    }
+
+    const auto query = ui->searchLineEdit->text();
+
+    if (query.isEmpty()) {
+        m_searchHits.clear();
+        applyArticleFilter();
+        ui->statusbar->clearMessage();
+
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    auto hits = m_dataModel->searchArticles(query);
+
+    if (!hits) {
+        ui->statusbar->showMessage(tr("Building search index..."));
+
+        return;
+    }
+
+    m_searchHits = std::move(hits).value();
+    m_currentSearchHit = std::min(m_currentSearchHit, m_searchHits.empty() ? 0 : m_searchHits.size() - 1);
+
+    applyArticleFilter();
+
+    ui->statusbar->showMessage(tr("%n match(es) in %1 ms", nullptr, int(m_searchHits.size())).arg(timer.elapsed()));
+}
+
+void MainWindow::updateQuery()
+{
+    if (!m_dataModel) {
+        return;
+    }
+
+    const auto query = ui->queryLineEdit->text();
+
+    if (query.trimmed().isEmpty()) {
+        if (m_queryHits) {
+            m_queryHits.reset();
+            applyArticleFilter();
+        }
+
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    auto hits = m_dataModel->queryArticles(query);
+
+    if (!hits) {
+        m_queryHits.reset();
+        applyArticleFilter();
+
+        ui->statusbar->showMessage(QString::fromStdString(hits.error()));
+
+        return;
+    }
+
+    m_queryHits = std::move(hits).value();
+
+    applyArticleFilter();
+
+    ui->statusbar->showMessage(tr("%n article(s) match the query in %1 ms", nullptr, int(m_queryHits->size())).arg(timer.elapsed()));
+}
+
+void MainWindow::applyArticleFilter()
+{
+    std::optional<std::vector<ts::Article::Id>> filter;
+
+    if (ui->filterCheckBox->isChecked() && !ui->searchLineEdit->text().isEmpty()) {
+        filter = m_searchHits;
+    }
+
+    if (m_queryHits) {
+        if (filter) {
+            std::vector<ts::Article::Id> both;
+            std::set_intersection(filter->begin(), filter->end(), m_queryHits->begin(), m_queryHits->end(), std::back_inserter(both));
+            filter = std::move(both);
+        } else {
+            filter = m_queryHits;
+        }
+    }
+
+    m_filterModel->setArticleFilter(std::move(filter));
+}
+
+void MainWindow::selectArticle(ts::Article::Id articleId)
+{
+    const auto row = m_dataModel->getArticleRow(articleId);
+
+    if (!row) {
+        return;
+    }
+
+    const auto index = m_filterModel->mapFromSource(m_dataModel->index(row.value(), 0, QModelIndex()));
+
+    ui->tableView->setCurrentIndex(index);
+    ui->tableView->scrollTo(index);
+}
+
+void MainWindow::writeFile()
+{
+    TS_PROFILE_SCOPE("MainWindow::writeFile");
+
+    // while the journal is small a save only commits it, loaders apply it over the document
+    if (m_journal && !m_journal->needsCompaction() && m_journal->commit()) {
+        return;
+    }
+
+    QFile saveFile(m_filePath.value());
+
+    if (!saveFile.open(QIODevice::WriteOnly)) {
+        QMessageBox::critical(this, tr("Save file"), "Can't access file");
+
+        return;
+    }
+
+    const auto jsonVersion = m_settings.value("jsonVersion", 1).toInt() == 2 ? ts::formats::JsonFormat::Version::V2 : ts::formats::JsonFormat::Version::V1;
+    const auto snapshot = ts::saveDocument(m_dataModel->getData(), m_filePath.value(), jsonVersion);
+
+    saveFile.write(snapshot);
+    saveFile.close();
+
+    m_dataModel->setJournal(nullptr);
+    m_journal.reset();
+
+    if (auto journal = ts::EditJournal::create(m_filePath.value(), snapshot)) {
+        m_journal = std::move(journal).value();
+        m_dataModel->setJournal(m_journal.get());
+    }
+}
+
@@ -4,6 +4,8 @@
 #include <QMainWindow>
 
 #include "datamodel.h"
+#include "editjournal.h"
+#include "view/articlefilterproxymodel.h"
 #include <QSettings>
 
 QT_BEGIN_NAMESPACE
@@ -40,6 +42,25 @@ public slots:
 
     void exportData();
 
+    void importData();
+
+    void showSensitivityMap(bool enabled);
+
+    void optimizeSubjectOrder();
+
+    void editScoringPolicy();
+
+    void compareDocuments();
+
+    void recordTrace(bool enabled);
+    void setCompactIds(bool enabled);
+
+    void searchArticles(const QString& query);
+    void findNextArticle();
+    void filterArticles(bool enabled);
+    void queryArticles();
+    void onQueryTextChanged(const QString& text);
+
     void onCellClicked(QModelIndex index);
     void onCustomContextMenuRequested(QPoint point);
 
@@ -52,9 +73,31 @@ private:
 
     bool openFile(const QString& filePath);
 
+    // Commits the journal, or rewrites the whole document and starts a new journal over
+    // it once the journal has grown
+    void writeFile();
+    // empty when the dialog is cancelled, remembers the JSON version picked by its filter
+    QString askSaveFilePath();
+
+    // reruns the search bar query, e.g. after articles were added or renamed
+    void updateSearch();
+    // reruns the appearance query, its hits depend on every cell
+    void updateQuery();
+    // shows the search hits when filtering by them, narrowed down to the query hits
+    void applyArticleFilter();
+    void selectArticle(ts::Article::Id articleId);
+
     Ui::MainWindow *ui;
 
+    // declared before the model, so the model never outlives the journal it records to
+    std::unique_ptr<ts::EditJournal> m_journal;
     std::unique_ptr<DataModel> m_dataModel;
+    ArticleFilterProxyModel* m_filterModel;
+
+    std::vector<ts::Article::Id> m_searchHits;
+    std::size_t m_currentSearchHit = 0;
+    // std::nullopt without a query
+    std::optional<std::vector<ts::Article::Id>> m_queryHits;
 
     std::optional<QString> m_filePath;
 
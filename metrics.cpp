@@ -0,0 +1,137 @@
+#include "metrics.h"
+#include "diagnostics/memoryusage.h"
+
+using namespace ts;
+using namespace ts::algorithm;
+
+MetricRegistry& MetricRegistry::instance()
+{
+    static MetricRegistry registry;
+
+    return registry;
+}
+
+MetricRegistry::MetricRegistry()
+{
+    add(Metric {
+        .name = "Span",
+        .finish = [](const MetricState&, const RowSummary& row) {
+            return float(row.i_max - row.t_p + 1);
+        }
+    });
+
+    add(Metric {
+        .name = "Dots",
+        .finish = [](const MetricState&, const RowSummary& row) {
+            return float(row.dots);
+        }
+    });
+
+    add(Metric {
+        .name = "Gaps",
+        .visit = [](MetricState& state, const DotVisit& dot) {
+            state.values[0] += dot.gap > 0 ? 1 : 0;
+        },
+        .finish = [](const MetricState& state, const RowSummary&) {
+            return float(state.values[0]);
+        }
+    });
+
+    add(Metric {
+        .name = "Mean gap",
+        .visit = [](MetricState& state, const DotVisit& dot) {
+            if (dot.gap > 0) {
+                state.values[0] += dot.gap;
+                state.values[1]++;
+            }
+        },
+        .finish = [](const MetricState& state, const RowSummary&) {
+            return state.values[1] > 0 ? float(state.values[0] / state.values[1]) : 0.f;
+        }
+    });
+}
+
+void MetricRegistry::add(Metric metric)
+{
+    m_metrics.push_back(std::move(metric));
+}
+
+const std::vector<Metric>& MetricRegistry::metrics() const noexcept
+{
+    return m_metrics;
+}
+
+MetricTable::MetricTable(std::size_t metricsCount, std::pmr::memory_resource* resource) : m_slots(resource)
+{
+    m_columns.reserve(metricsCount);
+
+    for (auto i = 0u; i < metricsCount; i++) {
+        m_columns.emplace_back(resource);
+    }
+}
+
+std::size_t MetricTable::metricsCount() const noexcept
+{
+    return m_columns.size();
+}
+
+void MetricTable::set(Article::Id articleId, std::span<const float> values)
+{
+    auto iter = m_slots.find(articleId);
+
+    if (iter == m_slots.end()) {
+        auto slot = m_columns.empty() ? 0 : m_columns.front().size();
+
+        if (!m_freeSlots.empty()) {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        } else {
+            for (auto& column : m_columns) {
+                column.push_back(0);
+            }
+        }
+
+        iter = m_slots.emplace(articleId, slot).first;
+    }
+
+    for (auto i = 0u; i < m_columns.size(); i++) {
+        m_columns[i][iter->second] = values[i];
+    }
+}
+
+void MetricTable::erase(Article::Id articleId)
+{
+    auto iter = m_slots.find(articleId);
+
+    if (iter == m_slots.end()) {
+        return;
+    }
+
+    m_freeSlots.push_back(iter->second);
+    m_slots.erase(iter);
+}
+
+float MetricTable::value(Article::Id articleId, std::size_t metric) const
+{
+    return m_columns.at(metric)[m_slots.at(articleId)];
+}
+
+std::size_t MetricTable::memoryUsage() const noexcept
+{
+    auto res = m_freeSlots.capacity() * sizeof(std::size_t) + m_slots.size() * diagnostics::treeNodeSize<std::pair<const Article::Id, std::size_t>>();
+
+    for (const auto& column : m_columns) {
+        res += column.capacity() * sizeof(float);
+    }
+
+    return res;
+}
+
+void MetricTable::abandon(DocumentMemory& memory) noexcept
+{
+    memory.abandon(m_slots);
+
+    for (auto& column : m_columns) {
+        memory.abandon(column);
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "algorithm.h"
+#include "documentmemory.h"
+
+#include <array>
+#include <span>
+
+namespace ts::algorithm {
+    // A dot of the row as seen by the scoring traversal, positions are 1-based
+    struct DotVisit {
+        int k = 0;
+        int a_l = 0;
+        int a_l_t = 0;
+        // empty positions between the previous dot and this one
+        int gap = 0;
+    };
+
+    struct RowSummary {
+        int subjectsCount = 0;
+        int t_p = 0;
+        int t_m = 0;
+        int i_max = 0;
+        int dots = 0;
+        ComputedData scores;
+    };
+
+    struct MetricState {
+        std::array<double, 4> values {};
+    };
+
+    // Extra per-article metric. It is evaluated in the same traversal as l, c and h:
+    // visit is called for every dot of the row and finish once at the end, either may be null
+    struct Metric {
+        std::string name;
+        void (*visit)(MetricState& state, const DotVisit& dot) = nullptr;
+        float (*finish)(const MetricState& state, const RowSummary& row) = nullptr;
+    };
+
+    class MetricRegistry {
+    public:
+        static MetricRegistry& instance();
+
+        // Not thread-safe, metrics are expected to be added at startup.
+        // Documents take the metrics registered at the moment they are computed
+        void add(Metric metric);
+
+        const std::vector<Metric>& metrics() const noexcept;
+
+    private:
+        MetricRegistry();
+
+        std::vector<Metric> m_metrics;
+    };
+
+    // Same as computeOuterLinks, and fills values with one value per metric in the same pass
+    ComputedData computeMetrics(const std::vector<Subject>& subjects, const SubjectPositions& positions, const FirstAppearanceMap& firstAppearance, const AppearanceMap& appearance, Article::Id articleId, const ScoringPolicy& policy, const std::vector<Metric>& metrics, std::span<float> values);
+
+    // Metric values of a document, stored column by column and addressed by article id
+    class MetricTable {
+    public:
+        MetricTable(std::size_t metricsCount, std::pmr::memory_resource* resource);
+
+        std::size_t metricsCount() const noexcept;
+
+        void set(Article::Id articleId, std::span<const float> values);
+        void erase(Article::Id articleId);
+
+        float value(Article::Id articleId, std::size_t metric) const;
+
+        std::size_t memoryUsage() const noexcept;
+
+        // see DocumentMemory::abandon
+        void abandon(DocumentMemory& memory) noexcept;
+
+    private:
+        std::pmr::map<Article::Id, std::size_t> m_slots;
+        std::vector<std::size_t> m_freeSlots;
+        std::vector<std::pmr::vector<float>> m_columns;
+    };
+}
+
+#endif // METRICS_H
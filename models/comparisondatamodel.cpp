@@ -0,0 +1,129 @@
+#include "comparisondatamodel.h"
+
+#include <QBrush>
+#include <QColor>
+
+ComparisonDataModel::ComparisonDataModel(std::vector<Document>&& documents, MatchBy matchBy)
+    : m_documents(std::move(documents)), m_matchBy(matchBy)
+{
+    matchArticles();
+}
+
+QVariant ComparisonDataModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    if (orientation == Qt::Vertical) {
+        return section + 1;
+    }
+
+    if (section == 0) {
+        return "Article Name";
+    }
+
+    const auto& document = m_documents.at((section - 1) / columnsPerDocument);
+    const auto C_nu = document.model.getC_nu();
+
+    static const char* metrics[] = { "L", "C", "h" };
+
+    return document.name + "\n" + "C_nu: " + (C_nu ? QString::number(C_nu.value(), 'f', 2) : QString("N/A")) + "\n" + metrics[(section - 1) % columnsPerDocument];
+}
+
+QModelIndex ComparisonDataModel::index(int row, int column, const QModelIndex &parent) const
+{
+    return createIndex(row, column);
+}
+
+QModelIndex ComparisonDataModel::parent(const QModelIndex &index) const
+{
+    return QModelIndex();
+}
+
+int ComparisonDataModel::rowCount(const QModelIndex &parent) const
+{
+    return int(m_rows.size());
+}
+
+int ComparisonDataModel::columnCount(const QModelIndex &parent) const
+{
+    return 1 + int(m_documents.size()) * columnsPerDocument;
+}
+
+QVariant ComparisonDataModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    const auto& row = m_rows[index.row()];
+
+    if (index.column() == 0) {
+        return role == Qt::DisplayRole ? QVariant(row.name) : QVariant();
+    }
+
+    const auto documentIndex = (index.column() - 1) / columnsPerDocument;
+    const auto& articleId = row.articles[documentIndex];
+
+    if (role == Qt::BackgroundRole) {
+        return articleId ? QVariant() : QBrush(QColor(Qt::lightGray));
+    }
+
+    if (role != Qt::DisplayRole || !articleId) {
+        return QVariant();
+    }
+
+    const auto& computedData = m_documents[documentIndex].model.getComputedDataForArticle(articleId.value());
+
+    switch ((index.column() - 1) % columnsPerDocument) {
+    case 0:
+        return QString::number(computedData.l, 'f', 2);
+    case 1:
+        return QString::number(computedData.c, 'f', 2);
+    default:
+        return QString::number(computedData.h, 'f', 2);
+    }
+}
+
+void ComparisonDataModel::setMatchBy(MatchBy matchBy)
+{
+    if (m_matchBy == matchBy) {
+        return;
+    }
+
+    beginResetModel();
+    m_matchBy = matchBy;
+    matchArticles();
+    endResetModel();
+}
+
+void ComparisonDataModel::matchArticles()
+{
+    m_rows.clear();
+
+    std::map<unsigned, std::size_t> rowsById;
+    std::map<std::string_view, std::size_t> rowsByName;
+
+    for (auto documentIndex = 0u; documentIndex < m_documents.size(); documentIndex++) {
+        for (const auto& article : m_documents[documentIndex].model.getArticles()) {
+            auto rowIndex = m_rows.size();
+
+            if (m_matchBy == MatchBy::Id) {
+                rowIndex = rowsById.try_emplace(unsigned(article.id), rowIndex).first->second;
+            } else {
+                rowIndex = rowsByName.try_emplace(article.name.view(), rowIndex).first->second;
+            }
+
+            if (rowIndex == m_rows.size()) {
+                m_rows.push_back(Row { .name = article.name.toQString(), .articles = std::vector<std::optional<ts::Article::Id>>(m_documents.size()) });
+            }
+
+            auto& articleId = m_rows[rowIndex].articles[documentIndex];
+
+            if (!articleId) {
+                articleId = article.id;
+            }
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef COMPARISONDATAMODEL_H
+#define COMPARISONDATAMODEL_H
+
+#include <QAbstractItemModel>
+#include <datamodel.h>
+
+class ComparisonDataModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    enum class MatchBy {
+        Id,
+        Name
+    };
+
+    struct Document {
+        QString name;
+        ts::ComputedDataModel model;
+    };
+
+    ComparisonDataModel(std::vector<Document>&& documents, MatchBy matchBy);
+
+    // Header:
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // Basic functionality:
+    QModelIndex index(int row, int column,
+                      const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    void setMatchBy(MatchBy matchBy);
+
+    static constexpr auto columnsPerDocument = 3;
+
+private:
+    struct Row {
+        QString name;
+        std::vector<std::optional<ts::Article::Id>> articles;
+    };
+
+    void matchArticles();
+
+    std::vector<Document> m_documents;
+    std::vector<Row> m_rows;
+    MatchBy m_matchBy;
+};
+
+#endif // COMPARISONDATAMODEL_H
@@ -55,7 +55,7 @@ QVariant SubjectsDataModel::data(const QModelIndex &index, int role) const
     }
 
     if (role == Qt::DisplayRole || role == Qt::EditRole) {
-        return QString::fromStdString(m_subjects[index.row()].name);
+        return m_subjects[index.row()].name.toQString();
     }
 
     return QVariant();
@@ -64,7 +64,7 @@ QVariant SubjectsDataModel::data(const QModelIndex &index, int role) const
 bool SubjectsDataModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
     if (role == Qt::EditRole) {
-        m_subjects[index.row()].name = value.toString().toStdString();
+        m_subjects[index.row()].name = m_strings->intern(value.toString());
 
         emit dataChanged(index, index, QVector<int> { role });
         return true;
@@ -123,7 +123,7 @@ void SubjectsDataModel::add(int index, std::vector<std::string>&& names)
     beginInsertRows(QModelIndex(), index + 1, index + int(names.size()));
 
     for (auto&& name : names) {
-        m_subjects.insert(m_subjects.begin() + (++index), ts::Subject{ .id = m_idGenerator.newId(), .name = std::move(name) });
+        m_subjects.insert(m_subjects.begin() + (++index), ts::Subject{ .id = m_idGenerator.newId(), .name = m_strings->intern(name) });
     }
 
     endInsertRows();
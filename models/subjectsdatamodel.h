@@ -39,6 +39,8 @@ public:
 private:
 
     std::vector<ts::Subject> m_subjects;
+    // names typed in the dialog, they are interned again by the document that takes the subjects
+    std::shared_ptr<ts::StringPool> m_strings = std::make_shared<ts::StringPool>();
     ts::IdGenerator<ts::Subject> m_idGenerator;
 };
 
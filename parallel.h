@@ -0,0 +1,38 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <QThread>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <vector>
+
+namespace ts::parallel {
+    // Calls func(i) for every i in [0, size) on the global thread pool, in contiguous chunks
+    template<typename F>
+    void forEachIndex(std::size_t size, F&& func)
+    {
+        const auto chunkCount = std::min<std::size_t>(size, std::size_t(std::max(1, QThread::idealThreadCount())) * 4);
+
+        if (chunkCount <= 1) {
+            for (auto i = std::size_t(0); i < size; i++) {
+                func(i);
+            }
+            return;
+        }
+
+        std::vector<std::pair<std::size_t, std::size_t>> chunks;
+        chunks.reserve(chunkCount);
+
+        for (auto i = std::size_t(0); i < chunkCount; i++) {
+            chunks.emplace_back(size * i / chunkCount, size * (i + 1) / chunkCount);
+        }
+
+        QtConcurrent::blockingMap(chunks, [&func](const std::pair<std::size_t, std::size_t>& chunk) {
+            for (auto i = chunk.first; i < chunk.second; i++) {
+                func(i);
+            }
+        });
+    }
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,37 @@
+#ifndef SCORINGPOLICY_H
+#define SCORINGPOLICY_H
+
+namespace ts {
+    enum class Normalization {
+        // c is divided by the number of subjects
+        Subjects,
+        // c is divided by the span from t_p to i_max
+        Span
+    };
+
+    enum class Arithmetic {
+        // the terms of c are summed in float as they come
+        Float,
+        // the terms of c are summed in fixed point, so scores and C_nu are bitwise the
+        // same however the work is split between threads
+        Exact
+    };
+
+    struct ScoringPolicy {
+        // a_l of a document of any size fits in an int with weights in this range
+        static constexpr int minWeight = 1;
+        static constexpr int maxWeight = 100;
+
+        // weights of positions before the first appearance and starting from it in a_l
+        int p_1 = 1;
+        int p_2 = 2;
+        Normalization normalization = Normalization::Subjects;
+        Arithmetic arithmetic = Arithmetic::Float;
+
+        static constexpr bool isValidWeight(int weight) noexcept { return weight >= minWeight && weight <= maxWeight; }
+
+        friend bool operator==(const ScoringPolicy&, const ScoringPolicy&) = default;
+    };
+}
+
+#endif // SCORINGPOLICY_H
@@ -0,0 +1,157 @@
+#include "sensitivity.h"
+#include <ranges>
+
+using namespace ts;
+using namespace ts::algorithm;
+
+std::vector<CellSensitivity> ts::algorithm::computeToggleSensitivity(const std::vector<Subject>& subjects, const FirstAppearanceMap& firstAppearance, const AppearanceMap& appearance, Article::Id articleId, const ScoringPolicy& policy)
+{
+    const auto& articleAppearance = appearance.at(articleId);
+
+    const auto firstAppearanceSubjectId = firstAppearance.at(articleId);
+
+    const auto size = int(subjects.size());
+
+    std::vector<CellSensitivity> res(subjects.size());
+
+    const auto t_m = int(std::distance(subjects.begin(), std::ranges::find(subjects, firstAppearanceSubjectId, &Subject::id))) + 1;
+
+    if (t_m > size) {
+        for (auto& cell : res) {
+            cell.allowed = false;
+        }
+
+        return res;
+    }
+
+    // Positions are 1-based, as t_p and t_m in computeOuterLinks
+    std::vector<char> isAppeared(size + 1);
+    std::vector<char> isDotSetted(size + 1);
+
+    for (auto k = 1; k <= size; k++) {
+        isAppeared[k] = articleAppearance.contains(subjects[k - 1].id);
+        isDotSetted[k] = isAppeared[k] || k == t_m;
+    }
+
+    auto t_p = t_m;
+    auto i_max = t_m;
+
+    for (auto k = 1; k <= size; k++) {
+        if (isDotSetted[k]) {
+            t_p = std::min(t_p, k);
+            i_max = k;
+        }
+    }
+
+    // empties[k] is the number of positions without a dot among 1..k
+    std::vector<int> empties(size + 1);
+
+    for (auto k = 1; k <= size; k++) {
+        empties[k] = empties[k - 1] + (isDotSetted[k] ? 0 : 1);
+    }
+
+    const auto r = [&](int i, int j) {
+        return empties[j] - empties[i];
+    };
+
+    const auto a_l = [&](int k, int from) {
+        return weightedDistance(k, from, t_m, policy.p_1, policy.p_2);
+    };
+
+    const auto term = [&](int k, int from, int emptiesBefore) {
+        const auto weight = a_l(k, from);
+        return double(weight - emptiesBefore) / double(weight);
+    };
+
+    // inverseSuffix[k] is the sum of 1 / a_l over dots at positions k..size: one more
+    // or one less empty cell before a dot changes its term by exactly 1 / a_l
+    std::vector<double> inverseSuffix(size + 2);
+    std::vector<int> previousDot(size + 1);
+
+    for (auto k = size; k >= 1; k--) {
+        inverseSuffix[k] = inverseSuffix[k + 1] + (isDotSetted[k] ? 1.0 / a_l(k, t_p) : 0.0);
+    }
+
+    for (auto k = 1, last = 0; k <= size; k++) {
+        previousDot[k] = last;
+        if (isDotSetted[k]) {
+            last = k;
+        }
+    }
+
+    auto sum = 0.0;
+
+    for (auto k = t_p; k <= size; k++) {
+        if (isDotSetted[k]) {
+            sum += term(k, t_p, r(t_p, k));
+        }
+    }
+
+    const auto score = [&](double dotsSum, int from, int to) {
+        const auto l = double(to - from + 1) / size;
+        const auto c = dotsSum / normalizationOf(policy.normalization, size, from, to);
+
+        return std::tuple(l, c, l * c);
+    };
+
+    const auto [l, c, h] = score(sum, t_p, i_max);
+
+    for (auto k = 1; k <= size; k++) {
+        auto& cell = res[k - 1];
+
+        if (k == t_m) {
+            cell.allowed = !(isAppeared[k] && articleAppearance.size() == 1);
+            continue;
+        }
+
+        auto newSum = sum;
+        auto newT_p = t_p;
+        auto newI_max = i_max;
+
+        if (isAppeared[k]) {
+            if (articleAppearance.size() == 1) {
+                cell.allowed = false;
+                continue;
+            }
+
+            if (k == t_p) {
+                newT_p = k + 1;
+                while (!isDotSetted[newT_p]) {
+                    newT_p++;
+                }
+
+                newSum = 0;
+                for (auto q = newT_p; q <= size; q++) {
+                    if (isDotSetted[q]) {
+                        newSum += term(q, newT_p, r(newT_p, q));
+                    }
+                }
+            } else {
+                newSum -= term(k, t_p, r(t_p, k)) + inverseSuffix[k + 1];
+                newI_max = k == i_max ? previousDot[k] : i_max;
+            }
+        } else {
+            if (k < t_p) {
+                newT_p = k;
+
+                newSum = term(k, k, 0);
+                for (auto q = t_p; q <= size; q++) {
+                    if (isDotSetted[q]) {
+                        newSum += term(q, k, r(t_p, q) + (t_p - k - 1));
+                    }
+                }
+            } else {
+                newSum += term(k, t_p, r(t_p, k - 1)) + inverseSuffix[k + 1];
+                newI_max = std::max(i_max, k);
+            }
+        }
+
+        const auto [newL, newC, newH] = score(newSum, newT_p, newI_max);
+
+        cell.l = float(newL - l);
+        cell.c = float(newC - c);
+        cell.h = float(newH - h);
+    }
+
+    return res;
+}
@@ -0,0 +1,20 @@
+#ifndef SENSITIVITY_H
+#define SENSITIVITY_H
+
+#include "algorithm.h"
+
+namespace ts::algorithm {
+    struct CellSensitivity {
+        float l = 0;
+        float c = 0;
+        float h = 0;
+        bool allowed = true;
+    };
+
+    // Score deltas of an article for toggling its dot at every subject position.
+    // The whole row is evaluated in O(S) from prefix/suffix sums, except for the
+    // positions before the first dot, which shift every weight and cost O(dots) each.
+    std::vector<CellSensitivity> computeToggleSensitivity(const std::vector<Subject>& subjects, const FirstAppearanceMap& firstAppearance, const AppearanceMap& appearance, Article::Id articleId, const ScoringPolicy& policy);
+}
+
+#endif // SENSITIVITY_H
@@ -0,0 +1,45 @@
+#include "documentcache.h"
+
+using namespace ts::service;
+
+DocumentCache::DocumentCache(std::size_t capacity) : m_capacity(std::max<std::size_t>(1, capacity))
+{
+
+}
+
+std::shared_ptr<ts::ComputedDataModel> DocumentCache::take(const QByteArray& key)
+{
+    auto iter = m_index.find(key);
+
+    if (iter == m_index.end()) {
+        return nullptr;
+    }
+
+    auto res = std::move(iter->second->second);
+
+    m_entries.erase(iter->second);
+    m_index.erase(iter);
+
+    return res;
+}
+
+void DocumentCache::put(const QByteArray& key, std::shared_ptr<ComputedDataModel> model)
+{
+    if (auto iter = m_index.find(key); iter != m_index.end()) {
+        m_entries.erase(iter->second);
+        m_index.erase(iter);
+    }
+
+    m_entries.emplace_front(key, std::move(model));
+    m_index.insert_or_assign(key, m_entries.begin());
+
+    while (m_entries.size() > m_capacity) {
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+}
+
+std::size_t DocumentCache::size() const noexcept
+{
+    return m_entries.size();
+}
@@ -0,0 +1,36 @@
+#ifndef DOCUMENTCACHE_H
+#define DOCUMENTCACHE_H
+
+#include "computeddatamodel.h"
+
+#include <QByteArray>
+
+#include <list>
+#include <map>
+#include <memory>
+
+namespace ts::service {
+    // Scored documents kept between requests by the hash of their state,
+    // the least recently used one is dropped when the cache is full
+    class DocumentCache {
+    public:
+        explicit DocumentCache(std::size_t capacity);
+
+        // The document leaves the cache, so that a single batch works on it at a time.
+        // nullptr when it isn't cached
+        std::shared_ptr<ComputedDataModel> take(const QByteArray& key);
+        void put(const QByteArray& key, std::shared_ptr<ComputedDataModel> model);
+
+        std::size_t size() const noexcept;
+
+    private:
+        using Entry = std::pair<QByteArray, std::shared_ptr<ComputedDataModel>>;
+
+        std::size_t m_capacity;
+        // the most recently used first
+        std::list<Entry> m_entries;
+        std::map<QByteArray, std::list<Entry>::iterator> m_index;
+    };
+}
+
+#endif // DOCUMENTCACHE_H
@@ -0,0 +1,55 @@
+#include "protocol.h"
+
+#include <QJsonDocument>
+#include <QtEndian>
+
+using namespace ts::service;
+
+QByteArray ts::service::frameOf(const QJsonObject& message)
+{
+    const auto payload = QJsonDocument(message).toJson(QJsonDocument::Compact);
+
+    QByteArray res(sizeof(quint32), Qt::Uninitialized);
+    qToBigEndian(quint32(payload.size()), res.data());
+
+    return res + payload;
+}
+
+void FrameReader::append(const QByteArray& data)
+{
+    m_buffer += data;
+}
+
+std::optional<tl::expected<QJsonObject, std::string>> FrameReader::next()
+{
+    if (m_buffer.size() < qsizetype(sizeof(quint32))) {
+        return std::nullopt;
+    }
+
+    const auto size = qFromBigEndian<quint32>(m_buffer.constData());
+
+    if (size > maxFrameSize) {
+        m_buffer.clear();
+
+        return tl::unexpected<std::string>("Message is too large");
+    }
+
+    if (m_buffer.size() - qsizetype(sizeof(quint32)) < qsizetype(size)) {
+        return std::nullopt;
+    }
+
+    QJsonParseError error;
+    const auto document = QJsonDocument::fromJson(m_buffer.mid(sizeof(quint32), size), &error);
+
+    m_buffer.remove(0, sizeof(quint32) + size);
+
+    if (error.error != QJsonParseError::NoError) {
+        return tl::unexpected("Message is not valid JSON: " + error.errorString().toStdString());
+    }
+
+    if (!document.isObject()) {
+        return tl::unexpected<std::string>("Message must be a JSON object");
+    }
+
+    return document.object();
+}
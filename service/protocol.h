@@ -0,0 +1,33 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include "libs/expected/include/tl/expected.hpp"
+
+#include <QByteArray>
+#include <QJsonObject>
+
+#include <optional>
+
+namespace ts::service {
+    inline constexpr char defaultServerName[] = "TeachingScoresService";
+
+    // Every message is a big-endian quint32 size followed by a compact JSON object
+    QByteArray frameOf(const QJsonObject& message);
+
+    // Collects the bytes of a stream until whole frames are available
+    class FrameReader {
+    public:
+        static constexpr quint32 maxFrameSize = 1u << 30;
+
+        void append(const QByteArray& data);
+
+        // std::nullopt until the next frame has fully arrived. After an error the
+        // stream can't be resynchronized and the connection is to be closed
+        std::optional<tl::expected<QJsonObject, std::string>> next();
+
+    private:
+        QByteArray m_buffer;
+    };
+}
+
+#endif // PROTOCOL_H
@@ -0,0 +1,157 @@
+#include "scoringclient.h"
+#include "documentloader.h"
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+
+using namespace ts::service;
+
+tl::expected<void, std::string> ScoringClient::connectToServer(const QString& name, int timeoutMs)
+{
+    m_socket.connectToServer(name);
+
+    if (!m_socket.waitForConnected(timeoutMs)) {
+        return tl::unexpected("Can't connect to " + name.toStdString() + ": " + m_socket.errorString().toStdString());
+    }
+
+    return {};
+}
+
+tl::expected<QJsonObject, std::string> ScoringClient::call(const QJsonObject& request, int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    if (m_socket.write(frameOf(request)) < 0) {
+        return tl::unexpected("Can't send the request: " + m_socket.errorString().toStdString());
+    }
+
+    while (m_socket.bytesToWrite() > 0) {
+        if (!m_socket.waitForBytesWritten(int(std::max<qint64>(1, timeoutMs - timer.elapsed())))) {
+            return tl::unexpected("Can't send the request: " + m_socket.errorString().toStdString());
+        }
+    }
+
+    while (true) {
+        if (auto response = m_reader.next()) {
+            return std::move(response).value();
+        }
+
+        const auto remaining = timeoutMs - timer.elapsed();
+
+        if (remaining <= 0 || !m_socket.waitForReadyRead(int(remaining))) {
+            return tl::unexpected("No response: " + m_socket.errorString().toStdString());
+        }
+
+        m_reader.append(m_socket.readAll());
+    }
+}
+
+QJsonValue ScoringClient::documentOf(const QByteArray& contents)
+{
+    // the service tells JSON from the chunked container by itself
+    return QString::fromLatin1(contents.toBase64());
+}
+
+int ScoringClient::runLoadTest(const QStringList& arguments)
+{
+    QTextStream out(stdout);
+
+    const auto loadTestIndex = arguments.indexOf("--load-test");
+    const auto documentPath = arguments.value(loadTestIndex + 1);
+    const auto name = arguments.value(loadTestIndex + 2, defaultServerName);
+    const auto connections = std::max(1, arguments.value(loadTestIndex + 3, "8").toInt());
+    const auto requestsPerConnection = std::max(1, arguments.value(loadTestIndex + 4, "200").toInt());
+
+    // with the saved edits of its journal, which the service doesn't read
+    const auto document = ts::loadDocument(documentPath);
+
+    if (!document) {
+        out << "can't open " << documentPath << ": " << QString::fromStdString(document.error()) << "\n";
+        return 1;
+    }
+
+    // the first request loads the document, the rest read it by the hash it got
+    ScoringClient client;
+
+    if (auto connected = client.connectToServer(name); !connected) {
+        out << QString::fromStdString(connected.error()) << "\n";
+        return 1;
+    }
+
+    const auto loaded = client.call(QJsonObject { { "id", 0 }, { "document", documentOf(ts::saveDocument(document.value(), documentPath)) } });
+
+    if (!loaded || loaded.value().contains("error")) {
+        out << "can't load the document: " << (loaded ? loaded.value()["error"].toString() : QString::fromStdString(loaded.error())) << "\n";
+        return 1;
+    }
+
+    const auto documentHash = loaded.value()["documentHash"].toString();
+
+    out << "document " << documentHash << " loaded in " << loaded.value()["timings"].toObject()["totalMs"].toDouble() << " ms\n";
+
+    std::vector<std::vector<double>> latencies(connections);
+    std::atomic<int> errors = 0;
+    std::atomic<qint64> batchSizes = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    std::vector<std::unique_ptr<QThread>> threads;
+
+    for (auto connection = 0; connection < connections; connection++) {
+        threads.emplace_back(QThread::create([&, connection]() {
+            ScoringClient client;
+
+            if (!client.connectToServer(name)) {
+                errors += requestsPerConnection;
+                return;
+            }
+
+            for (auto i = 0; i < requestsPerConnection; i++) {
+                QElapsedTimer requestTimer;
+                requestTimer.start();
+
+                const auto response = client.call(QJsonObject { { "id", connection * requestsPerConnection + i + 1 }, { "documentHash", documentHash } });
+
+                if (!response || response.value().contains("error")) {
+                    errors++;
+                    continue;
+                }
+
+                latencies[connection].push_back(double(requestTimer.nsecsElapsed()) / 1e6);
+                batchSizes += response.value()["batchSize"].toInt();
+            }
+        }));
+
+        threads.back()->start();
+    }
+
+    for (auto& thread : threads) {
+        thread->wait();
+    }
+
+    const auto elapsedMs = double(timer.nsecsElapsed()) / 1e6;
+
+    std::vector<double> all;
+    for (const auto& connectionLatencies : latencies) {
+        all.insert(all.end(), connectionLatencies.begin(), connectionLatencies.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    const auto percentile = [&](double p) {
+        return all.empty() ? 0. : all[std::min(all.size() - 1, std::size_t(p * double(all.size())))];
+    };
+
+    out << connections << " connections x " << requestsPerConnection << " requests in " << elapsedMs << " ms\n"
+        << "throughput " << double(all.size()) * 1000. / elapsedMs << " requests/s, " << errors << " errors\n"
+        << "latency p50 " << percentile(0.5) << " ms, p99 " << percentile(0.99) << " ms, max " << (all.empty() ? 0. : all.back()) << " ms\n"
+        << "mean batch size " << (all.empty() ? 0. : double(batchSizes) / double(all.size())) << "\n";
+
+    return errors == 0 ? 0 : 1;
+}
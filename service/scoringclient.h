@@ -0,0 +1,29 @@
+#ifndef SCORINGCLIENT_H
+#define SCORINGCLIENT_H
+
+#include "protocol.h"
+
+#include <QLocalSocket>
+
+namespace ts::service {
+    // Blocking client of ScoringService, usable from any thread without an event loop
+    class ScoringClient {
+    public:
+        tl::expected<void, std::string> connectToServer(const QString& name, int timeoutMs = 5000);
+
+        // Sends the request and waits for the next response on this connection
+        tl::expected<QJsonObject, std::string> call(const QJsonObject& request, int timeoutMs = 60000);
+
+        // document field of a request for the contents of a .json or .tsz file
+        static QJsonValue documentOf(const QByteArray& contents);
+
+        // Entry point for "--load-test <document> [name] [connections] [requests per connection]"
+        static int runLoadTest(const QStringList& arguments);
+
+    private:
+        QLocalSocket m_socket;
+        FrameReader m_reader;
+    };
+}
+
+#endif // SCORINGCLIENT_H
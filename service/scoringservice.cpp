@@ -0,0 +1,457 @@
+#include "scoringservice.h"
+#include "documentloader.h"
+#include "editjournal.h"
+#include "diagnostics/profiler.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QFutureWatcher>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalSocket>
+#include <QTextStream>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <cmath>
+#include <limits>
+
+using namespace ts;
+using namespace ts::service;
+
+namespace {
+    QByteArray hashOf(const QByteArray& data)
+    {
+        return QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+    }
+
+    double millisecondsBetween(ScoringService::Clock::time_point from, ScoringService::Clock::time_point to)
+    {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    std::optional<unsigned> idOf(const QJsonObject& edit, const char* key)
+    {
+        const auto value = edit[key];
+
+        if (!value.isDouble() || value.toDouble() < 0 || value.toDouble() > std::numeric_limits<quint32>::max() || value.toDouble() != std::floor(value.toDouble())) {
+            return std::nullopt;
+        }
+
+        return unsigned(value.toDouble());
+    }
+
+    // Edits given as JSON are written as journal records, so both forms of a batch are
+    // checked and applied by EditJournal::applyRecords
+    tl::expected<void, std::string> recordEdit(EditJournal& records, const QJsonObject& edit)
+    {
+        const auto op = edit["op"].toString();
+        const auto subjectId = idOf(edit, "subject");
+        const auto articleId = idOf(edit, "article");
+        const auto name = edit["name"];
+
+        const auto needsSubject = op == "setAppearance" || op == "setFirstAppearance";
+        const auto needsArticle = needsSubject || op == "removeArticle" || op == "toggleSubjectAppearance";
+        const auto needsName = op == "addSubject" || op == "addArticle" || op == "renameArticle" || op == "renameSubject";
+
+        if (needsSubject && !subjectId) {
+            return tl::unexpected<std::string>("'subject' must be an id");
+        }
+        if (needsArticle && !articleId) {
+            return tl::unexpected<std::string>("'article' must be an id");
+        }
+        if (needsName && !name.isString()) {
+            return tl::unexpected<std::string>("'name' must be a string");
+        }
+
+        if (op == "setAppearance") {
+            const auto value = edit["value"];
+
+            if (!value.isUndefined() && !value.isBool()) {
+                return tl::unexpected<std::string>("'value' must be a boolean");
+            }
+
+            records.setAppearance(Subject::Id(subjectId.value()), Article::Id(articleId.value()), value.toBool(true));
+        } else if (op == "setFirstAppearance") {
+            records.setFirstAppearance(Subject::Id(subjectId.value()), Article::Id(articleId.value()));
+        } else if (op == "addSubject") {
+            records.addSubject(name.toString().toStdString());
+        } else if (op == "addArticle") {
+            records.addArticle(name.toString().toStdString());
+        } else if (op == "renameArticle" || op == "renameSubject") {
+            const auto index = edit["index"];
+
+            if (!index.isDouble() || index.toDouble() != index.toInt()) {
+                return tl::unexpected<std::string>("'index' must be an integer");
+            }
+
+            if (op == "renameArticle") {
+                records.renameArticle(index.toInt(), name.toString().toStdString());
+            } else {
+                records.renameSubject(index.toInt(), name.toString().toStdString());
+            }
+        } else if (op == "removeArticle") {
+            records.removeArticle(Article::Id(articleId.value()));
+        } else if (op == "toggleSubjectAppearance") {
+            records.toggleSubjectAppearance(Article::Id(articleId.value()));
+        } else if (op == "sort") {
+            records.sort();
+        } else {
+            return tl::unexpected("unknown edit \"" + op.toStdString() + "\"");
+        }
+
+        return {};
+    }
+
+    // Returns the bytes the edits are identified by in the hash of the new state,
+    // the journal records they were applied as
+    tl::expected<QByteArray, std::string> applyEdits(ComputedDataModel& model, const QJsonValue& edits)
+    {
+        TS_PROFILE_SCOPE("ScoringService::applyEdits");
+
+        QByteArray records;
+
+        if (edits.isString()) {
+            auto decoded = QByteArray::fromBase64Encoding(edits.toString().toLatin1(), QByteArray::AbortOnBase64DecodingErrors);
+
+            if (!decoded) {
+                return tl::unexpected<std::string>("'edits' is not valid base64");
+            }
+
+            records = std::move(decoded.decoded);
+        } else if (edits.isArray()) {
+            const auto array = edits.toArray();
+            auto batch = EditJournal::inMemory();
+
+            for (auto i = 0; i < array.size(); i++) {
+                if (auto recorded = recordEdit(*batch, array[i].toObject()); !recorded) {
+                    return tl::unexpected("Can't apply edit " + std::to_string(i) + ": " + recorded.error());
+                }
+            }
+
+            records = batch->records();
+        } else {
+            return tl::unexpected<std::string>("'edits' must be an array or a base64 string");
+        }
+
+        if (auto applied = EditJournal::applyRecords(model, records); !applied) {
+            return tl::unexpected(applied.error());
+        }
+
+        return records;
+    }
+
+    QJsonObject scoresOf(const ComputedDataModel& model, Article::Id articleId)
+    {
+        const auto& data = model.getComputedDataForArticle(articleId);
+
+        return QJsonObject {
+            { "id", qint64(unsigned(articleId)) },
+            { "l", data.l },
+            { "c", data.c },
+            { "h", data.h }
+        };
+    }
+
+    tl::expected<QJsonArray, std::string> scoresOf(const ComputedDataModel& model, const QJsonArray& articles)
+    {
+        QJsonArray res;
+
+        for (const auto& article : articles) {
+            const auto articleId = Article::Id(unsigned(article.toInt()));
+
+            if (!model.hasArticle(articleId)) {
+                return tl::unexpected("no article " + std::to_string(unsigned(articleId)));
+            }
+
+            res.append(scoresOf(model, articleId));
+        }
+
+        return res;
+    }
+
+    QJsonArray scoresOf(const ComputedDataModel& model)
+    {
+        TS_PROFILE_SCOPE("ScoringService::scoresOf");
+
+        QJsonArray res;
+
+        for (const auto& article : model.getArticles()) {
+            res.append(scoresOf(model, article.id));
+        }
+
+        return res;
+    }
+}
+
+ScoringService::ScoringService(std::size_t cacheCapacity, QObject* parent) : QObject(parent), m_cache(cacheCapacity)
+{
+    connect(&m_server, &QLocalServer::newConnection, this, &ScoringService::acceptConnections);
+}
+
+bool ScoringService::listen(const QString& name)
+{
+    // a server that crashed leaves its socket file behind on Unix
+    QLocalServer::removeServer(name);
+
+    return m_server.listen(name);
+}
+
+QString ScoringService::errorString() const
+{
+    return m_server.errorString();
+}
+
+int ScoringService::runFromCommandLine(const QStringList& arguments)
+{
+    QTextStream out(stdout);
+
+    const auto serveIndex = arguments.indexOf("--serve");
+    const auto name = arguments.value(serveIndex + 1, defaultServerName);
+    const auto cacheCapacity = arguments.value(serveIndex + 2, "8").toULongLong();
+
+    ScoringService service(cacheCapacity);
+
+    if (!service.listen(name)) {
+        out << "can't listen on " << name << ": " << service.errorString() << "\n";
+        return 1;
+    }
+
+    out << "listening on " << service.m_server.fullServerName() << "\n";
+    out.flush();
+
+    return QCoreApplication::exec();
+}
+
+ScoringService::BatchResult ScoringService::runBatch(const QByteArray& key, std::shared_ptr<ComputedDataModel> model, const std::vector<Request>& requests)
+{
+    TS_PROFILE_SCOPE("ScoringService::runBatch");
+
+    BatchResult res { .key = key, .model = std::move(model) };
+
+    // scores of the current state, serialized once for all the requests reading it
+    std::optional<QJsonArray> allScores;
+
+    for (const auto& request : requests) {
+        const auto startedAt = Clock::now();
+
+        QJsonObject response {
+            { "id", request.message["id"] },
+            { "batchSize", int(requests.size()) }
+        };
+
+        const auto fail = [&](const std::string& error) {
+            response["error"] = QString::fromStdString(error);
+            res.responses.push_back(response);
+        };
+
+        if (res.key != key) {
+            // an earlier request of the batch has edited the document
+            if (request.document.isEmpty()) {
+                fail("The document was edited by another request, use the hash it returned");
+                continue;
+            }
+
+            res.key = key;
+            res.model.reset();
+        }
+
+        response["cached"] = bool(res.model);
+
+        if (!res.model) {
+            if (request.document.isEmpty()) {
+                fail("Unknown document hash, send the document");
+                continue;
+            }
+
+            auto loaded = parseDocument(request.document);
+
+            if (!loaded) {
+                fail("Can't load the document: " + loaded.error());
+                continue;
+            }
+
+            res.model = std::make_shared<ComputedDataModel>(std::move(loaded).value());
+            allScores.reset();
+        }
+
+        const auto loadedAt = Clock::now();
+
+        if (request.message.contains("edits")) {
+            auto edits = applyEdits(*res.model, request.message["edits"]);
+
+            if (!edits) {
+                // edits applied halfway leave the document in a state nobody has the hash of
+                res.model.reset();
+                fail(edits.error());
+                continue;
+            }
+
+            res.key = hashOf(res.key + edits.value());
+            allScores.reset();
+        }
+
+        const auto editedAt = Clock::now();
+
+        if (request.message.contains("articles")) {
+            auto scores = scoresOf(*res.model, request.message["articles"].toArray());
+
+            if (!scores) {
+                fail(scores.error());
+                continue;
+            }
+
+            response["scores"] = scores.value();
+        } else {
+            if (!allScores) {
+                allScores = scoresOf(*res.model);
+            }
+
+            response["scores"] = allScores.value();
+        }
+
+        const auto C_nu = res.model->getC_nu();
+
+        response["documentHash"] = QString::fromLatin1(res.key);
+        response["C_nu"] = C_nu ? QJsonValue(C_nu.value()) : QJsonValue();
+
+        const auto finishedAt = Clock::now();
+
+        response["timings"] = QJsonObject {
+            { "queueMs", millisecondsBetween(request.queuedAt, startedAt) },
+            { "loadMs", millisecondsBetween(startedAt, loadedAt) },
+            { "editMs", millisecondsBetween(loadedAt, editedAt) },
+            { "scoreMs", millisecondsBetween(editedAt, finishedAt) },
+            { "totalMs", millisecondsBetween(request.queuedAt, finishedAt) }
+        };
+
+        res.responses.push_back(response);
+    }
+
+    return res;
+}
+
+void ScoringService::acceptConnections()
+{
+    while (auto* socket = m_server.nextPendingConnection()) {
+        m_readers.insert_or_assign(socket, FrameReader());
+
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() {
+            readRequests(socket);
+        });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            m_readers.erase(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void ScoringService::readRequests(QLocalSocket* socket)
+{
+    auto reader = m_readers.find(socket);
+
+    if (reader == m_readers.end()) {
+        return;
+    }
+
+    reader->second.append(socket->readAll());
+
+    while (auto message = reader->second.next()) {
+        if (!message.value()) {
+            reply(socket, QJsonObject { { "error", QString::fromStdString(message.value().error()) } });
+            socket->disconnectFromServer();
+            return;
+        }
+
+        enqueue(socket, std::move(message.value().value()));
+    }
+}
+
+void ScoringService::enqueue(QLocalSocket* socket, QJsonObject&& message)
+{
+    Request request { .message = std::move(message), .queuedAt = Clock::now() };
+
+    const auto document = request.message["document"];
+
+    if (document.isObject()) {
+        request.document = QJsonDocument(document.toObject()).toJson(QJsonDocument::Compact);
+    } else if (document.isString()) {
+        request.document = QByteArray::fromBase64(document.toString().toLatin1());
+    }
+
+    QByteArray key;
+
+    if (!request.document.isEmpty()) {
+        key = hashOf(request.document);
+    } else if (request.message["documentHash"].isString()) {
+        key = request.message["documentHash"].toString().toLatin1();
+    } else {
+        reply(socket, QJsonObject {
+            { "id", request.message["id"] },
+            { "error", "A request needs a document or a documentHash" }
+        });
+        return;
+    }
+
+    m_queued[key].push_back(Queued { .socket = socket, .request = std::move(request) });
+
+    // otherwise the request joins the next batch of the document
+    if (!m_running.contains(key)) {
+        startBatch(key);
+    }
+}
+
+void ScoringService::startBatch(const QByteArray& key)
+{
+    auto queued = m_queued.extract(key);
+
+    if (queued.empty()) {
+        return;
+    }
+
+    std::vector<Request> requests;
+    std::vector<QPointer<QLocalSocket>> sockets;
+
+    for (auto& item : queued.mapped()) {
+        requests.push_back(std::move(item.request));
+        sockets.push_back(item.socket);
+    }
+
+    m_running.insert(key);
+
+    auto* watcher = new QFutureWatcher<BatchResult>(this);
+
+    connect(watcher, &QFutureWatcher<BatchResult>::finished, this, [this, watcher, key, sockets = std::move(sockets)]() {
+        watcher->deleteLater();
+
+        finishBatch(key, watcher->result(), sockets);
+    });
+
+    watcher->setFuture(QtConcurrent::run([key, model = m_cache.take(key), requests = std::move(requests)]() {
+        return runBatch(key, model, requests);
+    }));
+}
+
+void ScoringService::finishBatch(const QByteArray& key, BatchResult&& result, const std::vector<QPointer<QLocalSocket>>& sockets)
+{
+    for (auto i = 0u; i < result.responses.size(); i++) {
+        reply(sockets[i], result.responses[i]);
+    }
+
+    if (result.model) {
+        m_cache.put(result.key, std::move(result.model));
+    }
+
+    m_running.erase(key);
+
+    // requests that came while the batch was running
+    if (m_queued.contains(key)) {
+        startBatch(key);
+    }
+}
+
+void ScoringService::reply(QLocalSocket* socket, const QJsonObject& response)
+{
+    if (socket && socket->state() == QLocalSocket::ConnectedState) {
+        socket->write(frameOf(response));
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef SCORINGSERVICE_H
+#define SCORINGSERVICE_H
+
+#include "documentcache.h"
+#include "protocol.h"
+
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QPointer>
+
+#include <chrono>
+#include <set>
+
+class QLocalSocket;
+
+namespace ts::service {
+    // Headless scoring over a local socket. A request is
+    //   { "id": any, "document": {...} or "<base64 of a .json or .tsz file>",
+    //     "documentHash": "<hash from an earlier response>", instead of the document,
+    //     "edits": [{ "op": "setAppearance", ... }, ...] or "<base64 of journal records>",
+    //     "articles": [ids], to return only these scores }
+    // and the response is
+    //   { "id", "documentHash", "C_nu", "scores": [{ "id", "l", "c", "h" }, ...], "cached",
+    //     "batchSize", "timings": { "queueMs", "loadMs", "editMs", "scoreMs", "totalMs" } }
+    // or { "id", "error" }. Edits move the document to a new state with a new hash.
+    // Requests for the same document that arrive while it is busy are served together
+    // in one batch, which loads the document and serializes its scores once
+    class ScoringService : public QObject
+    {
+        Q_OBJECT
+    public:
+        explicit ScoringService(std::size_t cacheCapacity, QObject* parent = nullptr);
+
+        bool listen(const QString& name);
+        QString errorString() const;
+
+        // Entry point for "--serve [name] [cached documents]"
+        static int runFromCommandLine(const QStringList& arguments);
+
+        using Clock = std::chrono::steady_clock;
+
+        struct Request {
+            QJsonObject message;
+            // the document the request carries, if any
+            QByteArray document;
+            Clock::time_point queuedAt;
+        };
+
+        struct BatchResult {
+            // state of the document after the batch
+            QByteArray key;
+            std::shared_ptr<ComputedDataModel> model;
+            // in the order of the requests
+            std::vector<QJsonObject> responses;
+        };
+
+        // Runs on the thread pool with the document owned by the batch
+        static BatchResult runBatch(const QByteArray& key, std::shared_ptr<ComputedDataModel> model, const std::vector<Request>& requests);
+
+    private:
+        struct Queued {
+            QPointer<QLocalSocket> socket;
+            Request request;
+        };
+
+        void acceptConnections();
+        void readRequests(QLocalSocket* socket);
+        void enqueue(QLocalSocket* socket, QJsonObject&& message);
+        void startBatch(const QByteArray& key);
+        void finishBatch(const QByteArray& key, BatchResult&& result, const std::vector<QPointer<QLocalSocket>>& sockets);
+
+        static void reply(QLocalSocket* socket, const QJsonObject& response);
+
+        QLocalServer m_server;
+        DocumentCache m_cache;
+
+        std::map<QLocalSocket*, FrameReader> m_readers;
+        std::map<QByteArray, std::vector<Queued>> m_queued;
+        // documents with a batch in flight
+        std::set<QByteArray> m_running;
+    };
+}
+
+#endif // SCORINGSERVICE_H
@@ -0,0 +1,139 @@
+#include "stringpool.h"
+
+#include <algorithm>
+#include <functional>
+
+using namespace ts;
+
+QString InternedString::toQString() const noexcept
+{
+    return m_entry ? m_entry->display : QString();
+}
+
+template<typename T>
+T* StringPool::BlockArena<T>::allocate(std::size_t count)
+{
+    if (m_blocks.empty() || m_used + count > m_capacity) {
+        m_capacity = std::max(blockSize, count);
+        m_blocks.push_back(std::make_unique<T[]>(m_capacity));
+        m_used = 0;
+        m_reserved += m_capacity;
+    }
+
+    auto res = m_blocks.back().get() + m_used;
+    m_used += count;
+
+    return res;
+}
+
+InternedString StringPool::intern(std::string_view value)
+{
+    const auto hash = std::hash<std::string_view>{}(value);
+
+    if (auto entry = find(value, hash)) {
+        return InternedString(entry);
+    }
+
+    return insert(value, hash, QString::fromUtf8(value.data(), qsizetype(value.size())));
+}
+
+InternedString StringPool::intern(const QString& value)
+{
+    const auto utf8 = value.toUtf8();
+    const auto view = std::string_view(utf8.constData(), std::size_t(utf8.size()));
+    const auto hash = std::hash<std::string_view>{}(view);
+
+    if (auto entry = find(view, hash)) {
+        return InternedString(entry);
+    }
+
+    return insert(view, hash, value);
+}
+
+std::size_t StringPool::size() const noexcept
+{
+    return m_size;
+}
+
+std::size_t StringPool::reservedBytes() const noexcept
+{
+    return m_utf8.reservedBytes() + m_utf16Bytes + m_entries.size() * entriesPerChunk * sizeof(Entry) + m_table.capacity() * sizeof(const Entry*);
+}
+
+std::size_t StringPool::blocksCount() const noexcept
+{
+    return m_utf8.blocksCount() + m_size + m_entries.size() + (m_table.empty() ? 0 : 1);
+}
+
+InternedString StringPool::insert(std::string_view utf8, std::size_t hash, QString utf16)
+{
+    if ((m_size + 1) * 2 > m_table.size()) {
+        rehash();
+    }
+
+    auto utf8Data = m_utf8.allocate(utf8.size());
+    std::copy_n(utf8.data(), utf8.size(), utf8Data);
+
+    m_utf16Bytes += std::size_t(utf16.size()) * sizeof(QChar);
+
+    if (m_entries.empty() || m_entries.back().size() == entriesPerChunk) {
+        m_entries.emplace_back().reserve(entriesPerChunk);
+    }
+
+    const auto& entry = m_entries.back().emplace_back(Entry {
+        .utf8 = std::string_view(utf8Data, utf8.size()),
+        .display = std::move(utf16),
+        .hash = hash
+    });
+
+    const auto mask = m_table.size() - 1;
+    for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+        if (!m_table[slot]) {
+            m_table[slot] = &entry;
+            break;
+        }
+    }
+
+    m_size++;
+
+    return InternedString(&entry);
+}
+
+const InternedString::Entry* StringPool::find(std::string_view utf8, std::size_t hash) const noexcept
+{
+    if (m_table.empty()) {
+        return nullptr;
+    }
+
+    const auto mask = m_table.size() - 1;
+
+    for (auto slot = hash & mask; m_table[slot]; slot = (slot + 1) & mask) {
+        const auto entry = m_table[slot];
+
+        if (entry->hash == hash && entry->utf8 == utf8) {
+            return entry;
+        }
+    }
+
+    return nullptr;
+}
+
+void StringPool::rehash()
+{
+    std::vector<const Entry*> table(std::max<std::size_t>(64, m_table.size() * 2));
+    const auto mask = table.size() - 1;
+
+    for (const auto entry : m_table) {
+        if (!entry) {
+            continue;
+        }
+
+        auto slot = entry->hash & mask;
+        while (table[slot]) {
+            slot = (slot + 1) & mask;
+        }
+        table[slot] = entry;
+    }
+
+    m_table = std::move(table);
+}
@@ -0,0 +1,103 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QString>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ts {
+    class StringPool;
+
+    // Handle to a string owned by a StringPool. It stays valid as long as the pool
+    // is alive, copying it doesn't allocate and equal handles have equal contents.
+    // The QString it hands out shares its characters, so it outlives the pool
+    class InternedString {
+    public:
+        InternedString() noexcept = default;
+
+        std::string_view view() const noexcept { return m_entry ? m_entry->utf8 : std::string_view(); }
+        QString toQString() const noexcept;
+        std::string toStdString() const { return std::string(view()); }
+
+        bool empty() const noexcept { return view().empty(); }
+
+        friend bool operator==(const InternedString& lhs, const InternedString& rhs) noexcept
+        {
+            return lhs.m_entry == rhs.m_entry || lhs.view() == rhs.view();
+        }
+
+    private:
+        friend class StringPool;
+
+        struct Entry {
+            std::string_view utf8;
+            // owns its characters, views and editors keep copies of it after the
+            // pool is rebuilt and freed
+            QString display;
+            std::size_t hash = 0;
+        };
+
+        explicit InternedString(const Entry* entry) noexcept : m_entry(entry) {}
+
+        const Entry* m_entry = nullptr;
+    };
+
+    // Per-document storage for names: every distinct string is stored once, as UTF-8
+    // in large contiguous blocks and as a shared QString. Strings are never freed
+    // one by one, an edited document moves its live names into a new pool instead, see
+    // ComputedDataModel::reclaimStrings. Not thread-safe, a document is built
+    // and edited from one thread at a time
+    class StringPool {
+    public:
+        StringPool() = default;
+        StringPool(const StringPool&) = delete;
+        StringPool& operator=(const StringPool&) = delete;
+
+        InternedString intern(std::string_view value);
+        InternedString intern(const QString& value);
+
+        std::size_t size() const noexcept;
+        // bytes reserved by the pool and the number of blocks it consists of
+        std::size_t reservedBytes() const noexcept;
+        std::size_t blocksCount() const noexcept;
+
+    private:
+        using Entry = InternedString::Entry;
+
+        template<typename T>
+        class BlockArena {
+        public:
+            T* allocate(std::size_t count);
+
+            std::size_t reservedBytes() const noexcept { return m_reserved * sizeof(T); }
+            std::size_t blocksCount() const noexcept { return m_blocks.size(); }
+
+        private:
+            static constexpr std::size_t blockSize = 64 * 1024 / sizeof(T);
+
+            std::vector<std::unique_ptr<T[]>> m_blocks;
+            std::size_t m_used = 0;
+            std::size_t m_capacity = 0;
+            std::size_t m_reserved = 0;
+        };
+
+        InternedString insert(std::string_view utf8, std::size_t hash, QString utf16);
+        const Entry* find(std::string_view utf8, std::size_t hash) const noexcept;
+        void rehash();
+
+        static constexpr std::size_t entriesPerChunk = 4096;
+
+        BlockArena<char> m_utf8;
+        std::size_t m_utf16Bytes = 0;
+        // chunks are reserved up front and never reallocate, so entries never move
+        std::vector<std::vector<Entry>> m_entries;
+        // open addressing with linear probing, the capacity is a power of two
+        std::vector<const Entry*> m_table;
+        std::size_t m_size = 0;
+    };
+}
+
+#endif // STRINGPOOL_H
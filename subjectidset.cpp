@@ -0,0 +1,369 @@
+#include "subjectidset.h"
+
+#include <algorithm>
+#include <bit>
+
+using namespace ts;
+
+namespace {
+    // the id in the element type of a sparse vector
+    template<typename Element>
+    Element elementOf(SubjectIdSet::Id id) noexcept
+    {
+        return Element(typename Element::underlying_type(unsigned(id)));
+    }
+
+    template<typename Element>
+    SubjectIdSet::Id idOf(Element element) noexcept
+    {
+        return SubjectIdSet::Id(unsigned(typename Element::underlying_type(element)));
+    }
+}
+
+SubjectIdSet::Id SubjectIdSet::const_iterator::operator*() const noexcept
+{
+    switch (m_set->m_form) {
+    case Form::Narrow:
+        return idOf(m_set->m_narrowIds[m_position]);
+    case Form::Wide:
+        return m_set->m_ids[m_position];
+    default:
+        return Id(unsigned(m_position));
+    }
+}
+
+SubjectIdSet::const_iterator& SubjectIdSet::const_iterator::operator++() noexcept
+{
+    m_position = m_set->m_form == Form::Dense ? m_set->nextBit(m_position + 1) : m_position + 1;
+
+    return *this;
+}
+
+SubjectIdSet::const_iterator SubjectIdSet::const_iterator::operator++(int) noexcept
+{
+    auto res = *this;
+    ++*this;
+
+    return res;
+}
+
+SubjectIdSet::const_iterator::const_iterator(const SubjectIdSet* set, std::size_t position) noexcept : m_set(set), m_position(position)
+{
+
+}
+
+SubjectIdSet::SubjectIdSet(const allocator_type& allocator) noexcept : m_narrowIds(allocator), m_ids(allocator), m_words(allocator)
+{
+
+}
+
+SubjectIdSet::SubjectIdSet(std::initializer_list<Id> ids, const allocator_type& allocator) : SubjectIdSet(allocator)
+{
+    for (const auto id : ids) {
+        insert(id);
+    }
+}
+
+SubjectIdSet::SubjectIdSet(SubjectIdSet&& other) noexcept
+    : m_narrowIds(std::move(other.m_narrowIds)), m_ids(std::move(other.m_ids)), m_words(std::move(other.m_words)), m_denseCount(other.m_denseCount), m_form(other.m_form)
+{
+    other.clear();
+}
+
+SubjectIdSet::SubjectIdSet(const SubjectIdSet& other, const allocator_type& allocator)
+    : m_narrowIds(other.m_narrowIds, allocator), m_ids(other.m_ids, allocator), m_words(other.m_words, allocator), m_denseCount(other.m_denseCount), m_form(other.m_form)
+{
+
+}
+
+SubjectIdSet::SubjectIdSet(SubjectIdSet&& other, const allocator_type& allocator)
+    : m_narrowIds(std::move(other.m_narrowIds), allocator), m_ids(std::move(other.m_ids), allocator), m_words(std::move(other.m_words), allocator), m_denseCount(other.m_denseCount), m_form(other.m_form)
+{
+    other.clear();
+}
+
+SubjectIdSet& SubjectIdSet::operator=(SubjectIdSet&& other)
+{
+    if (this != &other) {
+        m_narrowIds = std::move(other.m_narrowIds);
+        m_ids = std::move(other.m_ids);
+        m_words = std::move(other.m_words);
+        m_denseCount = other.m_denseCount;
+        m_form = other.m_form;
+
+        other.clear();
+    }
+
+    return *this;
+}
+
+SubjectIdSet::allocator_type SubjectIdSet::get_allocator() const noexcept
+{
+    return m_ids.get_allocator();
+}
+
+SubjectIdSet::const_iterator SubjectIdSet::begin() const noexcept
+{
+    return const_iterator(this, m_form == Form::Dense ? nextBit(0) : 0);
+}
+
+SubjectIdSet::const_iterator SubjectIdSet::end() const noexcept
+{
+    return const_iterator(this, m_form == Form::Dense ? m_words.size() * wordBits : size());
+}
+
+bool SubjectIdSet::empty() const noexcept
+{
+    return size() == 0;
+}
+
+SubjectIdSet::size_type SubjectIdSet::size() const noexcept
+{
+    if (m_form == Form::Dense) {
+        return m_denseCount;
+    }
+
+    return withIds([](const auto& ids) { return ids.size(); });
+}
+
+bool SubjectIdSet::contains(Id id) const noexcept
+{
+    if (m_form == Form::Dense) {
+        const auto bit = std::size_t(unsigned(id));
+        return bit / wordBits < m_words.size() && (m_words[bit / wordBits] >> (bit % wordBits)) & 1;
+    }
+
+    if (m_form == Form::Narrow) {
+        return unsigned(id) <= maxNarrowId && std::binary_search(m_narrowIds.begin(), m_narrowIds.end(), elementOf<NarrowId>(id));
+    }
+
+    return std::binary_search(m_ids.begin(), m_ids.end(), id);
+}
+
+SubjectIdSet::size_type SubjectIdSet::count(Id id) const noexcept
+{
+    return contains(id) ? 1 : 0;
+}
+
+void SubjectIdSet::insert(Id id)
+{
+    const auto bit = std::size_t(unsigned(id));
+
+    // an id far past the others would blow the bitset up
+    if (m_form == Form::Dense && bit / wordBits >= m_words.size() && wordsFor(unsigned(id)) * sizeof(Word) > 2 * (m_denseCount + 1) * idSize(unsigned(id))) {
+        makeSparse();
+    }
+
+    if (m_form == Form::Dense) {
+        if (bit / wordBits >= m_words.size()) {
+            m_words.resize(bit / wordBits + 1);
+        }
+
+        auto& word = m_words[bit / wordBits];
+        const auto mask = Word(1) << (bit % wordBits);
+
+        if (!(word & mask)) {
+            word |= mask;
+            m_denseCount++;
+        }
+
+        return;
+    }
+
+    if (m_form == Form::Narrow && unsigned(id) > maxNarrowId) {
+        makeWide();
+    }
+
+    const auto inserted = withIds([id](auto& ids) {
+        using Element = typename std::decay_t<decltype(ids)>::value_type;
+
+        const auto element = elementOf<Element>(id);
+        const auto position = std::lower_bound(ids.begin(), ids.end(), element);
+
+        if (position != ids.end() && *position == element) {
+            return false;
+        }
+
+        ids.insert(position, element);
+
+        return true;
+    });
+
+    if (!inserted) {
+        return;
+    }
+
+    const auto maxId = withIds([](const auto& ids) { return unsigned(idOf(ids.back())); });
+
+    // a bitset up to the largest id is no bigger than the ids themselves
+    if (wordsFor(maxId) * sizeof(Word) <= size() * idSize(maxId)) {
+        makeDense();
+    }
+}
+
+SubjectIdSet::size_type SubjectIdSet::erase(Id id)
+{
+    if (!contains(id)) {
+        return 0;
+    }
+
+    if (m_form == Form::Dense) {
+        const auto bit = std::size_t(unsigned(id));
+
+        m_words[bit / wordBits] &= ~(Word(1) << (bit % wordBits));
+        m_denseCount--;
+
+        // half the size of the bitset, so that a row on the border doesn't switch on every edit
+        if (2 * m_denseCount * idSize(unsigned(m_words.size() * wordBits - 1)) < m_words.size() * sizeof(Word)) {
+            makeSparse();
+        }
+    } else {
+        withIds([id](auto& ids) {
+            using Element = typename std::decay_t<decltype(ids)>::value_type;
+
+            ids.erase(std::lower_bound(ids.begin(), ids.end(), elementOf<Element>(id)));
+        });
+
+        if (m_form == Form::Wide && (m_ids.empty() || unsigned(m_ids.back()) <= maxNarrowId)) {
+            makeNarrow();
+        }
+    }
+
+    return 1;
+}
+
+void SubjectIdSet::clear() noexcept
+{
+    m_narrowIds.clear();
+    m_ids.clear();
+    m_words.clear();
+    m_denseCount = 0;
+    m_form = Form::Narrow;
+}
+
+bool SubjectIdSet::isDense() const noexcept
+{
+    return m_form == Form::Dense;
+}
+
+bool SubjectIdSet::isNarrow() const noexcept
+{
+    return m_form == Form::Narrow;
+}
+
+std::size_t SubjectIdSet::memoryUsage() const noexcept
+{
+    return m_narrowIds.capacity() * sizeof(NarrowId) + m_ids.capacity() * sizeof(Id) + m_words.capacity() * sizeof(Word);
+}
+
+bool SubjectIdSet::operator==(const SubjectIdSet& other) const noexcept
+{
+    return size() == other.size() && std::equal(begin(), end(), other.begin());
+}
+
+std::size_t SubjectIdSet::wordsFor(unsigned maxId) noexcept
+{
+    return std::size_t(maxId) / wordBits + 1;
+}
+
+std::size_t SubjectIdSet::idSize(unsigned maxId) noexcept
+{
+    return maxId <= maxNarrowId ? sizeof(NarrowId) : sizeof(Id);
+}
+
+std::size_t SubjectIdSet::nextBit(std::size_t position) const noexcept
+{
+    auto word = position / wordBits;
+
+    if (word >= m_words.size()) {
+        return m_words.size() * wordBits;
+    }
+
+    auto bits = m_words[word] & (~Word(0) << (position % wordBits));
+
+    while (!bits) {
+        if (++word == m_words.size()) {
+            return m_words.size() * wordBits;
+        }
+        bits = m_words[word];
+    }
+
+    return word * wordBits + std::size_t(std::countr_zero(bits));
+}
+
+void SubjectIdSet::makeDense()
+{
+    m_denseCount = size();
+
+    withIds([this](auto& ids) {
+        m_words.assign(wordsFor(unsigned(idOf(ids.back()))), 0);
+
+        for (const auto element : ids) {
+            const auto bit = std::size_t(unsigned(idOf(element)));
+            m_words[bit / wordBits] |= Word(1) << (bit % wordBits);
+        }
+
+        ids.clear();
+        ids.shrink_to_fit();
+    });
+
+    m_form = Form::Dense;
+}
+
+void SubjectIdSet::makeSparse()
+{
+    const auto end = m_words.size() * wordBits;
+
+    // the bitset can end past the last id, the form follows the ids themselves
+    auto lastWord = m_words.size();
+    while (lastWord > 0 && !m_words[lastWord - 1]) {
+        lastWord--;
+    }
+
+    const auto last = lastWord == 0 ? 0 : (lastWord - 1) * wordBits + wordBits - 1 - std::size_t(std::countl_zero(m_words[lastWord - 1]));
+
+    m_form = last <= maxNarrowId ? Form::Narrow : Form::Wide;
+
+    withIds([this, end](auto& ids) {
+        using Element = typename std::decay_t<decltype(ids)>::value_type;
+
+        ids.reserve(m_denseCount);
+
+        for (auto bit = nextBit(0); bit < end; bit = nextBit(bit + 1)) {
+            ids.push_back(elementOf<Element>(Id(unsigned(bit))));
+        }
+    });
+
+    m_denseCount = 0;
+
+    m_words.clear();
+    m_words.shrink_to_fit();
+}
+
+void SubjectIdSet::makeNarrow()
+{
+    m_narrowIds.reserve(m_ids.size());
+
+    for (const auto id : m_ids) {
+        m_narrowIds.push_back(elementOf<NarrowId>(id));
+    }
+
+    m_ids.clear();
+    m_ids.shrink_to_fit();
+
+    m_form = Form::Narrow;
+}
+
+void SubjectIdSet::makeWide()
+{
+    m_ids.reserve(m_narrowIds.size() + 1);
+
+    for (const auto element : m_narrowIds) {
+        m_ids.push_back(idOf(element));
+    }
+
+    m_narrowIds.clear();
+    m_narrowIds.shrink_to_fit();
+
+    m_form = Form::Wide;
+}
@@ -0,0 +1,146 @@
+#ifndef SUBJECTIDSET_H
+#define SUBJECTIDSET_H
+
+#include "KeyId.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory_resource>
+#include <vector>
+
+namespace ts {
+    struct Subject;
+
+    // Subject ids of one article row in ascending order. A sparse row keeps a sorted
+    // vector of ids, 16-bit ones while every id fits, a dense one a bitset indexed by id.
+    // The row takes whichever form is smaller and switches by itself on edits, iteration
+    // is the same for all of them
+    class SubjectIdSet {
+    public:
+        using Id = KeyId<Subject>;
+        using NarrowId = KeyId<Subject, std::uint16_t>;
+        using value_type = Id;
+        using size_type = std::size_t;
+        using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+        class const_iterator {
+        public:
+            using iterator_concept = std::forward_iterator_tag;
+            using iterator_category = std::input_iterator_tag;
+            using value_type = Id;
+            using difference_type = std::ptrdiff_t;
+
+            const_iterator() noexcept = default;
+
+            Id operator*() const noexcept;
+            const_iterator& operator++() noexcept;
+            const_iterator operator++(int) noexcept;
+
+            bool operator==(const const_iterator& other) const noexcept = default;
+
+        private:
+            friend class SubjectIdSet;
+
+            const_iterator(const SubjectIdSet* set, std::size_t position) noexcept;
+
+            const SubjectIdSet* m_set = nullptr;
+            // index into the ids of a sparse row, bit of a dense one
+            std::size_t m_position = 0;
+        };
+
+        using iterator = const_iterator;
+
+        SubjectIdSet() noexcept = default;
+        explicit SubjectIdSet(const allocator_type& allocator) noexcept;
+        SubjectIdSet(std::initializer_list<Id> ids, const allocator_type& allocator = {});
+
+        SubjectIdSet(const SubjectIdSet& other) = default;
+        SubjectIdSet(SubjectIdSet&& other) noexcept;
+        SubjectIdSet(const SubjectIdSet& other, const allocator_type& allocator);
+        SubjectIdSet(SubjectIdSet&& other, const allocator_type& allocator);
+
+        SubjectIdSet& operator=(const SubjectIdSet& other) = default;
+        SubjectIdSet& operator=(SubjectIdSet&& other);
+
+        allocator_type get_allocator() const noexcept;
+
+        const_iterator begin() const noexcept;
+        const_iterator end() const noexcept;
+
+        bool empty() const noexcept;
+        size_type size() const noexcept;
+
+        bool contains(Id id) const noexcept;
+        size_type count(Id id) const noexcept;
+
+        void insert(Id id);
+        size_type erase(Id id);
+        void clear() noexcept;
+
+        bool isDense() const noexcept;
+        bool isNarrow() const noexcept;
+        std::size_t memoryUsage() const noexcept;
+
+        bool operator==(const SubjectIdSet& other) const noexcept;
+
+        template<typename Predicate>
+        friend size_type erase_if(SubjectIdSet& set, Predicate predicate)
+        {
+            std::vector<Id> erased;
+
+            for (const auto id : set) {
+                if (predicate(id)) {
+                    erased.push_back(id);
+                }
+            }
+
+            for (const auto id : erased) {
+                set.erase(id);
+            }
+
+            return erased.size();
+        }
+
+    private:
+        using Word = std::uint64_t;
+
+        enum class Form : std::uint8_t { Narrow, Wide, Dense };
+
+        static constexpr std::size_t wordBits = 64;
+        static constexpr unsigned maxNarrowId = 0xFFFF;
+
+        static std::size_t wordsFor(unsigned maxId) noexcept;
+        // bytes of an id in the sparse form that holds ids up to maxId
+        static std::size_t idSize(unsigned maxId) noexcept;
+
+        // calls f with the ids vector of a sparse row
+        template<typename F>
+        decltype(auto) withIds(F&& f) const
+        {
+            return m_form == Form::Narrow ? f(m_narrowIds) : f(m_ids);
+        }
+        template<typename F>
+        decltype(auto) withIds(F&& f)
+        {
+            return m_form == Form::Narrow ? f(m_narrowIds) : f(m_ids);
+        }
+
+        // first set bit at or after position, the end of the bitset when there is none
+        std::size_t nextBit(std::size_t position) const noexcept;
+
+        void makeDense();
+        void makeSparse();
+        void makeNarrow();
+        void makeWide();
+
+        std::pmr::vector<NarrowId> m_narrowIds;
+        std::pmr::vector<Id> m_ids;
+        std::pmr::vector<Word> m_words;
+        std::size_t m_denseCount = 0;
+        Form m_form = Form::Narrow;
+    };
+}
+
+#endif // SUBJECTIDSET_H
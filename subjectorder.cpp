@@ -0,0 +1,372 @@
+#include "subjectorder.h"
+#include "parallel.h"
+
+#include <cmath>
+#include <random>
+#include <ranges>
+
+using namespace ts;
+using namespace ts::algorithm;
+
+namespace {
+    struct ArticleRow {
+        // indices into Data::subjects of every dot, first appearance included
+        std::vector<int> subjects;
+        int firstAppearance = -1;
+    };
+
+    // Same result as computeOuterLinks, but evaluated over the dots of the row only
+    ComputedData computeRow(const ArticleRow& row, const std::vector<int>& position, int size, const ScoringPolicy& policy, std::vector<int>& dots)
+    {
+        dots.clear();
+        for (const auto subject : row.subjects) {
+            dots.push_back(position[subject] + 1);
+        }
+        std::ranges::sort(dots);
+
+        const auto t_m = row.firstAppearance < 0 ? size + 1 : position[row.firstAppearance] + 1;
+        const auto t_p = dots.empty() ? t_m : std::min(dots.front(), t_m);
+        const auto i_max = dots.empty() ? 0 : dots.back();
+
+        const auto sumOf = [&]<typename Sum>(Sum sum) {
+            for (auto index = 0; index < int(dots.size()); index++) {
+                const auto k = dots[index];
+
+                const auto a_l = weightedDistance(k, t_p, t_m, policy.p_1, policy.p_2);
+
+                // every position in (t_p, k] that is not one of the previous dots is empty
+                const auto a_l_t = a_l - ((k - t_p) - index);
+
+                if (a_l_t != 0 && a_l != 0) {
+                    sum.add(a_l_t, a_l);
+                }
+            }
+
+            return sum.divided(normalizationDivisor(policy.normalization, size, t_p, i_max));
+        };
+
+        const auto c = policy.arithmetic == Arithmetic::Exact ? sumOf(ExactSum {}) : sumOf(FloatSum {});
+
+        const auto l = float(i_max - t_p + 1) / size;
+
+        return ComputedData { .l = l, .c = c, .h = l * c };
+    }
+
+    float percentile(std::vector<float>& values, float p)
+    {
+        if (values.empty()) {
+            return 0;
+        }
+
+        const auto nth = values.begin() + std::lround(std::clamp(p, 0.f, 1.f) * float(values.size() - 1));
+        std::nth_element(values.begin(), nth, values.end());
+
+        return *nth;
+    }
+
+    struct RestartResult {
+        std::vector<int> order;
+        double objective = 0;
+    };
+}
+
+tl::expected<SubjectOrderResult, std::string> ts::algorithm::optimizeSubjectOrder(const Data& data, const SubjectOrderConstraints& constraints, const SubjectOrderOptions& options)
+{
+    if (data.subjects.empty()) {
+        return tl::unexpected<std::string>("there must be at least one subject");
+    }
+
+    const auto size = int(data.subjects.size());
+    const auto articlesCount = int(data.articles.size());
+
+    std::map<Subject::Id, int> subjectIndices;
+    for (auto i = 0; i < size; i++) {
+        subjectIndices.insert_or_assign(data.subjects[i].id, i);
+    }
+
+    const auto findSubject = [&](Subject::Id id) -> std::optional<int> {
+        auto iter = subjectIndices.find(id);
+        return iter == subjectIndices.end() ? std::nullopt : std::optional(iter->second);
+    };
+
+    std::vector<ArticleRow> rows(articlesCount);
+    std::vector<std::vector<int>> columns(size);
+
+    for (auto i = 0; i < articlesCount; i++) {
+        const auto articleId = data.articles[i].id;
+        auto& row = rows[i];
+
+        if (auto iter = data.appearance.find(articleId); iter != data.appearance.end()) {
+            for (const auto& subjectId : iter->second) {
+                if (auto index = findSubject(subjectId)) {
+                    row.subjects.push_back(index.value());
+                }
+            }
+        }
+
+        if (auto iter = data.firstAppearance.find(articleId); iter != data.firstAppearance.end()) {
+            if (auto index = findSubject(iter->second)) {
+                row.firstAppearance = index.value();
+
+                if (std::ranges::find(row.subjects, row.firstAppearance) == row.subjects.end()) {
+                    row.subjects.push_back(row.firstAppearance);
+                }
+            }
+        }
+
+        for (const auto subject : row.subjects) {
+            columns[subject].push_back(i);
+        }
+    }
+
+    // precedence[s] holds (other subject, s must be before it)
+    std::vector<std::vector<std::pair<int, bool>>> precedence(size);
+
+    for (const auto& [before, after] : constraints.precedence) {
+        const auto beforeIndex = findSubject(before);
+        const auto afterIndex = findSubject(after);
+
+        if (!beforeIndex || !afterIndex) {
+            return tl::unexpected<std::string>("precedence constraint refers to unknown subject");
+        }
+        if (beforeIndex.value() >= afterIndex.value()) {
+            return tl::unexpected("current subject order violates precedence of subject with id " + std::to_string(unsigned(before)) + " over " + std::to_string(unsigned(after)));
+        }
+
+        precedence[beforeIndex.value()].emplace_back(afterIndex.value(), true);
+        precedence[afterIndex.value()].emplace_back(beforeIndex.value(), false);
+    }
+
+    std::vector<int> freePositions;
+
+    for (auto i = 0; i < size; i++) {
+        if (!constraints.locked.contains(data.subjects[i].id)) {
+            freePositions.push_back(i);
+        }
+    }
+
+    const auto restarts = options.restarts > 0 ? options.restarts : std::max(1, QThread::idealThreadCount());
+
+    const auto evaluate = [&](const std::vector<float>& h, double cSum, std::vector<float>& scratch) -> double {
+        if (options.objective == SubjectOrderObjective::MaximizeC_nu) {
+            return articlesCount ? cSum / articlesCount : 0;
+        }
+
+        scratch = h;
+        return -percentile(scratch, options.percentile);
+    };
+
+    std::vector<RestartResult> results(restarts);
+
+    ts::parallel::forEachIndex(std::size_t(restarts), [&](std::size_t restart) {
+        std::mt19937 rng(options.seed + unsigned(restart));
+
+        std::vector<int> order(size);
+        std::vector<int> position(size);
+
+        for (auto i = 0; i < size; i++) {
+            order[i] = i;
+            position[i] = i;
+        }
+
+        const auto applySwap = [&](int i, int j) {
+            std::swap(order[i], order[j]);
+            position[order[i]] = i;
+            position[order[j]] = j;
+        };
+
+        const auto isOrderValid = [&](int subject) {
+            for (const auto& [other, isBefore] : precedence[subject]) {
+                if ((position[subject] < position[other]) != isBefore) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        const auto pickSwap = [&]() {
+            std::uniform_int_distribution<int> pick(0, int(freePositions.size()) - 1);
+            const auto i = freePositions[pick(rng)];
+            auto j = i;
+            while (j == i) {
+                j = freePositions[pick(rng)];
+            }
+            return std::pair(i, j);
+        };
+
+        if (freePositions.size() < 2) {
+            results[restart].order = order;
+            return;
+        }
+
+        if (restart > 0) {
+            for (auto step = 0; step < size * 4; step++) {
+                const auto [i, j] = pickSwap();
+                applySwap(i, j);
+                if (!isOrderValid(order[i]) || !isOrderValid(order[j])) {
+                    applySwap(i, j);
+                }
+            }
+        }
+
+        std::vector<int> dots;
+        std::vector<float> c(articlesCount);
+        std::vector<float> h(articlesCount);
+        std::vector<float> scratch;
+        auto cSum = 0.0;
+
+        for (auto i = 0; i < articlesCount; i++) {
+            const auto computed = computeRow(rows[i], position, size, data.scoring, dots);
+            c[i] = computed.c;
+            h[i] = computed.h;
+            cSum += computed.c;
+        }
+
+        std::vector<unsigned> stamps(articlesCount);
+        auto stamp = 0u;
+        std::vector<std::pair<int, ComputedData>> changed;
+
+        // Only articles with a dot in exactly one of the swapped columns, or with
+        // first appearance in one of them, change their scores
+        const auto trySwap = [&](int i, int j) -> std::optional<double> {
+            applySwap(i, j);
+
+            const auto a = order[i];
+            const auto b = order[j];
+
+            if (!isOrderValid(a) || !isOrderValid(b)) {
+                applySwap(i, j);
+                return std::nullopt;
+            }
+
+            stamp++;
+            changed.clear();
+
+            auto newCSum = cSum;
+
+            for (const auto* column : { &columns[a], &columns[b] }) {
+                for (const auto article : *column) {
+                    if (stamps[article] == stamp) {
+                        continue;
+                    }
+                    stamps[article] = stamp;
+
+                    const auto& row = rows[article];
+
+                    const auto hasBoth = std::ranges::find(row.subjects, a) != row.subjects.end() && std::ranges::find(row.subjects, b) != row.subjects.end();
+
+                    if (hasBoth && row.firstAppearance != a && row.firstAppearance != b) {
+                        continue;
+                    }
+
+                    const auto computed = computeRow(row, position, size, data.scoring, dots);
+                    newCSum += computed.c - c[article];
+                    changed.emplace_back(article, computed);
+                }
+            }
+
+            if (options.objective == SubjectOrderObjective::MaximizeC_nu) {
+                return evaluate(h, newCSum, scratch);
+            }
+
+            for (auto& [article, computed] : changed) {
+                std::swap(h[article], computed.h);
+            }
+            const auto res = evaluate(h, newCSum, scratch);
+            for (auto& [article, computed] : changed) {
+                std::swap(h[article], computed.h);
+            }
+
+            return res;
+        };
+
+        const auto commit = [&]() {
+            for (const auto& [article, computed] : changed) {
+                cSum += computed.c - c[article];
+                c[article] = computed.c;
+                h[article] = computed.h;
+            }
+        };
+
+        auto current = evaluate(h, cSum, scratch);
+
+        // Initial temperature accepts an average worsening move with probability 1/e
+        auto temperature = 0.0;
+        {
+            auto samples = 0;
+            for (auto step = 0; step < 64; step++) {
+                const auto [i, j] = pickSwap();
+                if (const auto res = trySwap(i, j)) {
+                    temperature += std::abs(res.value() - current);
+                    samples++;
+                    applySwap(i, j);
+                }
+            }
+            temperature = samples && temperature > 0 ? temperature / samples : 1e-6;
+        }
+
+        const auto iterations = std::max(1, options.iterations);
+        const auto cooling = std::pow(1e-3, 1.0 / iterations);
+
+        std::uniform_real_distribution<double> chance(0, 1);
+
+        auto best = current;
+        auto bestOrder = order;
+
+        for (auto step = 0; step < iterations; step++, temperature *= cooling) {
+            const auto [i, j] = pickSwap();
+            const auto res = trySwap(i, j);
+
+            if (!res) {
+                continue;
+            }
+
+            if (res.value() >= current || chance(rng) < std::exp((res.value() - current) / temperature)) {
+                commit();
+                current = res.value();
+
+                if (current > best) {
+                    best = current;
+                    bestOrder = order;
+                }
+            } else {
+                applySwap(i, j);
+            }
+        }
+
+        results[restart] = RestartResult { .order = std::move(bestOrder), .objective = best };
+    });
+
+    const auto& best = *std::ranges::max_element(results, {}, &RestartResult::objective);
+
+    SubjectOrderResult res;
+
+    res.subjects.reserve(size);
+    std::vector<int> position(size);
+
+    for (auto i = 0; i < size; i++) {
+        res.subjects.push_back(data.subjects[best.order[i]]);
+        position[best.order[i]] = i;
+    }
+
+    std::vector<int> dots;
+    std::vector<float> h;
+    h.reserve(articlesCount);
+    auto cSum = 0.f;
+    auto fixedCSum = std::int64_t(0);
+
+    for (const auto& row : rows) {
+        const auto computed = computeRow(row, position, size, data.scoring, dots);
+        cSum += computed.c;
+        fixedCSum += fixedOf(computed.c);
+        h.push_back(computed.h);
+    }
+
+    if (articlesCount) {
+        // exact arithmetic gives bitwise the C_nu the reordered document will show
+        res.C_nu = data.scoring.arithmetic == Arithmetic::Exact ? floatOf(fixedCSum, articlesCount) : cSum / articlesCount;
+    }
+    res.hPercentile = percentile(h, options.percentile);
+
+    return res;
+}
@@ -0,0 +1,36 @@
+#ifndef SUBJECTORDER_H
+#define SUBJECTORDER_H
+
+#include "algorithm.h"
+
+namespace ts::algorithm {
+    enum class SubjectOrderObjective {
+        MaximizeC_nu,
+        MinimizeHPercentile
+    };
+
+    struct SubjectOrderConstraints {
+        // subjects that must stay at their current position
+        std::set<Subject::Id> locked;
+        // pairs of subjects where the first one must come before the second one
+        std::vector<std::pair<Subject::Id, Subject::Id>> precedence;
+    };
+
+    struct SubjectOrderOptions {
+        SubjectOrderObjective objective = SubjectOrderObjective::MaximizeC_nu;
+        float percentile = 0.5f;
+        int restarts = 0; // 0 means one restart per hardware thread
+        int iterations = 20000;
+        unsigned seed = 0;
+    };
+
+    struct SubjectOrderResult {
+        std::vector<Subject> subjects;
+        std::optional<float> C_nu;
+        float hPercentile = 0;
+    };
+
+    tl::expected<SubjectOrderResult, std::string> optimizeSubjectOrder(const Data& data, const SubjectOrderConstraints& constraints, const SubjectOrderOptions& options);
+}
+
+#endif // SUBJECTORDER_H
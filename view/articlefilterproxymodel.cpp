@@ -0,0 +1,22 @@
+#include "articlefilterproxymodel.h"
+#include "datamodel.h"
+
+#include <algorithm>
+
+void ArticleFilterProxyModel::setArticleFilter(std::optional<std::vector<ts::Article::Id>> articleIds)
+{
+    m_articleIds = std::move(articleIds);
+
+    invalidateFilter();
+}
+
+bool ArticleFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (!m_articleIds) {
+        return true;
+    }
+
+    const auto model = static_cast<const DataModel*>(sourceModel());
+
+    return std::binary_search(m_articleIds->begin(), m_articleIds->end(), model->getData().getArticles().at(sourceRow).id);
+}
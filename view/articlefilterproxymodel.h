@@ -0,0 +1,29 @@
+#ifndef ARTICLEFILTERPROXYMODEL_H
+#define ARTICLEFILTERPROXYMODEL_H
+
+#include "Data.h"
+
+#include <QSortFilterProxyModel>
+
+#include <optional>
+
+// Filters the rows of a DataModel down to a set of articles. Rows are matched by
+// article id, so no cell data is requested and the filter survives sorting
+class ArticleFilterProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    using QSortFilterProxyModel::QSortFilterProxyModel;
+
+    // ids must be in ascending order, std::nullopt shows every article
+    void setArticleFilter(std::optional<std::vector<ts::Article::Id>> articleIds);
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    std::optional<std::vector<ts::Article::Id>> m_articleIds;
+};
+
+#endif // ARTICLEFILTERPROXYMODEL_H
@@ -0,0 +1,179 @@
+#include "diagnosticsdock.h"
+#include "diagnostics/profiler.h"
+
+#include <QFile>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTabWidget>
+#include <QVBoxLayout>
+
+namespace {
+    QString formatDuration(std::uint64_t nanoseconds)
+    {
+        if (nanoseconds < 10'000) {
+            return QString::number(nanoseconds) + " ns";
+        }
+        if (nanoseconds < 10'000'000) {
+            return QString::number(double(nanoseconds) / 1e3, 'f', 1) + " µs";
+        }
+
+        return QString::number(double(nanoseconds) / 1e6, 'f', 1) + " ms";
+    }
+
+    QString formatBytes(std::uint64_t bytes)
+    {
+        if (bytes < 10'000) {
+            return QString::number(bytes) + " B";
+        }
+        if (bytes < 10'000'000) {
+            return QString::number(double(bytes) / 1024, 'f', 1) + " KiB";
+        }
+
+        return QString::number(double(bytes) / (1024 * 1024), 'f', 1) + " MiB";
+    }
+}
+
+DiagnosticsDock::DiagnosticsDock(QWidget *parent) : QDockWidget("Diagnostics", parent)
+{
+    setObjectName("diagnosticsDock");
+
+    auto content = new QWidget(this);
+    auto layout = new QVBoxLayout(content);
+
+    auto tabs = new QTabWidget(content);
+
+    m_table = new QTableWidget(0, 9, tabs);
+    m_table->setHorizontalHeaderLabels({ "Operation", "Calls", "Mean", "p50", "p90", "p99", "Max", "Allocs/call", "Bytes/call" });
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_table->verticalHeader()->hide();
+    tabs->addTab(m_table, "Timings");
+
+    m_memoryTable = new QTableWidget(0, 3, tabs);
+    m_memoryTable->setHorizontalHeaderLabels({ "Component", "Bytes", "Allocations" });
+    m_memoryTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_memoryTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_memoryTable->verticalHeader()->hide();
+    tabs->addTab(m_memoryTable, "Memory");
+
+    layout->addWidget(tabs);
+
+    auto buttonsLayout = new QHBoxLayout();
+    auto resetButton = new QPushButton("Reset", content);
+    auto dumpButton = new QPushButton("Dump JSON...", content);
+    buttonsLayout->addStretch();
+    buttonsLayout->addWidget(resetButton);
+    buttonsLayout->addWidget(dumpButton);
+    layout->addLayout(buttonsLayout);
+
+    setWidget(content);
+
+    connect(resetButton, &QPushButton::clicked, this, &DiagnosticsDock::reset);
+    connect(dumpButton, &QPushButton::clicked, this, &DiagnosticsDock::dumpJson);
+
+    connect(&m_refreshTimer, &QTimer::timeout, this, &DiagnosticsDock::refresh);
+    connect(this, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+        if (visible) {
+            refresh();
+            m_refreshTimer.start(1000);
+        } else {
+            m_refreshTimer.stop();
+        }
+    });
+
+#ifndef TS_ENABLE_PROFILING
+    m_table->setDisabled(true);
+    setToolTip("Profiling is disabled at compile time (TS_ENABLE_PROFILING)");
+#endif
+}
+
+void DiagnosticsDock::setMemoryUsageProvider(std::function<std::vector<ts::diagnostics::MemoryUsage>()> provider)
+{
+    m_memoryUsageProvider = std::move(provider);
+
+    refreshMemory();
+}
+
+void DiagnosticsDock::refresh()
+{
+    refreshMemory();
+
+    const auto operations = ts::diagnostics::Registry::instance().snapshot();
+
+    m_table->setRowCount(int(operations.size()));
+
+    for (auto row = 0; row < int(operations.size()); row++) {
+        const auto& stats = operations[row];
+        const auto isTimed = stats.timed > 0;
+
+        const QString cells[] = {
+            QString::fromStdString(stats.name),
+            QString::number(stats.calls),
+            isTimed ? formatDuration(stats.totalNanoseconds / stats.timed) : QString(),
+            isTimed ? formatDuration(stats.p50Nanoseconds) : QString(),
+            isTimed ? formatDuration(stats.p90Nanoseconds) : QString(),
+            isTimed ? formatDuration(stats.p99Nanoseconds) : QString(),
+            isTimed ? formatDuration(stats.maxNanoseconds) : QString(),
+            isTimed ? QString::number(double(stats.allocations) / stats.timed, 'f', 1) : QString(),
+            isTimed ? formatBytes(stats.allocatedBytes / stats.timed) : QString()
+        };
+
+        for (auto column = 0; column < int(std::size(cells)); column++) {
+            m_table->setItem(row, column, new QTableWidgetItem(cells[column]));
+        }
+    }
+}
+
+void DiagnosticsDock::refreshMemory()
+{
+    auto usage = m_memoryUsageProvider ? m_memoryUsageProvider() : std::vector<ts::diagnostics::MemoryUsage>();
+
+    ts::diagnostics::MemoryUsage total { .component = "total" };
+    for (const auto& component : usage) {
+        total.bytes += component.bytes;
+        total.allocations += component.allocations;
+    }
+    if (!usage.empty()) {
+        usage.push_back(std::move(total));
+    }
+
+    m_memoryTable->setRowCount(int(usage.size()));
+
+    for (auto row = 0; row < int(usage.size()); row++) {
+        const auto& component = usage[row];
+
+        m_memoryTable->setItem(row, 0, new QTableWidgetItem(QString::fromStdString(component.component)));
+        m_memoryTable->setItem(row, 1, new QTableWidgetItem(formatBytes(component.bytes)));
+        m_memoryTable->setItem(row, 2, new QTableWidgetItem(QString::number(component.allocations)));
+    }
+}
+
+void DiagnosticsDock::reset()
+{
+    ts::diagnostics::Registry::instance().reset();
+
+    refresh();
+}
+
+void DiagnosticsDock::dumpJson()
+{
+    auto filePath = QFileDialog::getSaveFileName(this, "Save Diagnostics", QString(), "Json (*.json)");
+
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    QFile saveFile(filePath);
+
+    if (!saveFile.open(QIODevice::WriteOnly)) {
+        QMessageBox::critical(this, tr("Save file"), "Can't access file");
+
+        return;
+    }
+
+    saveFile.write(ts::diagnostics::Registry::instance().toJson());
+}
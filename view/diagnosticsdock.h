@@ -0,0 +1,36 @@
+#ifndef DIAGNOSTICSDOCK_H
+#define DIAGNOSTICSDOCK_H
+
+#include "diagnostics/memoryusage.h"
+
+#include <QDockWidget>
+#include <QTimer>
+
+#include <functional>
+
+class QTableWidget;
+
+class DiagnosticsDock : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DiagnosticsDock(QWidget *parent = nullptr);
+
+    void setMemoryUsageProvider(std::function<std::vector<ts::diagnostics::MemoryUsage>()> provider);
+
+public slots:
+    void refresh();
+    void reset();
+    void dumpJson();
+
+private:
+    void refreshMemory();
+
+    QTableWidget *m_table;
+    QTableWidget *m_memoryTable;
+    std::function<std::vector<ts::diagnostics::MemoryUsage>()> m_memoryUsageProvider;
+    QTimer m_refreshTimer;
+};
+
+#endif // DIAGNOSTICSDOCK_H